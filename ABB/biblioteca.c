@@ -7,267 +7,1759 @@
 
 #include "biblioteca.h"
 
+#include <limits.h>
+#include <unistd.h>
+
 /*
  * Cria uma nova biblioteca vazia.
- * Aloca memória para a estrutura e inicializa a raiz como NULL.
+ * Usa a ABB simples, sem balanceamento automático.
  */
 Biblioteca *criarBiblioteca()
+{
+  return criarBibliotecaTipo(ARVORE_ABB);
+}
+
+/*
+ * Cria uma nova biblioteca vazia do tipo informado.
+ * Aloca memória para a estrutura e inicializa a raiz como NULL.
+ */
+Biblioteca *criarBibliotecaTipo(TipoArvore tipo)
 {
   Biblioteca *bib = (Biblioteca *)malloc(sizeof(Biblioteca));
+  if (bib != NULL && !iniciarTrava(&bib->trava))
+  {
+    free(bib);
+    bib = NULL;
+  }
   if (bib != NULL)
   {
     bib->raiz = NULL;
+    bib->tipo = tipo;
+    iniciarArena(&bib->textos);
+    iniciarPool(&bib->nos, sizeof(Livro));
+    iniciarIndice(&bib->indice);
+    iniciarAutores(&bib->autores);
+    bib->comAutores = 0;
+    iniciarTitulos(&bib->titulos);
+    bib->comTitulos = 0;
+    iniciarPalavras(&bib->palavras);
+    bib->comPalavras = 0;
+    iniciarMapa(&bib->disponiveis);
+    bib->comDisponiveis = 0;
+    iniciarCatalogo(&bib->catalogo);
+    bib->diario = NULL;
+    bib->diarioReaplicado = 0;
   }
   return bib;
 }
 
 /*
- * Função auxiliar para destruir a árvore recursivamente.
- * Percorre a árvore em pós-ordem, liberando a memória de cada nó.
+ * Empilha um livro, dobrando a capacidade da pilha quando necessário.
+ * Retorna 0 se não houver memória.
  */
-void destruirArvore(Livro *raiz)
+int empilharLivro(PilhaLivros *pilha, Livro *livro)
 {
-  if (raiz != NULL)
+  if (pilha->topo == pilha->capacidade)
   {
-    destruirArvore(raiz->esq);
-    destruirArvore(raiz->dir);
-    free(raiz);
+    int novaCapacidade = pilha->capacidade > 0 ? pilha->capacidade * 2 : 64;
+    Livro **novos = (Livro **)realloc(pilha->itens, novaCapacidade * sizeof(Livro *));
+    if (novos == NULL)
+      return 0;
+    pilha->itens = novos;
+    pilha->capacidade = novaCapacidade;
   }
+  pilha->itens[pilha->topo++] = livro;
+  return 1;
 }
 
 /*
  * Libera toda a memória alocada para a biblioteca.
- * Primeiro destrói a árvore de livros e depois libera a estrutura da biblioteca.
+ * Os nós não precisam ser percorridos: o pool libera todos os blocos de
+ * nós de uma vez e a arena faz o mesmo com os títulos e autores.
+ * O catálogo mapeado, se houver, é fechado.
+ * Por fim libera a estrutura da biblioteca.
  */
 void destruirBiblioteca(Biblioteca *bib)
 {
   if (bib != NULL)
   {
-    destruirArvore(bib->raiz);
+    liberarPool(&bib->nos);
+    liberarArena(&bib->textos);
+    liberarIndice(&bib->indice);
+    liberarAutores(&bib->autores);
+    liberarTitulos(&bib->titulos);
+    liberarPalavras(&bib->palavras);
+    liberarMapa(&bib->disponiveis);
+    fecharCatalogo(&bib->catalogo);
+    liberarTrava(&bib->trava);
     free(bib);
   }
 }
 
+/*
+ * Descarta o índice de autores; ele volta a ser montado na próxima busca
+ * por autor. Usado quando falta memória para mantê-lo.
+ */
+void descartarAutores(Biblioteca *bib)
+{
+  liberarAutores(&bib->autores);
+  bib->comAutores = 0;
+}
+
+/*
+ * Descarta o índice de títulos; ele volta a ser montado na próxima busca
+ * por título.
+ */
+void descartarTitulos(Biblioteca *bib)
+{
+  liberarTitulos(&bib->titulos);
+  bib->comTitulos = 0;
+}
+
+/*
+ * Descarta o índice de palavras; ele volta a ser montado na próxima busca
+ * por palavras.
+ */
+void descartarPalavras(Biblioteca *bib)
+{
+  liberarPalavras(&bib->palavras);
+  bib->comPalavras = 0;
+}
+
+/*
+ * Descarta o mapa de disponíveis; ele volta a ser montado na próxima
+ * consulta de disponíveis.
+ */
+void descartarDisponiveis(Biblioteca *bib)
+{
+  liberarMapa(&bib->disponiveis);
+  bib->comDisponiveis = 0;
+}
+
+/*
+ * Registra um livro nos índices da biblioteca.
+ * Chamado sempre que um nó entra na árvore. Quem insere reserva espaço no
+ * índice antes (reservarIndice), então aqui não falta memória; se faltar
+ * para um índice secundário (autores, títulos, palavras ou disponíveis), ele é descartado.
+ */
+void indexarLivro(Biblioteca *bib, Livro *livro)
+{
+  inserirIndice(&bib->indice, livro->id, livro);
+  if (bib->comAutores && !adicionarAutor(&bib->autores, livro->autor, livro->id))
+    descartarAutores(bib);
+  if (bib->comTitulos && !adicionarTitulo(&bib->titulos, livro->titulo, livro->id))
+    descartarTitulos(bib);
+  if (bib->comPalavras && !adicionarPalavras(&bib->palavras, livro->titulo, livro->autor, livro->id))
+    descartarPalavras(bib);
+  if (bib->comDisponiveis && livro->disponivel && !marcarBit(&bib->disponiveis, livro->id))
+    descartarDisponiveis(bib);
+}
+
+/*
+ * Retira um livro dos índices da biblioteca.
+ * Chamado antes de o nó sair da árvore, enquanto seus campos são válidos.
+ */
+void desindexarLivro(Biblioteca *bib, Livro *livro)
+{
+  removerIndice(&bib->indice, livro->id);
+  if (bib->comAutores)
+    removerAutor(&bib->autores, livro->autor, livro->id);
+  if (bib->comTitulos)
+    removerTitulo(&bib->titulos, livro->titulo, livro->id);
+  if (bib->comPalavras)
+    removerPalavras(&bib->palavras);
+  if (bib->comDisponiveis)
+    desmarcarBit(&bib->disponiveis, livro->id);
+}
+
+/*
+ * Muda a disponibilidade de um livro que já está nos índices, mantendo o
+ * mapa de disponíveis, se houver. Toda mudança de disponibilidade passa
+ * por aqui.
+ */
+void definirDisponivel(Biblioteca *bib, Livro *livro, int disponivel)
+{
+  livro->disponivel = disponivel;
+  if (!bib->comDisponiveis)
+    return;
+  if (!disponivel)
+    desmarcarBit(&bib->disponiveis, livro->id);
+  else if (!marcarBit(&bib->disponiveis, livro->id))
+    descartarDisponiveis(bib);
+}
+
+/*
+ * Registra uma operação no diário da biblioteca, se houver.
+ * Chamado depois que a operação foi feita na memória.
+ */
+void registrarNoDiario(Biblioteca *bib, TipoOperacao operacao, const Livro *livro)
+{
+  if (bib->diario != NULL &&
+      !registrarOperacao(bib->diario, operacao, livro->id, livro->titulo, livro->autor))
+    printf("Aviso: a operação não foi registrada no diário.\n");
+}
+
 /*
  * Cria um novo nó de livro.
- * Aloca memória e inicializa todos os campos do livro.
+ * Pega um nó do pool da biblioteca e inicializa todos os campos do livro;
+ * título e autor são copiados para a arena, ocupando só o seu tamanho real.
+ * O nó já sai registrado no índice.
  */
-Livro *criarLivro(int id, const char *titulo, const char *autor)
+Livro *criarLivro(Biblioteca *bib, int id, const char *titulo, const char *autor)
 {
-  Livro *novo = (Livro *)malloc(sizeof(Livro));
+  Livro *novo = (Livro *)alocarNo(&bib->nos);
   if (novo != NULL)
   {
+    novo->titulo = guardarTexto(&bib->textos, titulo, strlen(titulo));
+    novo->autor = guardarTexto(&bib->textos, autor, strlen(autor));
+    if (novo->titulo == NULL || novo->autor == NULL)
+    {
+      devolverNo(&bib->nos, novo);
+      return NULL;
+    }
     novo->id = id;
-    strcpy(novo->titulo, titulo);
-    strcpy(novo->autor, autor);
     novo->disponivel = 1;
-    novo->esq = novo->dir = NULL;
+    novo->altura = 1;
+    novo->tamanho = 1;
+    novo->cor = VERMELHO;
+    novo->esq = novo->dir = novo->pai = NULL;
+    indexarLivro(bib, novo);
   }
   return novo;
 }
 
 /*
- * Função auxiliar para inserir um livro na árvore.
- * Insere o livro mantendo a propriedade da ABB: IDs menores à esquerda,
- * maiores à direita.
+ * Função auxiliar para inserir um livro na ABB simples.
+ * Desce iterativamente até a ligação vazia onde o livro deve ficar,
+ * mantendo a propriedade da ABB: IDs menores à esquerda, maiores à direita.
+ */
+void inserirLivroABB(Biblioteca *bib, int id, const char *titulo, const char *autor)
+{
+  Livro **ligacao = &(bib->raiz);
+  while (*ligacao != NULL)
+  {
+    if (id < (*ligacao)->id)
+      ligacao = &((*ligacao)->esq);
+    else if (id > (*ligacao)->id)
+      ligacao = &((*ligacao)->dir);
+    else
+      return; // ID repetido: nada a fazer
+  }
+  *ligacao = criarLivro(bib, id, titulo, autor);
+  if (*ligacao == NULL)
+    return;
+
+  // O livro entrou: cada nó do caminho ganha um livro na subárvore
+  for (Livro *no = bib->raiz; no != *ligacao; no = id < no->id ? no->esq : no->dir)
+  {
+    no->tamanho++;
+  }
+}
+
+/*
+ * Retorna a altura de uma subárvore AVL.
+ * Uma subárvore vazia tem altura 0.
+ */
+int alturaLivro(Livro *raiz)
+{
+  return raiz != NULL ? raiz->altura : 0;
+}
+
+/*
+ * Recalcula a altura e o tamanho de um nó a partir dos filhos.
+ */
+void atualizarAltura(Livro *raiz)
+{
+  int altEsq = alturaLivro(raiz->esq);
+  int altDir = alturaLivro(raiz->dir);
+  raiz->altura = 1 + (altEsq > altDir ? altEsq : altDir);
+  raiz->tamanho = 1 + contarLivros(raiz->esq) + contarLivros(raiz->dir);
+}
+
+/*
+ * Rotação simples à direita.
+ * O filho esquerdo sobe e a antiga raiz vira seu filho direito.
+ *
+ *        y            x
+ *       / \          / \
+ *      x   C   =>   A   y
+ *     / \              / \
+ *    A   B            B   C
+ */
+Livro *rotacionarDireita(Livro *y)
+{
+  Livro *x = y->esq;
+  y->esq = x->dir;
+  x->dir = y;
+  atualizarAltura(y);
+  atualizarAltura(x);
+  return x;
+}
+
+/*
+ * Rotação simples à esquerda.
+ * Espelho da rotação à direita: o filho direito sobe.
+ */
+Livro *rotacionarEsquerda(Livro *x)
+{
+  Livro *y = x->dir;
+  x->dir = y->esq;
+  y->esq = x;
+  atualizarAltura(x);
+  atualizarAltura(y);
+  return y;
+}
+
+/*
+ * Restaura a propriedade AVL em um nó cujas subárvores já estão balanceadas.
+ * Atualiza a altura e aplica rotação simples ou dupla quando o fator de
+ * balanceamento sai do intervalo [-1, 1]. Retorna a nova raiz da subárvore.
+ */
+Livro *balancearLivro(Livro *raiz)
+{
+  atualizarAltura(raiz);
+  int fator = alturaLivro(raiz->esq) - alturaLivro(raiz->dir);
+
+  if (fator > 1)
+  {
+    // Caso esquerda-direita: rotação dupla
+    if (alturaLivro(raiz->esq->esq) < alturaLivro(raiz->esq->dir))
+      raiz->esq = rotacionarEsquerda(raiz->esq);
+    return rotacionarDireita(raiz);
+  }
+  if (fator < -1)
+  {
+    // Caso direita-esquerda: rotação dupla
+    if (alturaLivro(raiz->dir->dir) < alturaLivro(raiz->dir->esq))
+      raiz->dir = rotacionarDireita(raiz->dir);
+    return rotacionarEsquerda(raiz);
+  }
+  return raiz;
+}
+
+/*
+ * Função auxiliar para inserir um livro na árvore AVL.
+ * Insere como na ABB e rebalanceia cada nó no caminho de volta à raiz.
+ * Retorna a nova raiz da subárvore.
+ */
+Livro *inserirLivroAVL(Biblioteca *bib, Livro *raiz, int id, const char *titulo, const char *autor)
+{
+  if (raiz == NULL)
+    return criarLivro(bib, id, titulo, autor);
+
+  if (id < raiz->id)
+    raiz->esq = inserirLivroAVL(bib, raiz->esq, id, titulo, autor);
+  else if (id > raiz->id)
+    raiz->dir = inserirLivroAVL(bib, raiz->dir, id, titulo, autor);
+  else
+    return raiz; // ID repetido: nada a fazer
+
+  return balancearLivro(raiz);
+}
+
+/*
+ * Retorna a cor de um nó da rubro-negra.
+ * Folhas vazias (NULL) são consideradas pretas.
+ */
+CorLivro corLivro(Livro *no)
+{
+  return no != NULL ? no->cor : PRETO;
+}
+
+/*
+ * Rotação à esquerda na rubro-negra, atualizando os ponteiros para o pai.
+ * O nó que sobe fica com o tamanho da subárvore inteira; o que desce é
+ * recalculado pelos filhos.
+ */
+void rotacionarEsquerdaRN(Biblioteca *bib, Livro *x)
+{
+  Livro *y = x->dir;
+  x->dir = y->esq;
+  if (y->esq != NULL)
+    y->esq->pai = x;
+  y->pai = x->pai;
+  if (x->pai == NULL)
+    bib->raiz = y;
+  else if (x == x->pai->esq)
+    x->pai->esq = y;
+  else
+    x->pai->dir = y;
+  y->esq = x;
+  x->pai = y;
+  y->tamanho = x->tamanho;
+  x->tamanho = 1 + contarLivros(x->esq) + contarLivros(x->dir);
+}
+
+/*
+ * Rotação à direita na rubro-negra, espelho da rotação à esquerda.
  */
-void inserirLivroRecursivo(Livro **raiz, int id, const char *titulo, const char *autor)
+void rotacionarDireitaRN(Biblioteca *bib, Livro *y)
 {
-  if (*raiz == NULL)
+  Livro *x = y->esq;
+  y->esq = x->dir;
+  if (x->dir != NULL)
+    x->dir->pai = y;
+  x->pai = y->pai;
+  if (y->pai == NULL)
+    bib->raiz = x;
+  else if (y == y->pai->dir)
+    y->pai->dir = x;
+  else
+    y->pai->esq = x;
+  x->dir = y;
+  y->pai = x;
+  x->tamanho = y->tamanho;
+  y->tamanho = 1 + contarLivros(y->esq) + contarLivros(y->dir);
+}
+
+/*
+ * Restaura as propriedades da rubro-negra após inserir um nó vermelho.
+ * Sobe pela árvore recolorindo enquanto o tio for vermelho; quando o tio
+ * for preto, faz no máximo duas rotações e termina.
+ */
+void corrigirInsercaoRN(Biblioteca *bib, Livro *no)
+{
+  while (no->pai != NULL && no->pai->cor == VERMELHO)
   {
-    *raiz = criarLivro(id, titulo, autor);
+    Livro *pai = no->pai;
+    Livro *avo = pai->pai;
+
+    if (pai == avo->esq)
+    {
+      Livro *tio = avo->dir;
+      if (corLivro(tio) == VERMELHO)
+      {
+        pai->cor = PRETO;
+        tio->cor = PRETO;
+        avo->cor = VERMELHO;
+        no = avo;
+        continue;
+      }
+      if (no == pai->dir)
+      {
+        rotacionarEsquerdaRN(bib, pai);
+        no = pai;
+        pai = no->pai;
+      }
+      pai->cor = PRETO;
+      avo->cor = VERMELHO;
+      rotacionarDireitaRN(bib, avo);
+    }
+    else
+    {
+      Livro *tio = avo->esq;
+      if (corLivro(tio) == VERMELHO)
+      {
+        pai->cor = PRETO;
+        tio->cor = PRETO;
+        avo->cor = VERMELHO;
+        no = avo;
+        continue;
+      }
+      if (no == pai->esq)
+      {
+        rotacionarDireitaRN(bib, pai);
+        no = pai;
+        pai = no->pai;
+      }
+      pai->cor = PRETO;
+      avo->cor = VERMELHO;
+      rotacionarEsquerdaRN(bib, avo);
+    }
   }
-  else if (id < (*raiz)->id)
+  bib->raiz->cor = PRETO;
+}
+
+/*
+ * Insere um livro na rubro-negra de forma iterativa.
+ * Desce até a posição do novo nó guardando o pai, liga o nó como
+ * vermelho e corrige as cores/rotações de baixo para cima.
+ */
+void inserirLivroRN(Biblioteca *bib, int id, const char *titulo, const char *autor)
+{
+  Livro *pai = NULL;
+  Livro *atual = bib->raiz;
+  while (atual != NULL)
   {
-    inserirLivroRecursivo(&((*raiz)->esq), id, titulo, autor);
+    pai = atual;
+    if (id < atual->id)
+      atual = atual->esq;
+    else if (id > atual->id)
+      atual = atual->dir;
+    else
+      return; // ID repetido: nada a fazer
   }
-  else if (id > (*raiz)->id)
+
+  Livro *novo = criarLivro(bib, id, titulo, autor);
+  if (novo == NULL)
+    return;
+
+  novo->pai = pai;
+  if (pai == NULL)
+    bib->raiz = novo;
+  else if (id < pai->id)
+    pai->esq = novo;
+  else
+    pai->dir = novo;
+  for (Livro *no = pai; no != NULL; no = no->pai)
   {
-    inserirLivroRecursivo(&((*raiz)->dir), id, titulo, autor);
+    no->tamanho++;
   }
+
+  corrigirInsercaoRN(bib, novo);
 }
 
 /*
  * Insere um novo livro na biblioteca.
- * Chama a função recursiva para inserir na posição correta.
+ * Um ID repetido é descartado pelo índice, sem descer pela árvore.
+ * Usa a inserção simples, AVL ou rubro-negra conforme o tipo da biblioteca.
+ * Se o livro entrou no índice, a inserção deu certo e vai para o diário.
  */
 void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor)
 {
-  inserirLivroRecursivo(&(bib->raiz), id, titulo, autor);
+  if (buscarLivro(bib, id) != NULL)
+    return; // ID repetido: nada a fazer
+  if (!reservarIndice(&bib->indice, bib->indice.quantidade + 1))
+    return; // Sem memória para o índice
+
+  switch (bib->tipo)
+  {
+  case ARVORE_AVL:
+    bib->raiz = inserirLivroAVL(bib, bib->raiz, id, titulo, autor);
+    break;
+  case ARVORE_RUBRO_NEGRA:
+    inserirLivroRN(bib, id, titulo, autor);
+    break;
+  default:
+    inserirLivroABB(bib, id, titulo, autor);
+  }
+
+  Livro *novo = (Livro *)consultarIndice(&bib->indice, id);
+  if (novo != NULL)
+    registrarNoDiario(bib, OPERACAO_INSERIR, novo);
+}
+
+/*
+ * Cria o nó de um livro do catálogo mapeado, na primeira vez que ele é
+ * buscado. O nó entra só no índice, não na árvore (a ordem continua vindo
+ * do catálogo), e título e autor apontam direto para as páginas mapeadas.
+ */
+Livro *materializarLivro(Biblioteca *bib, long pos)
+{
+  if (!reservarIndice(&bib->indice, bib->indice.quantidade + 1))
+    return NULL;
+  Livro *livro = (Livro *)alocarNo(&bib->nos);
+  if (livro == NULL)
+    return NULL;
+
+  RegistroLivro registro;
+  lerEntradaCatalogo(&bib->catalogo, (size_t)pos, &registro);
+  livro->id = registro.id;
+  livro->disponivel = registro.disponivel;
+  livro->titulo = registro.titulo;
+  livro->autor = registro.autor;
+  livro->altura = 1;
+  livro->tamanho = 1;
+  livro->cor = PRETO;
+  livro->esq = livro->dir = livro->pai = NULL;
+  inserirIndice(&bib->indice, livro->id, livro); // Já está nos índices secundários, se houver
+  bib->catalogo.estados[pos] = ENTRADA_MATERIALIZADA;
+  return livro;
+}
+
+/*
+ * Busca um livro na biblioteca pelo ID.
+ * Consulta o índice hash, sem descer pela árvore.
+ * Serve para os três tipos de árvore. Se o ID não estiver no índice e
+ * houver um catálogo mapeado, procura no catálogo.
+ */
+Livro *buscarLivro(Biblioteca *bib, int id)
+{
+  Livro *livro = (Livro *)consultarIndice(&bib->indice, id);
+  if (livro == NULL && bib->catalogo.quantidade > 0)
+  {
+    long pos = procurarCatalogo(&bib->catalogo, id);
+    if (pos >= 0 && bib->catalogo.estados[pos] == ENTRADA_MAPEADA)
+      livro = materializarLivro(bib, pos);
+  }
+  return livro;
+}
+
+/*
+ * Encontra o nó com o menor ID em uma subárvore.
+ * Usado na remoção de nós com dois filhos.
+ */
+Livro *encontrarMenor(Livro *raiz)
+{
+  Livro *atual = raiz;
+  while (atual && atual->esq != NULL)
+  {
+    atual = atual->esq;
+  }
+  return atual;
+}
+
+/*
+ * Função auxiliar para remover um livro da ABB simples, sem recursão.
+ * Remove o livro mantendo a propriedade da ABB.
+ * Trata três casos: nó sem filhos, com um filho e com dois filhos.
+ * No caso de dois filhos, o sucessor é religado no lugar do nó removido.
+ */
+void removerLivroABB(Biblioteca *bib, int id)
+{
+  Livro **ligacao = &(bib->raiz);
+  while (*ligacao != NULL && (*ligacao)->id != id)
+  {
+    ligacao = id < (*ligacao)->id ? &((*ligacao)->esq) : &((*ligacao)->dir);
+  }
+
+  Livro *alvo = *ligacao;
+  if (alvo == NULL)
+    return;
+
+  // Os nós acima do alvo perdem um livro na subárvore
+  for (Livro *no = bib->raiz; no != alvo; no = id < no->id ? no->esq : no->dir)
+  {
+    no->tamanho--;
+  }
+
+  if (alvo->esq == NULL)
+  {
+    *ligacao = alvo->dir;
+  }
+  else if (alvo->dir == NULL)
+  {
+    *ligacao = alvo->esq;
+  }
+  else
+  {
+    // Desliga o menor nó da subárvore direita e o coloca no lugar do alvo
+    Livro **ligSucessor = &(alvo->dir);
+    while ((*ligSucessor)->esq != NULL)
+    {
+      (*ligSucessor)->tamanho--;
+      ligSucessor = &((*ligSucessor)->esq);
+    }
+    Livro *sucessor = *ligSucessor;
+    *ligSucessor = sucessor->dir;
+    sucessor->esq = alvo->esq;
+    sucessor->dir = alvo->dir;
+    sucessor->tamanho = alvo->tamanho - 1;
+    *ligacao = sucessor;
+  }
+  devolverNo(&bib->nos, alvo);
 }
 
 /*
- * Função auxiliar para buscar um livro na árvore.
- * Busca o livro pelo ID, aproveitando a propriedade da ABB.
+ * Desliga o menor nó de uma subárvore AVL, rebalanceando o caminho.
+ * O nó desligado é devolvido em *menor e a nova raiz é retornada.
  */
-Livro *buscarLivroRecursivo(Livro *raiz, int id)
+Livro *removerMenorAVL(Livro *raiz, Livro **menor)
 {
-  if (raiz == NULL || raiz->id == id)
+  if (raiz->esq == NULL)
   {
-    return raiz;
+    *menor = raiz;
+    return raiz->dir;
   }
+  raiz->esq = removerMenorAVL(raiz->esq, menor);
+  return balancearLivro(raiz);
+}
+
+/*
+ * Função auxiliar para remover um livro da árvore AVL.
+ * No caso de dois filhos, o sucessor é religado no lugar do nó removido
+ * (em vez de copiar os dados), e todo o caminho é rebalanceado.
+ * Retorna a nova raiz da subárvore.
+ */
+Livro *removerLivroAVL(Biblioteca *bib, Livro *raiz, int id)
+{
+  if (raiz == NULL)
+    return NULL;
+
   if (id < raiz->id)
   {
-    return buscarLivroRecursivo(raiz->esq, id);
+    raiz->esq = removerLivroAVL(bib, raiz->esq, id);
   }
-  return buscarLivroRecursivo(raiz->dir, id);
+  else if (id > raiz->id)
+  {
+    raiz->dir = removerLivroAVL(bib, raiz->dir, id);
+  }
+  else
+  {
+    Livro *esq = raiz->esq;
+    Livro *dir = raiz->dir;
+    devolverNo(&bib->nos, raiz);
+
+    if (dir == NULL)
+      return esq;
+
+    Livro *sucessor;
+    dir = removerMenorAVL(dir, &sucessor);
+    sucessor->esq = esq;
+    sucessor->dir = dir;
+    return balancearLivro(sucessor);
+  }
+  return balancearLivro(raiz);
 }
 
 /*
- * Busca um livro na biblioteca pelo ID.
- * Chama a função recursiva para buscar na árvore.
+ * Substitui, na rubro-negra, a subárvore u pela subárvore v.
+ * Atualiza a ligação do pai de u e o ponteiro pai de v.
+ */
+void transplantarRN(Biblioteca *bib, Livro *u, Livro *v)
+{
+  if (u->pai == NULL)
+    bib->raiz = v;
+  else if (u == u->pai->esq)
+    u->pai->esq = v;
+  else
+    u->pai->dir = v;
+  if (v != NULL)
+    v->pai = u->pai;
+}
+
+/*
+ * Restaura as propriedades da rubro-negra após remover um nó preto.
+ * O nó x (possivelmente NULL) carrega um "preto extra"; como ele pode ser
+ * NULL, o pai é passado separadamente. Faz no máximo três rotações.
+ */
+void corrigirRemocaoRN(Biblioteca *bib, Livro *x, Livro *pai)
+{
+  while (x != bib->raiz && corLivro(x) == PRETO)
+  {
+    if (x == pai->esq)
+    {
+      Livro *irmao = pai->dir;
+      if (irmao->cor == VERMELHO)
+      {
+        irmao->cor = PRETO;
+        pai->cor = VERMELHO;
+        rotacionarEsquerdaRN(bib, pai);
+        irmao = pai->dir;
+      }
+      if (corLivro(irmao->esq) == PRETO && corLivro(irmao->dir) == PRETO)
+      {
+        irmao->cor = VERMELHO;
+        x = pai;
+        pai = x->pai;
+      }
+      else
+      {
+        if (corLivro(irmao->dir) == PRETO)
+        {
+          irmao->esq->cor = PRETO;
+          irmao->cor = VERMELHO;
+          rotacionarDireitaRN(bib, irmao);
+          irmao = pai->dir;
+        }
+        irmao->cor = pai->cor;
+        pai->cor = PRETO;
+        irmao->dir->cor = PRETO;
+        rotacionarEsquerdaRN(bib, pai);
+        x = bib->raiz;
+      }
+    }
+    else
+    {
+      Livro *irmao = pai->esq;
+      if (irmao->cor == VERMELHO)
+      {
+        irmao->cor = PRETO;
+        pai->cor = VERMELHO;
+        rotacionarDireitaRN(bib, pai);
+        irmao = pai->esq;
+      }
+      if (corLivro(irmao->dir) == PRETO && corLivro(irmao->esq) == PRETO)
+      {
+        irmao->cor = VERMELHO;
+        x = pai;
+        pai = x->pai;
+      }
+      else
+      {
+        if (corLivro(irmao->esq) == PRETO)
+        {
+          irmao->dir->cor = PRETO;
+          irmao->cor = VERMELHO;
+          rotacionarEsquerdaRN(bib, irmao);
+          irmao = pai->esq;
+        }
+        irmao->cor = pai->cor;
+        pai->cor = PRETO;
+        irmao->esq->cor = PRETO;
+        rotacionarDireitaRN(bib, pai);
+        x = bib->raiz;
+      }
+    }
+  }
+  if (x != NULL)
+    x->cor = PRETO;
+}
+
+/*
+ * Desconta um livro do tamanho de todos os ancestrais de um nó da
+ * rubro-negra, subindo pelos ponteiros para o pai.
+ */
+void diminuirAncestrais(Livro *no)
+{
+  for (Livro *pai = no->pai; pai != NULL; pai = pai->pai)
+  {
+    pai->tamanho--;
+  }
+}
+
+/*
+ * Remove um nó da rubro-negra de forma iterativa.
+ * Como cada nó conhece o pai, o nó achado pelo índice é desligado direto,
+ * sem descer pela árvore.
+ * Se o nó tiver dois filhos, o sucessor assume sua posição, sua cor e
+ * seu tamanho (já descontado); se a cor efetivamente removida for preta,
+ * corrige a árvore.
+ */
+void removerLivroRN(Biblioteca *bib, Livro *alvo)
+{
+  CorLivro corRemovida = alvo->cor;
+  Livro *x;
+  Livro *paiX;
+
+  if (alvo->esq == NULL)
+  {
+    x = alvo->dir;
+    paiX = alvo->pai;
+    diminuirAncestrais(alvo);
+    transplantarRN(bib, alvo, alvo->dir);
+  }
+  else if (alvo->dir == NULL)
+  {
+    x = alvo->esq;
+    paiX = alvo->pai;
+    diminuirAncestrais(alvo);
+    transplantarRN(bib, alvo, alvo->esq);
+  }
+  else
+  {
+    Livro *sucessor = encontrarMenor(alvo->dir);
+    diminuirAncestrais(sucessor);
+    sucessor->tamanho = alvo->tamanho;
+    corRemovida = sucessor->cor;
+    x = sucessor->dir;
+    if (sucessor->pai == alvo)
+    {
+      paiX = sucessor;
+    }
+    else
+    {
+      paiX = sucessor->pai;
+      transplantarRN(bib, sucessor, sucessor->dir);
+      sucessor->dir = alvo->dir;
+      sucessor->dir->pai = sucessor;
+    }
+    transplantarRN(bib, alvo, sucessor);
+    sucessor->esq = alvo->esq;
+    sucessor->esq->pai = sucessor;
+    sucessor->cor = alvo->cor;
+  }
+  devolverNo(&bib->nos, alvo);
+
+  if (corRemovida == PRETO)
+    corrigirRemocaoRN(bib, x, paiX);
+}
+
+/*
+ * Remove um livro da biblioteca pelo ID.
+ * O livro sai do índice antes de sair da árvore; depois usa a remoção
+ * simples, AVL ou rubro-negra conforme o tipo da biblioteca.
+ * Um livro do catálogo mapeado não está na árvore: seu nó volta ao pool e
+ * a entrada é marcada como removida.
+ */
+void removerLivro(Biblioteca *bib, int id)
+{
+  Livro *livro = buscarLivro(bib, id);
+  if (livro == NULL)
+    return;
+  registrarNoDiario(bib, OPERACAO_REMOVER, livro);
+  desindexarLivro(bib, livro);
+
+  long pos = procurarCatalogo(&bib->catalogo, id);
+  if (pos >= 0 && bib->catalogo.estados[pos] == ENTRADA_MATERIALIZADA)
+  {
+    bib->catalogo.estados[pos] = ENTRADA_REMOVIDA;
+    bib->catalogo.removidas++;
+    devolverNo(&bib->nos, livro);
+    return;
+  }
+
+  switch (bib->tipo)
+  {
+  case ARVORE_AVL:
+    bib->raiz = removerLivroAVL(bib, bib->raiz, id);
+    break;
+  case ARVORE_RUBRO_NEGRA:
+    removerLivroRN(bib, livro);
+    break;
+  default:
+    removerLivroABB(bib, id);
+  }
+}
+
+/*
+ * Retorna o livro de uma entrada não removida do catálogo mapeado: o nó,
+ * se a entrada já tiver um (ele tem o status atual), ou uma cópia montada
+ * em *copia com os dados das páginas mapeadas.
+ */
+const Livro *livroDoCatalogo(Biblioteca *bib, size_t pos, Livro *copia)
+{
+  Catalogo *catalogo = &bib->catalogo;
+  if (catalogo->estados[pos] == ENTRADA_MATERIALIZADA)
+    return (const Livro *)consultarIndice(&bib->indice, catalogo->ids[pos]);
+
+  RegistroLivro registro;
+  lerEntradaCatalogo(catalogo, pos, &registro);
+  memset(copia, 0, sizeof(*copia));
+  copia->id = registro.id;
+  copia->disponivel = registro.disponivel;
+  copia->titulo = registro.titulo;
+  copia->autor = registro.autor;
+  return copia;
+}
+
+/*
+ * Visita, a partir da posição *pos do catálogo mapeado, as entradas com
+ * ID menor que `limite`, avançando *pos. Entradas removidas são puladas;
+ * as demais são visitadas pelo livro dado por livroDoCatalogo.
+ * Retorna 0 se a visita for interrompida.
+ */
+int visitarCatalogo(Biblioteca *bib, size_t *pos, long long limite, VisitarLivro visitar, void *contexto)
+{
+  Catalogo *catalogo = &bib->catalogo;
+  for (; *pos < catalogo->quantidade && catalogo->ids[*pos] < limite; (*pos)++)
+  {
+    if (catalogo->estados[*pos] == ENTRADA_REMOVIDA)
+      continue;
+
+    Livro copia;
+    if (!visitar(livroDoCatalogo(bib, *pos, &copia), contexto))
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * Visita todos os livros em ordem de ID.
+ * Percorre a árvore em ordem (esquerda, raiz, direita) usando uma pilha
+ * explícita no lugar da recursão; antes de cada nó, visita as entradas do
+ * catálogo com ID menor, e no final as que sobraram. Sem catálogo, é só o
+ * percurso em ordem da árvore.
+ */
+int percorrerLivros(Biblioteca *bib, VisitarLivro visitar, void *contexto)
+{
+  PilhaLivros pilha = {NULL, 0, 0};
+  size_t pos = 0;
+  int ok = 1;
+  Livro *atual = bib->raiz;
+  while (ok && (atual != NULL || pilha.topo > 0))
+  {
+    // Desce pela esquerda empilhando o caminho
+    while (ok && atual != NULL)
+    {
+      ok = empilharLivro(&pilha, atual);
+      atual = atual->esq;
+    }
+    if (!ok)
+      break;
+
+    atual = pilha.itens[--pilha.topo];
+    ok = visitarCatalogo(bib, &pos, atual->id, visitar, contexto) && visitar(atual, contexto);
+    atual = atual->dir;
+  }
+  if (ok)
+    ok = visitarCatalogo(bib, &pos, LLONG_MAX, visitar, contexto);
+  free(pilha.itens);
+  return ok;
+}
+
+/*
+ * Empilha o caminho da subárvore que leva ao menor ID maior ou igual a
+ * `primeiro`: cada nó com ID na faixa é empilhado antes de descer para a
+ * esquerda; os demais são pulados pela direita, com toda a sua subárvore
+ * esquerda. O topo fica com o menor ID da faixa.
+ * Retorna 0 se não houver memória.
+ */
+int empilharFaixa(PilhaLivros *pilha, Livro *no, long long primeiro)
+{
+  while (no != NULL)
+  {
+    if (no->id >= primeiro)
+    {
+      if (!empilharLivro(pilha, no))
+        return 0;
+      no = no->esq;
+    }
+    else
+    {
+      no = no->dir;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Inicia um iterador na faixa [primeiro, ultimo].
+ * A descida até o primeiro ID custa O(log n) numa árvore balanceada, e a
+ * pilha fica só com os nós ainda não visitados do caminho. No catálogo,
+ * o ponto de partida é achado por busca binária.
+ */
+int iniciarIterador(IteradorLivros *iterador, Biblioteca *bib, int primeiro, int ultimo)
+{
+  iterador->bib = bib;
+  iterador->pilha.itens = NULL;
+  iterador->pilha.topo = 0;
+  iterador->pilha.capacidade = 0;
+  iterador->posCatalogo = posicaoCatalogo(&bib->catalogo, primeiro);
+  iterador->ultimo = ultimo;
+  iterador->restantes = SIZE_MAX;
+  iterador->erro = !empilharFaixa(&iterador->pilha, bib->raiz, primeiro);
+  if (iterador->erro)
+    iterador->restantes = 0;
+  return !iterador->erro;
+}
+
+/*
+ * Empilha o caminho até o livro de uma posição da subárvore, como
+ * livroNaPosicao: só os nós em que a descida vai para a esquerda ficam
+ * na pilha, porque são os que vêm depois do livro achado, que fica no
+ * topo. Retorna 0 se não houver memória.
+ */
+int empilharPosicao(PilhaLivros *pilha, Livro *no, int posicao)
+{
+  while (no != NULL)
+  {
+    int antes = contarLivros(no->esq);
+    if (posicao <= antes)
+    {
+      if (!empilharLivro(pilha, no))
+        return 0;
+      if (posicao == antes)
+        return 1;
+      no = no->esq;
+    }
+    else
+    {
+      posicao -= antes + 1;
+      no = no->dir;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Inicia um iterador na página informada: pula pagina * tamanho livros a
+ * partir do menor ID e limita o iterador a `tamanho` livros.
+ * Sem catálogo, o primeiro livro da página é achado pelos tamanhos das
+ * subárvores em O(log n), e a pilha fica pronta para seguir dali. Com
+ * catálogo, as duas sequências precisam ser intercaladas desde o início,
+ * então os livros das páginas anteriores são pulados um a um.
+ */
+int iniciarPagina(IteradorLivros *iterador, Biblioteca *bib, size_t pagina, size_t tamanho)
+{
+  if (!iniciarIterador(iterador, bib, INT_MIN, INT_MAX))
+    return 0;
+
+  size_t pular = tamanho > 0 && pagina > SIZE_MAX / tamanho ? SIZE_MAX : pagina * tamanho;
+  if (bib->catalogo.quantidade == 0)
+  {
+    // Troca o caminho até o menor ID pelo caminho até o primeiro da página
+    iterador->pilha.topo = 0;
+    if (pular >= (size_t)contarLivros(bib->raiz))
+    {
+      iterador->restantes = 0;
+      return 1;
+    }
+    iterador->erro = !empilharPosicao(&iterador->pilha, bib->raiz, (int)pular);
+    iterador->restantes = iterador->erro ? 0 : tamanho;
+    return !iterador->erro;
+  }
+
+  while (pular > 0 && proximoLivro(iterador) != NULL)
+    pular--;
+  iterador->restantes = pular > 0 ? 0 : tamanho;
+  return !iterador->erro;
+}
+
+/*
+ * Devolve o próximo livro da faixa.
+ *
+ * Como funciona:
+ * 1. Pula as entradas removidas do catálogo
+ * 2. Compara o ID do topo da pilha com o da próxima entrada do catálogo e
+ *    fica com o menor (os dois nunca são iguais: um livro do catálogo não
+ *    está na árvore)
+ * 3. Se o livro veio da árvore, desempilha o nó e empilha o caminho mais
+ *    à esquerda da sua subárvore direita
+ * 4. Se o ID passar do fim da faixa, o iterador termina
+ */
+const Livro *proximoLivro(IteradorLivros *iterador)
+{
+  if (iterador->restantes == 0)
+    return NULL;
+
+  Biblioteca *bib = iterador->bib;
+  Catalogo *catalogo = &bib->catalogo;
+  while (iterador->posCatalogo < catalogo->quantidade &&
+         catalogo->estados[iterador->posCatalogo] == ENTRADA_REMOVIDA)
+    iterador->posCatalogo++;
+
+  PilhaLivros *pilha = &iterador->pilha;
+  Livro *no = pilha->topo > 0 ? pilha->itens[pilha->topo - 1] : NULL;
+  const Livro *livro;
+  if (iterador->posCatalogo < catalogo->quantidade &&
+      (no == NULL || catalogo->ids[iterador->posCatalogo] < no->id))
+  {
+    livro = livroDoCatalogo(bib, iterador->posCatalogo++, &iterador->copia);
+  }
+  else if (no != NULL)
+  {
+    pilha->topo--;
+    if (!empilharFaixa(pilha, no->dir, LLONG_MIN))
+    {
+      iterador->erro = 1;
+      iterador->restantes = 0;
+      return NULL;
+    }
+    livro = no;
+  }
+  else
+  {
+    livro = NULL;
+  }
+
+  if (livro == NULL || livro->id > iterador->ultimo)
+  {
+    iterador->restantes = 0;
+    return NULL;
+  }
+  iterador->restantes--;
+  return livro;
+}
+
+/*
+ * Libera a pilha do iterador.
+ */
+void fecharIterador(IteradorLivros *iterador)
+{
+  free(iterador->pilha.itens);
+  iterador->pilha.itens = NULL;
+  iterador->pilha.topo = 0;
+  iterador->pilha.capacidade = 0;
+  iterador->restantes = 0;
+}
+
+/*
+ * Estado de uma listagem: a saída em buffer e quantos livros já foram
+ * escritos.
+ */
+typedef struct
+{
+  Saida saida; // Saída em buffer
+  int total;   // Livros escritos
+} Listagem;
+
+/*
+ * Escreve um livro na listagem e conta quantos foram escritos.
+ */
+int listarLivro(const Livro *livro, void *contexto)
+{
+  Listagem *listagem = (Listagem *)contexto;
+  listagem->total++;
+  escreverLivro(&listagem->saida, livro->id, livro->titulo, livro->autor, livro->disponivel);
+  return 1;
+}
+
+/*
+ * Lista todos os livros da biblioteca em ordem, com percorrerLivros, no
+ * descritor fd. Os livros são montados no buffer da saída, que é gravado
+ * com um write a cada TAMANHO_BUFFER_SAIDA bytes.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarLivrosDescritor(Biblioteca *bib, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = percorrerLivros(bib, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Biblioteca vazia!\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Lista todos os livros na saída padrão, com listarLivrosDescritor.
+ * O buffer do printf é descarregado antes, para a listagem não passar na
+ * frente de mensagens anteriores.
+ */
+void listarLivros(Biblioteca *bib)
+{
+  fflush(stdout);
+  if (!listarLivrosDescritor(bib, STDOUT_FILENO))
+    printf("Erro ao listar os livros.\n");
+}
+
+/*
+ * Acrescenta um livro ao índice de autores (usado com percorrerLivros).
+ */
+int guardarAutor(const Livro *livro, void *contexto)
+{
+  return adicionarAutor((IndiceAutores *)contexto, livro->autor, livro->id);
+}
+
+/*
+ * Compara dois IDs (para o qsort).
+ */
+int compararIds(const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Retorna o livro de um ID sem materializar nada: o nó do índice ou, para
+ * um livro do catálogo ainda sem nó, a cópia montada em *copia.
+ * Retorna NULL se o ID não estiver na biblioteca.
+ */
+const Livro *livroPorId(Biblioteca *bib, int id, Livro *copia)
+{
+  const Livro *livro = (const Livro *)consultarIndice(&bib->indice, id);
+  if (livro == NULL && bib->catalogo.quantidade > 0)
+  {
+    long pos = procurarCatalogo(&bib->catalogo, id);
+    if (pos >= 0 && bib->catalogo.estados[pos] != ENTRADA_REMOVIDA)
+      livro = livroDoCatalogo(bib, (size_t)pos, copia);
+  }
+  return livro;
+}
+
+/*
+ * Visita os livros de um vetor de IDs em ordem de ID e libera o vetor.
+ * Os IDs são ordenados e os repetidos, pulados; um ID que não está mais na
+ * biblioteca é ignorado.
+ */
+int visitarIds(Biblioteca *bib, VetorIds *ids, VisitarLivro visitar, void *contexto)
+{
+  if (ids->quantidade > 1)
+    qsort(ids->itens, ids->quantidade, sizeof(int), compararIds);
+  int ok = 1;
+  for (size_t i = 0; ok && i < ids->quantidade; i++)
+  {
+    if (i > 0 && ids->itens[i] == ids->itens[i - 1])
+      continue;
+    Livro copia;
+    const Livro *livro = livroPorId(bib, ids->itens[i], &copia);
+    if (livro != NULL)
+      ok = visitar(livro, contexto);
+  }
+  liberarIds(ids);
+  return ok;
+}
+
+/*
+ * Visita os livros de um autor em ordem de ID.
+ *
+ * Como funciona:
+ * 1. Na primeira busca, monta o índice de autores com percorrerLivros
+ *    (uma passada pela árvore e pelo catálogo); daí em diante, ele é
+ *    mantido por indexarLivro e desindexarLivro
+ * 2. Acha o autor na tabela hash e copia os IDs dos seus livros
+ * 3. Visita os livros com visitarIds
+ *
+ * Depois da montagem, o custo depende só da quantidade de livros do autor.
+ */
+int buscarPorAutor(Biblioteca *bib, const char *autor, VisitarLivro visitar, void *contexto)
+{
+  if (!bib->comAutores)
+  {
+    bib->comAutores = percorrerLivros(bib, guardarAutor, &bib->autores);
+    if (!bib->comAutores)
+    {
+      descartarAutores(bib);
+      return 0;
+    }
+  }
+
+  const EntradaAutor *entrada = consultarAutor(&bib->autores, autor, strlen(autor));
+  if (entrada == NULL || entrada->quantidade == 0)
+    return 1;
+  VetorIds ids;
+  iniciarIds(&ids);
+  ids.itens = (int *)malloc((size_t)entrada->quantidade * sizeof(int));
+  if (ids.itens == NULL)
+    return 0;
+  memcpy(ids.itens, entrada->ids, (size_t)entrada->quantidade * sizeof(int));
+  ids.quantidade = ids.capacidade = (size_t)entrada->quantidade;
+  return visitarIds(bib, &ids, visitar, contexto);
+}
+
+/*
+ * Acrescenta um livro ao índice de títulos (usado com percorrerLivros).
+ */
+int guardarTitulo(const Livro *livro, void *contexto)
+{
+  return adicionarTitulo((IndiceTitulos *)contexto, livro->titulo, livro->id);
+}
+
+/*
+ * Garante que o índice de títulos está montado.
+ * Na primeira busca por título, monta o índice com percorrerLivros; daí em
+ * diante, ele é mantido por indexarLivro e desindexarLivro. Como as listas
+ * de n-gramas guardam os livros removidos, o índice é remontado quando
+ * eles passam a ser mais que os livros presentes.
+ * Retorna 0 se não houver memória.
+ */
+int montarTitulos(Biblioteca *bib)
+{
+  if (bib->comTitulos && bib->titulos.removidos > bib->titulos.titulos)
+    descartarTitulos(bib);
+  if (!bib->comTitulos)
+  {
+    bib->comTitulos = percorrerLivros(bib, guardarTitulo, &bib->titulos);
+    if (!bib->comTitulos)
+      descartarTitulos(bib);
+  }
+  return bib->comTitulos;
+}
+
+/*
+ * Visita, em ordem de ID, os livros cujo título começa com o prefixo.
+ * A descida pela árvore radix custa o tamanho do prefixo; depois, só os
+ * livros encontrados são visitados.
+ */
+int buscarPorPrefixo(Biblioteca *bib, const char *prefixo, VisitarLivro visitar, void *contexto)
+{
+  if (!montarTitulos(bib))
+    return 0;
+
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!buscarPrefixoTitulos(&bib->titulos, prefixo, strlen(prefixo), &ids))
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+  return visitarIds(bib, &ids, visitar, contexto);
+}
+
+/*
+ * Filtro de uma busca por trecho: repassa ao visitante só os livros cujo
+ * título contém o trecho.
+ */
+typedef struct
+{
+  const char *trecho;   // Trecho buscado
+  size_t tamanho;       // Bytes do trecho
+  VisitarLivro visitar; // Visitante original
+  void *contexto;       // Contexto do visitante original
+} FiltroTrecho;
+
+/*
+ * Confere o trecho no título do livro (usado com percorrerLivros e
+ * visitarIds).
+ */
+int filtrarTrecho(const Livro *livro, void *contexto)
+{
+  FiltroTrecho *filtro = (FiltroTrecho *)contexto;
+  if (!contemTrecho(livro->titulo, tamanhoTexto(livro->titulo), filtro->trecho, filtro->tamanho))
+    return 1;
+  return filtro->visitar(livro, filtro->contexto);
+}
+
+/*
+ * Visita, em ordem de ID, os livros cujo título contém o trecho.
+ *
+ * Como funciona:
+ * 1. Um trecho menor que um n-grama não tem n-gramas para consultar, então
+ *    a biblioteca inteira é percorrida e filtrada
+ * 2. Senão, pega os candidatos na menor lista entre as dos n-gramas do
+ *    trecho
+ * 3. Visita os candidatos com visitarIds, conferindo o trecho no título
+ *    atual de cada um (o que também descarta os livros já removidos)
+ */
+int buscarPorTrecho(Biblioteca *bib, const char *trecho, VisitarLivro visitar, void *contexto)
+{
+  FiltroTrecho filtro;
+  filtro.trecho = trecho;
+  filtro.tamanho = strlen(trecho);
+  filtro.visitar = visitar;
+  filtro.contexto = contexto;
+  if (filtro.tamanho < TAMANHO_NGRAMA)
+    return percorrerLivros(bib, filtrarTrecho, &filtro);
+  if (!montarTitulos(bib))
+    return 0;
+
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!candidatosTrecho(&bib->titulos, trecho, filtro.tamanho, &ids))
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+  return visitarIds(bib, &ids, filtrarTrecho, &filtro);
+}
+
+/*
+ * Acrescenta um livro ao índice de palavras (usado com percorrerLivros).
+ */
+int guardarPalavras(const Livro *livro, void *contexto)
+{
+  return adicionarPalavras((IndicePalavras *)contexto, livro->titulo, livro->autor, livro->id);
+}
+
+/*
+ * Livro encontrado por uma busca por palavras, com a sua pontuação.
+ */
+typedef struct
+{
+  double pontos; // Pontuação do livro para a consulta
+  int id;        // ID do livro
+} Resultado;
+
+/*
+ * Compara dois resultados (para o qsort): maior pontuação primeiro e, no
+ * empate, menor ID.
+ */
+int compararResultados(const void *a, const void *b)
+{
+  const Resultado *x = (const Resultado *)a;
+  const Resultado *y = (const Resultado *)b;
+  if (x->pontos != y->pontos)
+    return x->pontos < y->pontos ? 1 : -1;
+  return (x->id > y->id) - (x->id < y->id);
+}
+
+/*
+ * Visita os livros que têm todas as palavras da consulta, do mais
+ * relevante para o menos.
+ *
+ * Como funciona:
+ * 1. Monta o índice de palavras na primeira busca (como o de títulos, ele
+ *    é remontado quando os removidos passam a ser mais que os presentes)
+ * 2. Quebra a consulta em palavras normalizadas e intersecta as listas
+ * 3. Confere e pontua cada livro encontrado com pontuarLivro, o que
+ *    também descarta os removidos
+ * 4. Ordena pela pontuação e visita cada livro pelo índice por ID
+ */
+int buscarPorPalavras(Biblioteca *bib, const char *consulta, VisitarLivro visitar, void *contexto)
+{
+  if (bib->comPalavras && bib->palavras.removidos > bib->palavras.livros)
+    descartarPalavras(bib);
+  if (!bib->comPalavras)
+  {
+    bib->comPalavras = percorrerLivros(bib, guardarPalavras, &bib->palavras);
+    if (!bib->comPalavras)
+    {
+      descartarPalavras(bib);
+      return 0;
+    }
+  }
+
+  ConsultaPalavras termos;
+  if (prepararConsulta(&bib->palavras, consulta, &termos) == 0)
+    return 1;
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!intersectarPalavras(&bib->palavras, &termos, &ids))
+  {
+    liberarIds(&ids);
+    descartarPalavras(bib);
+    return 0;
+  }
+  size_t espaco = ids.quantidade > 0 ? ids.quantidade : 1;
+  Resultado *resultados = (Resultado *)malloc(espaco * sizeof(Resultado));
+  if (resultados == NULL)
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+
+  size_t quantidade = 0;
+  for (size_t i = 0; i < ids.quantidade; i++)
+  {
+    Livro copia;
+    const Livro *livro = livroPorId(bib, ids.itens[i], &copia);
+    if (livro == NULL)
+      continue;
+    double pontos = pontuarLivro(&termos, livro->titulo, livro->autor);
+    if (pontos >= 0.0)
+    {
+      resultados[quantidade].pontos = pontos;
+      resultados[quantidade].id = livro->id;
+      quantidade++;
+    }
+  }
+  liberarIds(&ids);
+  if (quantidade > 1)
+    qsort(resultados, quantidade, sizeof(Resultado), compararResultados);
+
+  int ok = 1;
+  for (size_t i = 0; ok && i < quantidade; i++)
+  {
+    Livro copia;
+    ok = visitar(livroPorId(bib, resultados[i].id, &copia), contexto);
+  }
+  free(resultados);
+  return ok;
+}
+
+/*
+ * Lista no descritor fd os livros encontrados por uma busca (por autor,
+ * por título ou por palavras), com a mesma saída em buffer da
+ * listagem.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarBuscaDescritor(Biblioteca *bib, BuscarLivros buscar, const char *texto, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = buscar(bib, texto, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Nenhum livro encontrado.\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Acrescenta um livro ao mapa de disponíveis, se estiver disponível
+ * (usado com percorrerLivros).
+ */
+int guardarDisponivel(const Livro *livro, void *contexto)
+{
+  return !livro->disponivel || marcarBit((MapaBits *)contexto, livro->id);
+}
+
+/*
+ * Garante que o mapa de disponíveis está montado.
+ * Na primeira consulta, monta o mapa com percorrerLivros; daí em diante,
+ * ele é mantido por indexarLivro, desindexarLivro e definirDisponivel.
+ * Retorna 0 se não houver memória.
+ */
+int montarDisponiveis(Biblioteca *bib)
+{
+  if (!bib->comDisponiveis)
+  {
+    bib->comDisponiveis = percorrerLivros(bib, guardarDisponivel, &bib->disponiveis);
+    if (!bib->comDisponiveis)
+      descartarDisponiveis(bib);
+  }
+  return bib->comDisponiveis;
+}
+
+/*
+ * Conta os livros disponíveis com ID entre primeiro e ultimo, somando os
+ * bits do mapa de disponíveis, sem visitar os livros.
+ */
+int contarDisponiveis(Biblioteca *bib, int primeiro, int ultimo)
+{
+  if (!montarDisponiveis(bib))
+    return -1;
+  return (int)contarBitsFaixa(&bib->disponiveis, primeiro, ultimo);
+}
+
+/*
+ * Visitante original de uma busca de disponíveis, chamado para cada ID
+ * do mapa.
+ */
+typedef struct
+{
+  Biblioteca *bib;      // Biblioteca consultada
+  VisitarLivro visitar; // Visitante original
+  void *contexto;       // Contexto do visitante original
+} VisitaDisponiveis;
+
+/*
+ * Busca o livro de um ID do mapa e o passa ao visitante original (usado
+ * com percorrerBits).
+ */
+int visitarDisponivel(int id, void *contexto)
+{
+  VisitaDisponiveis *visita = (VisitaDisponiveis *)contexto;
+  Livro copia;
+  const Livro *livro = livroPorId(visita->bib, id, &copia);
+  return livro == NULL || visita->visitar(livro, visita->contexto);
+}
+
+/*
+ * Visita os livros disponíveis de uma faixa: percorre os bits ligados do
+ * mapa na faixa e busca cada livro pelo índice por ID.
+ */
+int buscarDisponiveis(Biblioteca *bib, int primeiro, int ultimo, VisitarLivro visitar, void *contexto)
+{
+  if (!montarDisponiveis(bib))
+    return 0;
+  VisitaDisponiveis visita;
+  visita.bib = bib;
+  visita.visitar = visitar;
+  visita.contexto = contexto;
+  return percorrerBits(&bib->disponiveis, primeiro, ultimo, visitarDisponivel, &visita);
+}
+
+/*
+ * Lista os livros disponíveis de uma faixa no descritor fd, com
+ * buscarDisponiveis e a mesma saída em buffer da listagem.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarDisponiveisDescritor(Biblioteca *bib, int primeiro, int ultimo, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = buscarDisponiveis(bib, primeiro, ultimo, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Nenhum livro disponível nessa faixa.\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Muda o status de um livro para `disponivel` e registra a mudança no
+ * diário como empréstimo ou devolução.
+ * Retorna 1 se o status mudou, 0 se o livro já tinha esse status e -1 se
+ * ele não foi encontrado.
+ */
+int mudarDisponivel(Biblioteca *bib, int id, int disponivel)
+{
+  Livro *livro = buscarLivro(bib, id);
+  if (livro == NULL)
+    return -1;
+  if (!livro->disponivel == !disponivel)
+    return 0;
+  definirDisponivel(bib, livro, disponivel);
+  registrarNoDiario(bib, disponivel ? OPERACAO_DEVOLVER : OPERACAO_EMPRESTAR, livro);
+  return 1;
+}
+
+/*
+ * Marca um livro como emprestado.
+ * Busca o livro e verifica se está disponível antes de emprestar.
+ */
+void emprestarLivro(Biblioteca *bib, int id)
+{
+  int resultado = mudarDisponivel(bib, id, 0);
+  if (resultado > 0)
+    printf("Livro emprestado com sucesso!\n");
+  else if (resultado == 0)
+    printf("Livro não está disponível para empréstimo.\n");
+  else
+    printf("Livro não encontrado.\n");
+}
+
+/*
+ * Marca um livro como devolvido.
+ * Busca o livro e verifica se está emprestado antes de devolver.
  */
-Livro *buscarLivro(Biblioteca *bib, int id)
+void devolverLivro(Biblioteca *bib, int id)
 {
-  return buscarLivroRecursivo(bib->raiz, id);
+  int resultado = mudarDisponivel(bib, id, 1);
+  if (resultado > 0)
+    printf("Livro devolvido com sucesso!\n");
+  else if (resultado == 0)
+    printf("Livro já está disponível.\n");
+  else
+    printf("Livro não encontrado.\n");
 }
 
 /*
- * Encontra o nó com o menor ID em uma subárvore.
- * Usado na remoção de nós com dois filhos.
+ * Busca um livro pelo ID com a fatia do ID travada para leitura.
+ * livroPorId só lê o índice e o catálogo; a cópia é feita ainda com a
+ * trava, porque um escritor pode mudar o status ou devolver o nó ao pool
+ * logo depois que ela for solta.
  */
-Livro *encontrarMenor(Livro *raiz)
+int consultarLivro(Biblioteca *bib, int id, Livro *copia)
 {
-  Livro *atual = raiz;
-  while (atual && atual->esq != NULL)
+  int fatia = fatiaDoId(id);
+  travarLeitura(&bib->trava, fatia);
+  Livro lido;
+  const Livro *livro = livroPorId(bib, id, &lido);
+  if (livro != NULL)
   {
-    atual = atual->esq;
+    memset(copia, 0, sizeof(*copia));
+    copia->id = livro->id;
+    copia->disponivel = livro->disponivel;
+    copia->titulo = livro->titulo;
+    copia->autor = livro->autor;
   }
-  return atual;
+  destravarLeitura(&bib->trava, fatia);
+  return livro != NULL;
 }
 
 /*
- * Função auxiliar para remover um livro da árvore.
- * Remove o livro mantendo a propriedade da ABB.
- * Trata três casos: nó sem filhos, com um filho e com dois filhos.
+ * Trava todas as fatias para escrita.
  */
-Livro *removerLivroRecursivo(Livro *raiz, int id)
+void travarBiblioteca(Biblioteca *bib)
 {
-  if (raiz == NULL)
-    return raiz;
-
-  if (id < raiz->id)
-  {
-    raiz->esq = removerLivroRecursivo(raiz->esq, id);
-  }
-  else if (id > raiz->id)
-  {
-    raiz->dir = removerLivroRecursivo(raiz->dir, id);
-  }
-  else
-  {
-    if (raiz->esq == NULL)
-    {
-      Livro *temp = raiz->dir;
-      free(raiz);
-      return temp;
-    }
-    else if (raiz->dir == NULL)
-    {
-      Livro *temp = raiz->esq;
-      free(raiz);
-      return temp;
-    }
-
-    Livro *temp = encontrarMenor(raiz->dir);
-    raiz->id = temp->id;
-    strcpy(raiz->titulo, temp->titulo);
-    strcpy(raiz->autor, temp->autor);
-    raiz->disponivel = temp->disponivel;
-    raiz->dir = removerLivroRecursivo(raiz->dir, temp->id);
-  }
-  return raiz;
+  travarEscrita(&bib->trava);
 }
 
 /*
- * Remove um livro da biblioteca pelo ID.
- * Chama a função recursiva para remover da árvore.
+ * Solta todas as fatias.
  */
-void removerLivro(Biblioteca *bib, int id)
+void destravarBiblioteca(Biblioteca *bib)
 {
-  bib->raiz = removerLivroRecursivo(bib->raiz, id);
+  destravarEscrita(&bib->trava);
 }
 
 /*
- * Função auxiliar para listar os livros em ordem.
- * Percorre a árvore em ordem (esquerda, raiz, direita).
+ * Insere um livro com a biblioteca travada.
  */
-void listarLivrosRecursivo(Livro *raiz)
+void inserirLivroConcorrente(Biblioteca *bib, int id, const char *titulo, const char *autor)
 {
-  if (raiz != NULL)
-  {
-    listarLivrosRecursivo(raiz->esq);
-    printf("ID: %d\n", raiz->id);
-    printf("Título: %s\n", raiz->titulo);
-    printf("Autor: %s\n", raiz->autor);
-    printf("Disponível: %s\n", raiz->disponivel ? "Sim" : "Não");
-    printf("------------------------\n");
-    listarLivrosRecursivo(raiz->dir);
-  }
+  travarBiblioteca(bib);
+  inserirLivro(bib, id, titulo, autor);
+  destravarBiblioteca(bib);
 }
 
 /*
- * Lista todos os livros da biblioteca em ordem.
- * Verifica se a biblioteca está vazia e chama a função recursiva.
+ * Remove um livro com a biblioteca travada.
  */
-void listarLivros(Livro *raiz)
+void removerLivroConcorrente(Biblioteca *bib, int id)
 {
-  if (raiz == NULL)
-  {
-    printf("Biblioteca vazia!\n");
-    return;
-  }
-  listarLivrosRecursivo(raiz);
+  travarBiblioteca(bib);
+  removerLivro(bib, id);
+  destravarBiblioteca(bib);
 }
 
 /*
- * Marca um livro como emprestado.
- * Busca o livro e verifica se está disponível antes de emprestar.
+ * Empresta um livro com a biblioteca travada.
  */
-void emprestarLivro(Biblioteca *bib, int id)
+int emprestarLivroConcorrente(Biblioteca *bib, int id)
 {
-  Livro *livro = buscarLivro(bib, id);
-  if (livro != NULL)
-  {
-    if (livro->disponivel)
-    {
-      livro->disponivel = 0;
-      printf("Livro emprestado com sucesso!\n");
-    }
-    else
-    {
-      printf("Livro não está disponível para empréstimo.\n");
-    }
-  }
-  else
-  {
-    printf("Livro não encontrado.\n");
-  }
+  travarBiblioteca(bib);
+  int resultado = mudarDisponivel(bib, id, 0);
+  destravarBiblioteca(bib);
+  return resultado > 0;
 }
 
 /*
- * Marca um livro como devolvido.
- * Busca o livro e verifica se está emprestado antes de devolver.
+ * Devolve um livro com a biblioteca travada.
  */
-void devolverLivro(Biblioteca *bib, int id)
+int devolverLivroConcorrente(Biblioteca *bib, int id)
 {
-  Livro *livro = buscarLivro(bib, id);
-  if (livro != NULL)
-  {
-    if (!livro->disponivel)
-    {
-      livro->disponivel = 1;
-      printf("Livro devolvido com sucesso!\n");
-    }
-    else
-    {
-      printf("Livro já está disponível.\n");
-    }
-  }
-  else
-  {
-    printf("Livro não encontrado.\n");
-  }
+  travarBiblioteca(bib);
+  int resultado = mudarDisponivel(bib, id, 1);
+  destravarBiblioteca(bib);
+  return resultado > 0;
 }
 
 /*
@@ -283,19 +1775,33 @@ void devolverLivro(Biblioteca *bib, int id)
  * 1. Percorre a árvore em ordem (esquerda -> raiz -> direita)
  * 2. Coloca cada livro no vetor na ordem correta
  * 3. Incrementa a posição no vetor
+ *
+ * O percurso usa o próprio vetor de saída como pilha: os livros ainda
+ * pendentes ficam no fim do vetor, crescendo de trás para frente, e nunca
+ * encostam nos livros já armazenados (há exatamente n posições).
  */
 void armazenarLivrosEmOrdem(Livro *raiz, Livro **vetor, int *pos)
 {
-  if (raiz != NULL)
+  int n = contarLivros(raiz);
+  int topo = *pos + n; // A pilha ocupa vetor[topo .. *pos + n - 1]
+  int limite = topo;
+  Livro *atual = raiz;
+
+  while (atual != NULL || topo < limite)
   {
-    // Primeiro percorre a subárvore esquerda
-    armazenarLivrosEmOrdem(raiz->esq, vetor, pos);
+    // Primeiro desce pela subárvore esquerda, empilhando o caminho
+    while (atual != NULL)
+    {
+      vetor[--topo] = atual;
+      atual = atual->esq;
+    }
 
     // Depois coloca o nó atual no vetor
-    vetor[(*pos)++] = raiz;
+    atual = vetor[topo++];
+    vetor[(*pos)++] = atual;
 
     // Por fim percorre a subárvore direita
-    armazenarLivrosEmOrdem(raiz->dir, vetor, pos);
+    atual = atual->dir;
   }
 }
 
@@ -381,56 +1887,451 @@ void salvarLivrosBalanceado(Livro *raiz, FILE *arquivo)
   free(vetor);
 }
 
+/*
+ * Acrescenta um livro ao vetor de registros passado como contexto.
+ * Usado com percorrerLivros para juntar os livros em ordem de ID.
+ */
+int guardarRegistro(const Livro *livro, void *contexto)
+{
+  RegistroLivro registro = {livro->id, livro->disponivel, livro->titulo, livro->autor};
+  return adicionarRegistro((VetorRegistros *)contexto, &registro);
+}
+
+/*
+ * Salva registros em ordem balanceada, como salvarBalanceadoRecursivo,
+ * mas a partir de um vetor de registros (que também traz os livros do
+ * catálogo mapeado, que não estão na árvore).
+ */
+void salvarRegistrosBalanceado(const RegistroLivro *registros, int inicio, int fim, FILE *arquivo)
+{
+  if (inicio <= fim)
+  {
+    int meio = (inicio + fim) / 2;
+    const RegistroLivro *registro = &registros[meio];
+    fprintf(arquivo, "%d|%s|%s|%d\n", registro->id, registro->titulo, registro->autor, registro->disponivel);
+    salvarRegistrosBalanceado(registros, inicio, meio - 1, arquivo);
+    salvarRegistrosBalanceado(registros, meio + 1, fim, arquivo);
+  }
+}
+
 /*
  * Função que salva os livros no arquivo.
- * Usa salvamento balanceado para manter a árvore balanceada.
+ * Usa salvamento balanceado para manter a árvore balanceada: junta os
+ * livros em ordem com percorrerLivros e salva pelo meio de cada intervalo.
  */
-void salvarLivros(Livro *raiz, FILE *arquivo)
+void salvarLivros(Biblioteca *bib, FILE *arquivo)
 {
-  salvarLivrosBalanceado(raiz, arquivo);
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  if (percorrerLivros(bib, guardarRegistro, &registros))
+    salvarRegistrosBalanceado(registros.itens, 0, (int)registros.quantidade - 1, arquivo);
+  liberarRegistros(&registros);
 }
 
 /*
- * Carrega livros de um arquivo para a biblioteca.
- * Lê o arquivo linha por linha, criando um novo livro para cada linha.
+ * Grava o snapshot da biblioteca.
+ * Junta os livros em ordem num vetor de registros com percorrerLivros e
+ * grava tudo de uma vez com salvarSnapshot. Os textos já estão no formato
+ * do arquivo, na arena ou nas páginas do catálogo mapeado.
  */
-void carregarLivros(Biblioteca *bib, const char *nomeArquivo)
+int gravarSnapshot(void *contexto, FILE *arquivo)
 {
-  FILE *arquivo = fopen(nomeArquivo, "r");
   if (arquivo == NULL)
+    return 0;
+
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  int ok = percorrerLivros((Biblioteca *)contexto, guardarRegistro, &registros) &&
+           salvarSnapshot(arquivo, registros.itens, registros.quantidade);
+  liberarRegistros(&registros);
+  return ok;
+}
+
+/*
+ * Salva todos os livros em formato binário (snapshot), usando
+ * gravarSnapshot.
+ */
+int salvarLivrosBinario(Biblioteca *bib, FILE *arquivo)
+{
+  int ok = gravarSnapshot(bib, arquivo);
+  if (ok)
+    printf("Livros salvos com sucesso!\n");
+  else
+    printf("Erro ao salvar os livros.\n");
+  return ok;
+}
+
+/*
+ * Função auxiliar que monta uma subárvore a partir de registros ordenados.
+ * Usa divisão e conquista, como salvarBalanceadoRecursivo: o registro do
+ * meio vira a raiz e as metades viram as subárvores.
+ *
+ * Como todas as folhas ficam no último ou no penúltimo nível, basta pintar
+ * de vermelho os nós do último nível (profundidadeMax) e de preto os demais
+ * para que a árvore também seja uma rubro-negra válida.
+ *
+ * Se faltar memória para um nó, *ok vira 0 e a montagem para; os nós já
+ * montados continuam ligados à raiz, para serem desfeitos por
+ * desmontarSubarvore.
+ * Retorna a raiz da subárvore montada.
+ */
+Livro *montarSubarvore(Biblioteca *bib, RegistroLivro *registros, int inicio, int fim,
+                       int profundidade, int profundidadeMax, Livro *pai, int *ok)
+{
+  if (inicio > fim || !*ok)
+    return NULL;
+
+  int meio = (inicio + fim) / 2;
+  Livro *no = (Livro *)alocarNo(&bib->nos);
+  if (no == NULL)
   {
-    printf("Erro ao abrir arquivo para leitura.\n");
-    return;
+    *ok = 0;
+    return NULL;
   }
 
-  int id, disponivel;
-  char titulo[MAX_TITULO], autor[MAX_AUTOR];
-  char linha[256];
+  no->id = registros[meio].id;
+  no->disponivel = registros[meio].disponivel;
+  no->titulo = registros[meio].titulo;
+  no->autor = registros[meio].autor;
+  no->pai = pai;
+  no->cor = (profundidade == profundidadeMax && profundidade > 0) ? VERMELHO : PRETO;
+  indexarLivro(bib, no);
+  no->esq = montarSubarvore(bib, registros, inicio, meio - 1, profundidade + 1, profundidadeMax, no, ok);
+  no->dir = montarSubarvore(bib, registros, meio + 1, fim, profundidade + 1, profundidadeMax, no, ok);
+  atualizarAltura(no);
+  return no;
+}
 
-  while (fgets(linha, sizeof(linha), arquivo))
+/*
+ * Desfaz uma subárvore montada pela metade: tira cada nó dos índices e o
+ * devolve ao pool. Percorre em pós-ordem pelos ponteiros para o pai, sem
+ * pilha, porque é chamada justamente quando falta memória.
+ */
+void desmontarSubarvore(Biblioteca *bib, Livro *raiz)
+{
+  Livro *no = raiz;
+  while (no != NULL)
   {
-    sscanf(linha, "%d|%[^|]|%[^|]|%d", &id, titulo, autor, &disponivel);
-    inserirLivro(bib, id, titulo, autor);
-    Livro *livro = buscarLivro(bib, id);
+    if (no->esq != NULL)
+    {
+      no = no->esq;
+    }
+    else if (no->dir != NULL)
+    {
+      no = no->dir;
+    }
+    else
+    {
+      Livro *pai = no == raiz ? NULL : no->pai;
+      if (pai != NULL && pai->esq == no)
+        pai->esq = NULL;
+      else if (pai != NULL)
+        pai->dir = NULL;
+      desindexarLivro(bib, no);
+      devolverNo(&bib->nos, no);
+      no = pai;
+    }
+  }
+}
+
+/*
+ * Monta a árvore de uma biblioteca vazia a partir de um vetor de registros.
+ *
+ * Como funciona:
+ * 1. Ordena os registros por ID (radix sort, ou só confere se já vierem
+ *    em ordem) e descarta IDs repetidos
+ * 2. Calcula a profundidade do último nível: floor(log2(n))
+ * 3. Monta a árvore pelo meio de cada intervalo, sem buscar nenhum ID
+ * 4. Se faltar memória no meio, desfaz o que foi montado e a biblioteca
+ *    continua vazia
+ */
+int montarArvoreOrdenada(Biblioteca *bib, VetorRegistros *registros)
+{
+  if (bib->raiz != NULL || !ordenarRegistros(registros))
+    return 0;
+  removerRegistrosRepetidos(registros);
+  if (!reservarIndice(&bib->indice, registros->quantidade))
+    return 0;
+
+  int n = (int)registros->quantidade;
+  int profundidadeMax = 0;
+  while ((n >> (profundidadeMax + 1)) > 0)
+  {
+    profundidadeMax++;
+  }
+
+  int ok = 1;
+  Livro *raiz = montarSubarvore(bib, registros->itens, 0, n - 1, 0, profundidadeMax, NULL, &ok);
+  if (!ok)
+  {
+    desmontarSubarvore(bib, raiz);
+    return 0;
+  }
+  bib->raiz = raiz;
+  return 1;
+}
+
+/*
+ * Insere na árvore existente livros lidos de um snapshot, um por vez.
+ * Usado quando a biblioteca já tem livros e não dá para montar em lote.
+ */
+void inserirRegistros(Biblioteca *bib, VetorRegistros *registros)
+{
+  for (size_t i = 0; i < registros->quantidade; i++)
+  {
+    RegistroLivro *registro = &registros->itens[i];
+    inserirLivro(bib, registro->id, registro->titulo, registro->autor);
+    Livro *livro = buscarLivro(bib, registro->id);
     if (livro != NULL)
     {
-      livro->disponivel = disponivel;
+      definirDisponivel(bib, livro, registro->disponivel);
     }
   }
+}
+
+/*
+ * Recebe uma linha lida por lerArquivoLivros e insere o livro na árvore
+ * existente.
+ */
+int receberLivroTexto(void *contexto, const CamposLivro *campos)
+{
+  Biblioteca *bib = (Biblioteca *)contexto;
+  inserirLivro(bib, campos->id, campos->titulo, campos->autor);
+  Livro *livro = buscarLivro(bib, campos->id);
+  if (livro != NULL)
+  {
+    definirDisponivel(bib, livro, campos->disponivel);
+  }
+  return 1;
+}
+
+/*
+ * Lê um arquivo texto no formato id|titulo|autor|disponivel.
+ * Em lote, o arquivo é lido em paralelo por lerRegistrosTexto e os livros
+ * só são guardados no vetor de registros; senão, cada linha lida por
+ * lerArquivoLivros é inserida na árvore existente.
+ * Retorna 0 se não houver memória.
+ */
+int lerLivrosTexto(Biblioteca *bib, FILE *arquivo, int emLote, VetorRegistros *registros)
+{
+  if (emLote)
+    return lerRegistrosTexto(arquivo, 0, &bib->textos, registros);
+  return lerArquivoLivros(arquivo, receberLivroTexto, bib);
+}
+
+/*
+ * Aplica uma operação lida do diário, sem imprimir mensagens.
+ * Empréstimo e devolução só definem o status, então reaplicar uma operação
+ * que o snapshot já contém não muda nada.
+ */
+void aplicarOperacao(void *contexto, TipoOperacao operacao, int id, const char *titulo, const char *autor)
+{
+  Biblioteca *bib = (Biblioteca *)contexto;
+  Livro *livro;
+  switch (operacao)
+  {
+  case OPERACAO_INSERIR:
+    inserirLivro(bib, id, titulo, autor);
+    break;
+  case OPERACAO_REMOVER:
+    removerLivro(bib, id);
+    break;
+  default:
+    livro = buscarLivro(bib, id);
+    if (livro != NULL)
+      definirDisponivel(bib, livro, operacao == OPERACAO_DEVOLVER);
+  }
+}
+
+/*
+ * Reaplica o diário da biblioteca, se houver, por cima do que acabou de
+ * ser carregado. O diário fica desligado durante a reaplicação, para as
+ * operações não serem registradas de novo. Se o diário for lido até o fim,
+ * a memória passa a conter todas as operações dele e um salvamento já pode
+ * rotacioná-lo.
+ */
+void reaplicarDiario(Biblioteca *bib)
+{
+  Diario *diario = bib->diario;
+  if (diario == NULL)
+    return;
+
+  bib->diario = NULL;
+  long aplicadas = reproduzirDiario(diario, aplicarOperacao, bib);
+  bib->diario = diario;
+  if (aplicadas < 0)
+    printf("Erro ao ler o diário de operações.\n");
+  else if (aplicadas > 0)
+    printf("%ld operações do diário reaplicadas.\n", aplicadas);
+  if (aplicadas >= 0)
+    bib->diarioReaplicado = 1;
+}
+
+/*
+ * Carrega livros de um arquivo para a biblioteca.
+ * Um snapshot binário é lido de uma vez por lerSnapshot; um arquivo texto
+ * é lido por lerLivrosTexto (em várias threads, na carga em lote).
+ *
+ * Se a biblioteca estiver vazia (caso comum, ao iniciar o programa), os
+ * livros são só guardados num vetor e a árvore é montada no final por
+ * montarArvoreOrdenada, em tempo linear e sem buscas. Senão, cada livro
+ * é inserido na árvore existente (também com um catálogo mapeado aberto,
+ * para os IDs repetidos serem descartados).
+ *
+ * O diário fica desligado durante a carga.
+ * Retorna 1 se todos os livros foram carregados.
+ */
+int carregarArquivo(Biblioteca *bib, const char *nomeArquivo)
+{
+  FILE *arquivo = fopen(nomeArquivo, "rb");
+  if (arquivo == NULL)
+  {
+    printf("Erro ao abrir arquivo para leitura.\n");
+    return 0;
+  }
+
+  int emLote = bib->raiz == NULL && bib->catalogo.mapa == NULL;
+  int ok;
+  Diario *diario = bib->diario;
+  bib->diario = NULL;
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+
+  if (ehSnapshot(arquivo))
+  {
+    ok = lerSnapshot(arquivo, &bib->textos, &registros);
+    if (ok && !emLote)
+      inserirRegistros(bib, &registros);
+  }
+  else
+  {
+    ok = lerLivrosTexto(bib, arquivo, emLote, &registros);
+  }
+
+  if (emLote && ok && registros.quantidade > 0)
+  {
+    ok = montarArvoreOrdenada(bib, &registros);
+  }
+  liberarRegistros(&registros);
+  bib->diario = diario;
 
   fclose(arquivo);
-  printf("Livros carregados com sucesso!\n");
+  if (ok)
+    printf("Livros carregados com sucesso!\n");
+  else
+    printf("Arquivo inválido ou memória insuficiente para carregar os livros.\n");
+  return ok;
+}
+
+/*
+ * Carrega o arquivo principal da biblioteca e reaplica o diário por cima,
+ * seja o arquivo um snapshot ou texto: as operações do diário são
+ * idempotentes, então reaplicar as que o arquivo já contém não muda nada.
+ */
+void carregarLivros(Biblioteca *bib, const char *nomeArquivo)
+{
+  if (carregarArquivo(bib, nomeArquivo))
+    reaplicarDiario(bib);
+}
+
+/*
+ * Importa livros de um arquivo sem reaplicar o diário, que não se refere
+ * a ele.
+ */
+void importarLivros(Biblioteca *bib, const char *nomeArquivo)
+{
+  carregarArquivo(bib, nomeArquivo);
+}
+
+/*
+ * Abre um snapshot como catálogo mapeado.
+ * Só é permitido com a biblioteca vazia, para os livros do catálogo não
+ * repetirem IDs de livros que já estão na árvore.
+ */
+void mapearCatalogo(Biblioteca *bib, const char *nomeArquivo)
+{
+  if (bib->raiz != NULL || bib->catalogo.mapa != NULL)
+  {
+    printf("O catálogo só pode ser aberto com a biblioteca vazia.\n");
+    return;
+  }
+  if (abrirCatalogo(&bib->catalogo, nomeArquivo))
+  {
+    printf("Catálogo aberto com %zu livros!\n", bib->catalogo.quantidade);
+    reaplicarDiario(bib);
+  }
+  else
+  {
+    printf("Arquivo inválido ou memória insuficiente para abrir o catálogo.\n");
+  }
 }
 
 /*
- * Conta o número total de livros na biblioteca.
- * Percorre a árvore contando todos os nós.
+ * Conta os livros de uma subárvore.
+ * Cada nó guarda o tamanho da sua subárvore, então basta ler o da raiz.
  */
 int contarLivros(Livro *raiz)
 {
-  if (raiz == NULL)
-    return 0;
-  return 1 + contarLivros(raiz->esq) + contarLivros(raiz->dir);
+  return raiz != NULL ? raiz->tamanho : 0;
+}
+
+/*
+ * Conta os livros da biblioteca: os da árvore e as entradas do catálogo
+ * que não foram removidas. Os nós materializados não estão na árvore,
+ * então cada livro é contado uma vez só.
+ */
+int quantidadeLivros(Biblioteca *bib)
+{
+  return contarLivros(bib->raiz) + (int)(bib->catalogo.quantidade - bib->catalogo.removidas);
+}
+
+/*
+ * Calcula a posição de um ID descendo da raiz: a cada passo para a
+ * direita, o nó e a sua subárvore esquerda ficam antes do ID.
+ */
+int posicaoLivro(Livro *raiz, int id)
+{
+  int posicao = 0;
+  while (raiz != NULL)
+  {
+    if (id <= raiz->id)
+    {
+      raiz = raiz->esq;
+    }
+    else
+    {
+      posicao += contarLivros(raiz->esq) + 1;
+      raiz = raiz->dir;
+    }
+  }
+  return posicao;
+}
+
+/*
+ * Acha o livro de uma posição descendo da raiz: a subárvore esquerda diz
+ * quantos livros vêm antes do nó, e o lado a seguir sai da comparação
+ * com ela.
+ */
+Livro *livroNaPosicao(Livro *raiz, int posicao)
+{
+  while (raiz != NULL)
+  {
+    int antes = contarLivros(raiz->esq);
+    if (posicao < antes)
+    {
+      raiz = raiz->esq;
+    }
+    else if (posicao == antes)
+    {
+      return raiz;
+    }
+    else
+    {
+      posicao -= antes + 1;
+      raiz = raiz->dir;
+    }
+  }
+  return NULL;
 }
 
 /*
@@ -13,49 +13,201 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_TITULO 500 // Tamanho máximo para o título do livro
-#define MAX_AUTOR 500  // Tamanho máximo para o nome do autor
+#include "../Comum/arena.h"
+#include "../Comum/autores.h"
+#include "../Comum/mapabits.h"
+#include "../Comum/palavras.h"
+#include "../Comum/titulos.h"
+#include "../Comum/catalogo.h"
+#include "../Comum/compactacao.h"
+#include "../Comum/diario.h"
+#include "../Comum/indice.h"
+#include "../Comum/leitor.h"
+#include "../Comum/pool.h"
+#include "../Comum/registro.h"
+#include "../Comum/saida.h"
+#include "../Comum/snapshot.h"
+#include "../Comum/trava.h"
+
+#define MAX_TITULO 500 // Tamanho máximo do título digitado no menu
+#define MAX_AUTOR 500  // Tamanho máximo do autor digitado no menu
+
+/*
+ * Tipos de árvore suportados pela biblioteca.
+ * A ABB simples não rebalanceia e depende do salvamento balanceado;
+ * a AVL rebalanceia a cada inserção e remoção, mantendo altura O(log n);
+ * a rubro-negra também mantém altura O(log n), mas faz no máximo duas
+ * rotações por inserção e três por remoção, e todas as suas operações
+ * são iterativas (usam o ponteiro para o pai em vez de recursão).
+ */
+typedef enum
+{
+  ARVORE_ABB,        // Árvore binária de busca simples
+  ARVORE_AVL,        // Árvore AVL (autobalanceada)
+  ARVORE_RUBRO_NEGRA // Árvore rubro-negra (autobalanceada, iterativa)
+} TipoArvore;
+
+/*
+ * Cores dos nós da árvore rubro-negra.
+ */
+typedef enum
+{
+  VERMELHO,
+  PRETO
+} CorLivro;
 
 /*
  * Estrutura que representa um livro na árvore.
  * Cada livro tem um ID único, título, autor e status de disponibilidade.
  * Os ponteiros esq e dir apontam para os filhos na árvore.
+ * O campo altura só é mantido quando a biblioteca é do tipo AVL;
+ * os campos cor e pai só são mantidos na rubro-negra. O campo tamanho
+ * (quantos livros há na subárvore) é mantido nos três tipos, nas
+ * inserções, remoções e rotações, e dá a contagem em O(1) e a posição de
+ * um livro na ordem de ID (e o livro de uma posição) em O(altura).
+ *
+ * O nó guarda apenas os campos usados na descida da busca (ID, status e
+ * ponteiros); título e autor ficam fora do nó, na arena de textos da
+ * biblioteca, e são acessados só quando o livro é exibido ou salvo. Assim o nó ocupa 64
+ * bytes em vez de mais de 1 KB, e o caminho da busca cabe em poucas
+ * linhas de cache.
  */
 typedef struct Livro
 {
-  int id;                  // ID único do livro
-  char titulo[MAX_TITULO]; // Título do livro
-  char autor[MAX_AUTOR];   // Nome do autor
-  int disponivel;          // 1 se disponível, 0 se emprestado
-  struct Livro *esq;       // Ponteiro para o filho esquerdo (ID menor)
-  struct Livro *dir;       // Ponteiro para o filho direito (ID maior)
+  int id;            // ID único do livro
+  int disponivel;    // 1 se disponível, 0 se emprestado
+  int altura;        // Altura da subárvore (usada pela AVL)
+  int tamanho;       // Quantidade de livros na subárvore (o nó incluído)
+  CorLivro cor;      // Cor do nó (usada pela rubro-negra)
+  struct Livro *esq; // Ponteiro para o filho esquerdo (ID menor)
+  struct Livro *dir; // Ponteiro para o filho direito (ID maior)
+  struct Livro *pai; // Ponteiro para o pai (usado pela rubro-negra)
+  char *titulo;      // Título do livro (na arena da biblioteca)
+  char *autor;       // Nome do autor (na arena da biblioteca)
 } Livro;
 
 /*
  * Estrutura principal da biblioteca.
- * Mantém apenas o ponteiro para a raiz da árvore.
+ * Mantém o ponteiro para a raiz da árvore, o tipo de árvore usado, o pool
+ * de onde saem os nós e a arena onde ficam os títulos e autores de todos
+ * os livros. Os textos de livros removidos só são devolvidos quando a
+ * biblioteca é destruída; os nós removidos voltam ao pool e são reusados.
+ *
+ * O índice hash leva de cada ID ao seu nó, então buscas, empréstimos e
+ * devoluções não descem pela árvore; a árvore continua sendo usada para
+ * listar e salvar em ordem. Como a remoção religa os nós em vez de copiar
+ * dados entre eles, um nó nunca muda de endereço enquanto está na árvore.
+ *
+ * Com um catálogo mapeado aberto (mapearCatalogo), os livros do catálogo
+ * não entram na árvore: buscas e listagens usam direto as páginas
+ * mapeadas. Um livro do catálogo só ganha um nó (fora da árvore, só no
+ * índice) na primeira vez que é buscado, para poder ser emprestado ou
+ * devolvido. A árvore guarda só os livros inseridos depois, e a listagem
+ * intercala as duas sequências em ordem de ID.
+ *
+ * O índice de autores leva de cada autor aos IDs dos seus livros. Ele só é
+ * montado na primeira busca por autor (então carregar ou mapear livros não
+ * paga por ele) e, daí em diante, acompanha cada livro que entra ou sai
+ * do índice por ID. O índice de títulos (árvore radix e n-gramas) e o de
+ * palavras seguem a mesma regra, a partir da primeira busca por título ou
+ * por palavras. O mapa de disponíveis guarda os IDs dos livros
+ * disponíveis num mapa de bits comprimido; é montado na primeira consulta
+ * de disponíveis e acompanha também os empréstimos e as devoluções.
+ *
+ * Com um diário ligado, cada inserção, remoção, empréstimo e devolução
+ * feita pelas funções abaixo é registrada nele; a carga de arquivos não é.
+ *
+ * A trava fatiada deixa a biblioteca ser usada por várias threads:
+ * consultarLivro trava só uma fatia para leitura, então buscas por ID
+ * de threads diferentes correm em paralelo; travarBiblioteca e as
+ * funções terminadas em Concorrente travam todas as fatias. As demais
+ * funções não travam nada e, com outras threads usando a biblioteca,
+ * devem ser chamadas entre travarBiblioteca e destravarBiblioteca. Isso
+ * vale também para buscarLivro e as buscas por autor, título, palavras e
+ * disponíveis, que podem montar índices e dar nó a livros do catálogo.
  */
 typedef struct
 {
-  Livro *raiz; // Ponteiro para a raiz da árvore
+  Livro *raiz;             // Ponteiro para a raiz da árvore
+  TipoArvore tipo;         // Estratégia de balanceamento da árvore
+  PoolNos nos;             // Pool de nós da árvore
+  Arena textos;            // Títulos e autores dos livros
+  IndiceHash indice;       // Índice de ID para nó
+  IndiceAutores autores;   // Índice de autor para IDs (montado na primeira busca por autor)
+  int comAutores;          // 1 se o índice de autores está montado e sendo mantido
+  IndiceTitulos titulos;   // Índice de títulos (montado na primeira busca por título)
+  int comTitulos;          // 1 se o índice de títulos está montado e sendo mantido
+  IndicePalavras palavras; // Índice de palavras (montado na primeira busca por palavras)
+  int comPalavras;         // 1 se o índice de palavras está montado e sendo mantido
+  MapaBits disponiveis;    // IDs dos livros disponíveis (montado na primeira consulta)
+  int comDisponiveis;      // 1 se o mapa de disponíveis está montado e sendo mantido
+  Catalogo catalogo;       // Catálogo mapeado (fechado se não for usado)
+  Diario *diario;          // Diário de operações (NULL se não for usado)
+  int diarioReaplicado;    // 1 se a memória já contém as operações do diário (livros.dat carregado e diário reaplicado)
+  TravaFatiada trava;      // Trava de leitura e escrita das threads
 } Biblioteca;
 
 /*
- * Cria uma nova biblioteca vazia.
+ * Função chamada para cada livro por percorrerLivros.
+ * Retorna 0 para interromper o percurso.
+ */
+typedef int (*VisitarLivro)(const Livro *livro, void *contexto);
+
+/*
+ * Pilha dinâmica de ponteiros para livros.
+ * Substitui a pilha de chamadas nos percursos da árvore, para que uma
+ * árvore degenerada (altura n) não estoure a pilha do programa.
+ */
+typedef struct
+{
+  Livro **itens;  // Vetor com os livros empilhados
+  int topo;       // Quantidade de livros na pilha
+  int capacidade; // Tamanho alocado do vetor
+} PilhaLivros;
+
+/*
+ * Iterador sobre os livros de uma faixa de IDs, em ordem.
+ * Faz o mesmo percurso em ordem de percorrerLivros, mas um livro por
+ * chamada de proximoLivro, e começa já no primeiro ID da faixa: a pilha
+ * guarda só o caminho de nós ainda não visitados. Com um catálogo
+ * mapeado, as entradas do catálogo são intercaladas em ordem de ID.
+ * A biblioteca não pode ser alterada enquanto o iterador estiver aberto.
+ */
+typedef struct
+{
+  Biblioteca *bib;    // Biblioteca percorrida
+  PilhaLivros pilha;  // Nós ainda não visitados (o menor ID no topo)
+  size_t posCatalogo; // Próxima entrada do catálogo mapeado
+  long long ultimo;   // Maior ID da faixa
+  size_t restantes;   // Livros que ainda podem ser devolvidos
+  int erro;           // Faltou memória para a pilha
+  Livro copia;        // Cópia do último livro lido das páginas mapeadas
+} IteradorLivros;
+
+/*
+ * Cria uma nova biblioteca vazia usando a ABB simples.
  * Retorna um ponteiro para a biblioteca criada ou NULL se houver erro.
  */
 Biblioteca *criarBiblioteca();
 
+/*
+ * Cria uma nova biblioteca vazia usando o tipo de árvore informado.
+ * Retorna um ponteiro para a biblioteca criada ou NULL se houver erro.
+ */
+Biblioteca *criarBibliotecaTipo(TipoArvore tipo);
+
 /*
  * Libera toda a memória alocada para a biblioteca.
- * Primeiro destrói a árvore de livros e depois libera a estrutura da biblioteca.
+ * Libera o pool de nós e a arena de textos de uma só vez, sem percorrer
+ * a árvore, e depois libera a estrutura da biblioteca.
  */
 void destruirBiblioteca(Biblioteca *bib);
 
 /*
  * Insere um novo livro na biblioteca.
  * O livro é inserido mantendo a ordem da árvore (IDs menores à esquerda,
- * maiores à direita).
+ * maiores à direita). Na AVL e na rubro-negra a árvore é rebalanceada
+ * após a inserção.
  */
 void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor);
 
@@ -65,20 +217,155 @@ void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor
  * 1. Livro sem filhos
  * 2. Livro com um filho
  * 3. Livro com dois filhos
+ * Na AVL e na rubro-negra a árvore é rebalanceada após a remoção.
  */
 void removerLivro(Biblioteca *bib, int id);
 
 /*
- * Busca um livro pelo ID.
+ * Busca um livro pelo ID, pelo índice hash (O(1) esperado).
+ * Com um catálogo mapeado, um ID fora do índice é procurado no catálogo
+ * por busca binária e, se estiver lá, ganha um nó na hora.
  * Retorna um ponteiro para o livro encontrado ou NULL se não encontrar.
  */
 Livro *buscarLivro(Biblioteca *bib, int id);
 
+/*
+ * Visita todos os livros da biblioteca em ordem de ID, intercalando os da
+ * árvore com os do catálogo mapeado, se houver. Os livros do catálogo
+ * ainda sem nó são passados numa cópia temporária.
+ * Retorna 0 se a visita for interrompida ou faltar memória.
+ */
+int percorrerLivros(Biblioteca *bib, VisitarLivro visitar, void *contexto);
+
 /*
  * Lista todos os livros da biblioteca em ordem.
- * A listagem é feita percorrendo a árvore em ordem (esquerda, raiz, direita).
+ * A listagem é feita percorrendo a árvore em ordem (esquerda, raiz, direita),
+ * com pilha explícita para suportar árvores de qualquer altura. Os livros
+ * são montados num buffer grande e gravados na saída padrão com poucas
+ * chamadas a write.
+ */
+void listarLivros(Biblioteca *bib);
+
+/*
+ * Lista todos os livros em ordem no descritor de arquivo fd (um arquivo
+ * aberto, um pipe ou a saída padrão), no mesmo formato de listarLivros.
+ * O descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarLivrosDescritor(Biblioteca *bib, int fd);
+
+/*
+ * Visita, em ordem de ID, os livros cujo autor é exatamente `autor`. A
+ * primeira busca monta o índice de autores percorrendo a biblioteca uma
+ * vez; as seguintes custam só o tamanho da resposta. Os livros do
+ * catálogo ainda sem nó são passados numa cópia temporária, sem ganhar um
+ * nó. A biblioteca não pode ser alterada durante a visita.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorAutor(Biblioteca *bib, const char *autor, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita, em ordem de ID, os livros cujo título começa com `prefixo`. A
+ * primeira busca por título monta o índice de títulos percorrendo a
+ * biblioteca uma vez; as seguintes custam o tamanho do prefixo mais o
+ * tamanho da resposta. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorPrefixo(Biblioteca *bib, const char *prefixo, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita, em ordem de ID, os livros cujo título contém `trecho` em
+ * qualquer posição. Usa o índice de n-gramas do índice de títulos, então
+ * só os livros da menor lista entre as dos n-gramas do trecho são
+ * conferidos; um trecho com menos de TAMANHO_NGRAMA bytes percorre a
+ * biblioteca inteira. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorTrecho(Biblioteca *bib, const char *trecho, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita os livros que têm todas as palavras da consulta no título ou no
+ * autor, sem diferenciar maiúsculas e acentos ("tolkien aneis" acha
+ * "O Senhor dos Anéis", de J.R.R. Tolkien). Os livros vêm do mais
+ * relevante para o menos: palavras raras e achadas no título pesam mais, e
+ * livros com menos palavras ficam na frente (veja pontuarLivro). A
+ * primeira busca monta o índice de palavras percorrendo a biblioteca uma
+ * vez; as seguintes custam a intersecção das listas das palavras.
+ * Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorPalavras(Biblioteca *bib, const char *consulta, VisitarLivro visitar, void *contexto);
+
+/*
+ * Função de busca que recebe um texto: buscarPorAutor, buscarPorPrefixo,
+ * buscarPorTrecho ou buscarPorPalavras.
+ */
+typedef int (*BuscarLivros)(Biblioteca *bib, const char *texto, VisitarLivro visitar, void *contexto);
+
+/*
+ * Lista no descritor fd os livros encontrados por `buscar` com o texto
+ * dado, na ordem da busca e no mesmo formato de listarLivros. O
+ * descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarBuscaDescritor(Biblioteca *bib, BuscarLivros buscar, const char *texto, int fd);
+
+/*
+ * Conta os livros disponíveis com ID entre primeiro e ultimo (inclusive),
+ * pelo mapa de disponíveis: contêineres inteiros dentro da faixa são
+ * contados sem olhar os bits, e os outros com popcount, 64 IDs por vez.
+ * Para contar todos, use a faixa de INT_MIN a INT_MAX.
+ * Retorna -1 se faltar memória para montar o mapa.
+ */
+int contarDisponiveis(Biblioteca *bib, int primeiro, int ultimo);
+
+/*
+ * Visita, em ordem de ID, os livros disponíveis com ID entre primeiro e
+ * ultimo (inclusive). É a faixa de iniciarIterador restrita aos
+ * disponíveis, mas percorre só os bits ligados do mapa, sem passar pelos
+ * livros emprestados. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarDisponiveis(Biblioteca *bib, int primeiro, int ultimo, VisitarLivro visitar, void *contexto);
+
+/*
+ * Lista os livros disponíveis de uma faixa no descritor fd, em ordem de
+ * ID e no mesmo formato de listarLivros. O descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarDisponiveisDescritor(Biblioteca *bib, int primeiro, int ultimo, int fd);
+
+/*
+ * Inicia um iterador sobre os livros com ID entre primeiro e ultimo
+ * (inclusive), em ordem de ID. Achar o primeiro livro custa O(log n) numa
+ * árvore balanceada, e cada livro seguinte custa O(1) amortizado, então
+ * uma faixa com k livros custa O(log n + k).
+ * Retorna 0 se não houver memória. O iterador deve ser fechado com
+ * fecharIterador mesmo assim.
+ */
+int iniciarIterador(IteradorLivros *iterador, Biblioteca *bib, int primeiro, int ultimo);
+
+/*
+ * Inicia um iterador na página `pagina` (começando em 0) da listagem em
+ * ordem de ID, com páginas de `tamanho` livros. Sem catálogo mapeado, o
+ * começo da página é achado pelos tamanhos das subárvores em O(log n)
+ * numa árvore balanceada; com catálogo, os livros das páginas anteriores
+ * são pulados um a um.
+ * Retorna 0 se não houver memória.
+ */
+int iniciarPagina(IteradorLivros *iterador, Biblioteca *bib, size_t pagina, size_t tamanho);
+
+/*
+ * Devolve o próximo livro do iterador ou NULL quando ele terminar. Um
+ * livro do catálogo ainda sem nó é devolvido numa cópia, que só vale até
+ * a próxima chamada.
+ */
+const Livro *proximoLivro(IteradorLivros *iterador);
+
+/*
+ * Libera a memória do iterador.
  */
-void listarLivros(Livro *raiz);
+void fecharIterador(IteradorLivros *iterador);
 
 /*
  * Marca um livro como emprestado.
@@ -93,23 +380,141 @@ void emprestarLivro(Biblioteca *bib, int id);
 void devolverLivro(Biblioteca *bib, int id);
 
 /*
- * Salva todos os livros em um arquivo.
- * Os livros são salvos em ordem (esquerda, raiz, direita).
+ * Busca um livro pelo ID podendo ser chamada por várias threads ao mesmo
+ * tempo. Trava para leitura só a fatia do ID e não altera nada (um livro
+ * do catálogo não ganha nó), então buscas de IDs diferentes quase nunca
+ * disputam a mesma linha de cache. O ID, o status, o título e o autor são
+ * copiados para *copia antes de soltar a trava; título e autor continuam
+ * válidos até a biblioteca ser destruída.
+ * Retorna 1 se o livro foi encontrado.
+ */
+int consultarLivro(Biblioteca *bib, int id, Livro *copia);
+
+/*
+ * Trava a biblioteca inteira para escrita, esperando as consultas em
+ * andamento terminarem. Até destravarBiblioteca, nenhuma outra thread lê
+ * nem altera a biblioteca.
+ */
+void travarBiblioteca(Biblioteca *bib);
+
+/*
+ * Solta a trava de travarBiblioteca.
+ */
+void destravarBiblioteca(Biblioteca *bib);
+
+/*
+ * Insere um livro como inserirLivro, com a biblioteca travada.
+ */
+void inserirLivroConcorrente(Biblioteca *bib, int id, const char *titulo, const char *autor);
+
+/*
+ * Remove um livro como removerLivro, com a biblioteca travada.
+ */
+void removerLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Empresta um livro como emprestarLivro, com a biblioteca travada e sem
+ * mensagens.
+ * Retorna 1 se o livro foi emprestado, 0 se não existe ou já estava
+ * emprestado.
  */
-void salvarLivros(Livro *raiz, FILE *arquivo);
+int emprestarLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Devolve um livro como devolverLivro, com a biblioteca travada e sem
+ * mensagens.
+ * Retorna 1 se o livro foi devolvido, 0 se não existe ou já estava
+ * disponível.
+ */
+int devolverLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Salva todos os livros em um arquivo texto (exportação).
+ * Os livros são salvos em ordem balanceada, uma linha
+ * id|titulo|autor|disponivel por livro.
+ */
+void salvarLivros(Biblioteca *bib, FILE *arquivo);
+
+/*
+ * Salva todos os livros em um arquivo no formato binário (snapshot).
+ * Os livros são salvos em ordem de ID, com poucas escritas grandes.
+ * O arquivo deve ter sido aberto em modo binário.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int salvarLivrosBinario(Biblioteca *bib, FILE *arquivo);
+
+/*
+ * Grava o snapshot como salvarLivrosBinario, mas sem mensagens; recebe a
+ * biblioteca como contexto. É a função passada para
+ * compactarEmSegundoPlano, que a chama no processo filho.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int gravarSnapshot(void *contexto, FILE *arquivo);
 
 /*
  * Carrega livros de um arquivo para a biblioteca.
- * Lê o arquivo linha por linha, criando um novo livro para cada linha.
+ * Aceita o formato binário (snapshot) e o formato texto (importação, lido
+ * linha por linha), reconhecendo o formato pelo início do arquivo. Se a
+ * biblioteca estiver vazia, monta a árvore em lote, já balanceada, em
+ * tempo linear (montarArvoreOrdenada); senão insere um livro por vez.
+ * Depois da carga, em qualquer dos dois formatos, reaplica as operações do
+ * diário, se houver; os livros carregados não são registrados no diário.
+ * Deve ser usada com o arquivo principal (livros.dat), ao qual o diário
+ * se refere.
  */
 void carregarLivros(Biblioteca *bib, const char *nomeArquivo);
 
 /*
- * Conta o número total de livros na biblioteca.
- * Percorre a árvore contando todos os nós.
+ * Importa livros de um arquivo, como carregarLivros, mas sem reaplicar o
+ * diário: as operações dele se referem a livros.dat, e não ao arquivo
+ * importado. Os livros importados não são registrados no diário.
+ */
+void importarLivros(Biblioteca *bib, const char *nomeArquivo);
+
+/*
+ * Abre um snapshot como catálogo mapeado, sem carregar os livros.
+ * A abertura custa O(1): os livros são lidos das páginas mapeadas quando
+ * são buscados ou listados. A biblioteca precisa estar vazia. As
+ * operações do diário, se houver, são reaplicadas por cima. O arquivo
+ * não pode ser sobrescrito no lugar enquanto estiver aberto (um novo
+ * arquivo deve ser gravado à parte e renomeado por cima).
+ */
+void mapearCatalogo(Biblioteca *bib, const char *nomeArquivo);
+
+/*
+ * Monta a árvore de uma biblioteca vazia a partir de um vetor de registros.
+ * Os registros são ordenados por ID (em tempo linear), os IDs repetidos são
+ * descartados e a árvore é construída perfeitamente balanceada, sem
+ * nenhuma busca, já com altura (AVL) e cores e pais (rubro-negra) válidos.
+ * Retorna 0 se a biblioteca não estiver vazia ou faltar memória; se a
+ * memória acabar no meio da montagem, os nós já montados são desfeitos e
+ * a biblioteca continua vazia.
+ */
+int montarArvoreOrdenada(Biblioteca *bib, VetorRegistros *registros);
+
+/*
+ * Conta os livros de uma subárvore em O(1), pelo tamanho guardado na raiz.
  */
 int contarLivros(Livro *raiz);
 
+/*
+ * Conta os livros da biblioteca em O(1): os da árvore mais os do catálogo
+ * mapeado que não foram removidos.
+ */
+int quantidadeLivros(Biblioteca *bib);
+
+/*
+ * Retorna a posição que um ID ocupa (ou ocuparia) na ordem da subárvore:
+ * quantos livros dela têm ID menor. Custa O(altura).
+ */
+int posicaoLivro(Livro *raiz, int id);
+
+/*
+ * Retorna o livro de uma posição (começando em 0) na ordem de ID da
+ * subárvore, ou NULL se a posição não existir. Custa O(altura).
+ */
+Livro *livroNaPosicao(Livro *raiz, int posicao);
+
 /*
  * Armazena os livros em um vetor em ordem.
  * Usado para salvar os livros de forma balanceada.
@@ -0,0 +1,276 @@
+/*
+ * medir_leituras.c
+ *
+ * Mede quantas buscas por ID a biblioteca atende por segundo quando várias
+ * threads buscam ao mesmo tempo. Carrega livros.dat (ou o abre como
+ * catálogo mapeado) e, para 1, 2, 4, ... threads leitoras, cada leitora
+ * faz BUSCAS_POR_THREAD chamadas a consultarLivro com IDs sorteados entre
+ * os da biblioteca, enquanto uma thread escritora insere e remove um livro
+ * e empresta e devolve outro a cada INTERVALO_ESCRITA_MS.
+ *
+ * Uso: ./medir_leituras [avl|rn] [catalogo] [máximo de threads]
+ */
+
+#include "biblioteca.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BUSCAS_POR_THREAD 2000000 // Buscas feitas por cada thread leitora
+#define INTERVALO_ESCRITA_MS 1    // Pausa entre duas rodadas da thread escritora
+#define MAX_THREADS 256           // Maior quantidade de threads leitoras aceita
+
+/*
+ * Dados de uma thread leitora.
+ */
+typedef struct
+{
+  Biblioteca *bib;       // Biblioteca consultada
+  const VetorIds *ids;   // IDs que existiam antes da medição
+  uint32_t semente;      // Estado do sorteio da thread
+  long long achados;     // Buscas que encontraram o livro
+  long long disponiveis; // Livros encontrados disponíveis
+} Leitora;
+
+/*
+ * Estado da thread escritora. O campo parar é protegido pela trava e
+ * sinalizado pela condição, que também marca a pausa entre as rodadas.
+ */
+typedef struct
+{
+  Biblioteca *bib;         // Biblioteca alterada
+  const VetorIds *ids;     // IDs que existiam antes da medição
+  int proximoId;           // ID do próximo livro inserido (maior que todos)
+  pthread_mutex_t trava;   // Protege parar
+  pthread_cond_t condicao; // Acorda a escritora para parar
+  int parar;               // 1 quando as leitoras terminaram
+  long long rodadas;       // Rodadas de alterações feitas
+} Escritora;
+
+/*
+ * Guarda o ID de um livro no vetor de IDs.
+ */
+int guardarId(const Livro *livro, void *contexto)
+{
+  return adicionarId((VetorIds *)contexto, livro->id);
+}
+
+/*
+ * Sorteia o próximo número da thread (xorshift de 32 bits), sem a trava
+ * que rand() teria.
+ */
+uint32_t sortear(uint32_t *semente)
+{
+  uint32_t x = *semente;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *semente = x;
+  return x;
+}
+
+/*
+ * Corpo da thread leitora: faz BUSCAS_POR_THREAD buscas de IDs sorteados.
+ */
+void *executarLeitora(void *argumento)
+{
+  Leitora *leitora = (Leitora *)argumento;
+  for (int i = 0; i < BUSCAS_POR_THREAD; i++)
+  {
+    int id = leitora->ids->itens[sortear(&leitora->semente) % leitora->ids->quantidade];
+    Livro livro;
+    if (consultarLivro(leitora->bib, id, &livro))
+    {
+      leitora->achados++;
+      leitora->disponiveis += livro.disponivel;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Corpo da thread escritora: a cada INTERVALO_ESCRITA_MS insere um livro
+ * novo, empresta e devolve um livro existente e remove o livro novo, até
+ * ser avisada para parar.
+ */
+void *executarEscritora(void *argumento)
+{
+  Escritora *escritora = (Escritora *)argumento;
+  uint32_t semente = 2463534242u;
+
+  pthread_mutex_lock(&escritora->trava);
+  while (!escritora->parar)
+  {
+    struct timespec prazo;
+    clock_gettime(CLOCK_REALTIME, &prazo);
+    prazo.tv_nsec += INTERVALO_ESCRITA_MS * 1000000L;
+    if (prazo.tv_nsec >= 1000000000L)
+    {
+      prazo.tv_sec++;
+      prazo.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&escritora->condicao, &escritora->trava, &prazo);
+    if (escritora->parar)
+      break;
+    pthread_mutex_unlock(&escritora->trava);
+
+    int id = escritora->ids->itens[sortear(&semente) % escritora->ids->quantidade];
+    inserirLivroConcorrente(escritora->bib, escritora->proximoId, "Livro novo", "Autor novo");
+    if (emprestarLivroConcorrente(escritora->bib, id))
+      devolverLivroConcorrente(escritora->bib, id);
+    removerLivroConcorrente(escritora->bib, escritora->proximoId);
+    escritora->proximoId++;
+    escritora->rodadas++;
+
+    pthread_mutex_lock(&escritora->trava);
+  }
+  pthread_mutex_unlock(&escritora->trava);
+  return NULL;
+}
+
+/*
+ * Retorna o tempo de relógio atual em segundos. clock() não serve aqui,
+ * porque soma o tempo de processador de todas as threads.
+ */
+double agora()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/*
+ * Mede uma rodada com `threads` leitoras e a escritora.
+ * Retorna as buscas por segundo, ou um valor negativo se uma thread não
+ * puder ser criada.
+ */
+double medirRodada(Biblioteca *bib, const VetorIds *ids, int maiorId, int threads, long long *rodadas)
+{
+  Leitora leitoras[MAX_THREADS];
+  pthread_t threadsLeitoras[MAX_THREADS];
+  pthread_t escritor;
+  Escritora escritora;
+  escritora.bib = bib;
+  escritora.ids = ids;
+  escritora.proximoId = maiorId + 1;
+  pthread_mutex_init(&escritora.trava, NULL);
+  pthread_cond_init(&escritora.condicao, NULL);
+  escritora.parar = 0;
+  escritora.rodadas = 0;
+
+  if (pthread_create(&escritor, NULL, executarEscritora, &escritora) != 0)
+  {
+    pthread_cond_destroy(&escritora.condicao);
+    pthread_mutex_destroy(&escritora.trava);
+    return -1;
+  }
+
+  double inicio = agora();
+  int criadas = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    leitoras[i].bib = bib;
+    leitoras[i].ids = ids;
+    leitoras[i].semente = 0x9E3779B1u * (uint32_t)(i + 1);
+    leitoras[i].achados = 0;
+    leitoras[i].disponiveis = 0;
+    if (pthread_create(&threadsLeitoras[i], NULL, executarLeitora, &leitoras[i]) != 0)
+      break;
+    criadas++;
+  }
+  for (int i = 0; i < criadas; i++)
+    pthread_join(threadsLeitoras[i], NULL);
+  double tempo = agora() - inicio;
+
+  pthread_mutex_lock(&escritora.trava);
+  escritora.parar = 1;
+  pthread_cond_signal(&escritora.condicao);
+  pthread_mutex_unlock(&escritora.trava);
+  pthread_join(escritor, NULL);
+  pthread_cond_destroy(&escritora.condicao);
+  pthread_mutex_destroy(&escritora.trava);
+
+  long long achados = 0;
+  for (int i = 0; i < criadas; i++)
+    achados += leitoras[i].achados;
+  if (criadas < threads || achados != (long long)threads * BUSCAS_POR_THREAD)
+    return -1;
+  *rodadas = escritora.rodadas;
+  return achados / tempo;
+}
+
+/*
+ * Função principal: carrega a biblioteca, guarda os IDs existentes e mede
+ * as rodadas com quantidades dobradas de threads, depois de uma rodada de
+ * aquecimento que não é mostrada.
+ */
+int main(int argc, char *argv[])
+{
+  TipoArvore tipo = ARVORE_ABB;
+  int mapear = 0;
+  int maxThreads = 2 * (int)sysconf(_SC_NPROCESSORS_ONLN);
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "avl") == 0)
+      tipo = ARVORE_AVL;
+    else if (strcmp(argv[i], "rn") == 0)
+      tipo = ARVORE_RUBRO_NEGRA;
+    else if (strcmp(argv[i], "catalogo") == 0)
+      mapear = 1;
+    else if (atoi(argv[i]) > 0)
+      maxThreads = atoi(argv[i]);
+  }
+  if (maxThreads < 1)
+    maxThreads = 1;
+  if (maxThreads > MAX_THREADS)
+    maxThreads = MAX_THREADS;
+
+  Biblioteca *bib = criarBibliotecaTipo(tipo);
+  if (bib == NULL)
+  {
+    printf("Erro ao criar a biblioteca.\n");
+    return 1;
+  }
+  if (mapear)
+    mapearCatalogo(bib, "livros.dat");
+  else
+    carregarLivros(bib, "livros.dat");
+
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!percorrerLivros(bib, guardarId, &ids) || ids.quantidade == 0)
+  {
+    printf("Nenhum livro para buscar.\n");
+    liberarIds(&ids);
+    destruirBiblioteca(bib);
+    return 1;
+  }
+  int maiorId = 0;
+  for (size_t i = 0; i < ids.quantidade; i++)
+    if (ids.itens[i] > maiorId)
+      maiorId = ids.itens[i];
+
+  printf("\n%zu livros, %d buscas por thread, %ld processadores\n", ids.quantidade, BUSCAS_POR_THREAD,
+         sysconf(_SC_NPROCESSORS_ONLN));
+  printf("Threads | Buscas por segundo | Aceleração | Rodadas de alterações\n");
+  long long rodadas = 0;
+  medirRodada(bib, &ids, maiorId, 1, &rodadas); // Aquecimento: traz o índice para a cache
+  double base = 0;
+  for (int threads = 1; threads <= maxThreads; threads *= 2)
+  {
+    double vazao = medirRodada(bib, &ids, maiorId, threads, &rodadas);
+    if (vazao < 0)
+    {
+      printf("Erro ao medir com %d threads.\n", threads);
+      break;
+    }
+    if (threads == 1)
+      base = vazao;
+    printf("%7d | %18.0f | %9.2fx | %lld\n", threads, vazao, vazao / base, rodadas);
+  }
+
+  liberarIds(&ids);
+  destruirBiblioteca(bib);
+  return 0;
+}
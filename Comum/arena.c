@@ -0,0 +1,164 @@
+/*
+ * arena.c
+ *
+ * Implementação do alocador em arena para os textos dos livros.
+ * Este arquivo contém todas as funções declaradas em arena.h.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Arredonda um tamanho para o próximo múltiplo de 4,
+ * mantendo o prefixo de tamanho de cada texto alinhado.
+ */
+size_t alinharArena(size_t tamanho)
+{
+  return (tamanho + 3) & ~(size_t)3;
+}
+
+/*
+ * Inicializa uma arena vazia.
+ */
+void iniciarArena(Arena *arena)
+{
+  arena->blocos = NULL;
+  arena->totalUsado = 0;
+}
+
+/*
+ * Libera todos os blocos da arena.
+ * Percorre a lista de blocos liberando cada um; os textos não são
+ * liberados individualmente.
+ */
+void liberarArena(Arena *arena)
+{
+  BlocoArena *atual = arena->blocos;
+  while (atual != NULL)
+  {
+    BlocoArena *prox = atual->prox;
+    free(atual);
+    atual = prox;
+  }
+  iniciarArena(arena);
+}
+
+/*
+ * Copia um texto para a arena com prefixo de tamanho.
+ *
+ * Como funciona:
+ * 1. Calcula o espaço necessário: prefixo + caracteres + '\0', alinhado
+ * 2. Se não couber no bloco atual, aloca um novo bloco (do tamanho padrão
+ *    ou, para textos muito grandes, do tamanho exato do texto)
+ * 3. Grava o prefixo e copia exatamente `tamanho` bytes
+ */
+char *guardarTexto(Arena *arena, const char *texto, size_t tamanho)
+{
+  if (tamanho > UINT32_MAX - sizeof(uint32_t) - 1)
+    return NULL;
+
+  size_t necessario = alinharArena(sizeof(uint32_t) + tamanho + 1);
+  BlocoArena *bloco = arena->blocos;
+
+  if (bloco == NULL || bloco->capacidade - bloco->usado < necessario)
+  {
+    size_t capacidade = necessario > TAMANHO_BLOCO_ARENA ? necessario : TAMANHO_BLOCO_ARENA;
+    BlocoArena *novo = (BlocoArena *)malloc(sizeof(BlocoArena) + capacidade);
+    if (novo == NULL)
+      return NULL;
+    novo->usado = 0;
+    novo->capacidade = capacidade;
+
+    if (bloco != NULL && capacidade > TAMANHO_BLOCO_ARENA)
+    {
+      // Bloco exclusivo de um texto grande: fica atrás do bloco atual,
+      // para não desperdiçar o espaço que ainda resta nele
+      novo->prox = bloco->prox;
+      bloco->prox = novo;
+    }
+    else
+    {
+      novo->prox = bloco;
+      arena->blocos = novo;
+    }
+    bloco = novo;
+  }
+
+  char *destino = bloco->dados + bloco->usado;
+  uint32_t prefixo = (uint32_t)tamanho;
+  memcpy(destino, &prefixo, sizeof(prefixo));
+  memcpy(destino + sizeof(prefixo), texto, tamanho);
+  destino[sizeof(prefixo) + tamanho] = '\0';
+
+  bloco->usado += necessario;
+  arena->totalUsado += necessario;
+  return destino + sizeof(prefixo);
+}
+
+/*
+ * Reserva um bloco exclusivo na arena.
+ * Como um texto grande, o bloco fica atrás do bloco atual e já nasce
+ * cheio, então guardarTexto nunca grava nele.
+ */
+char *reservarArena(Arena *arena, size_t tamanho)
+{
+  size_t capacidade = alinharArena(tamanho);
+  BlocoArena *novo = (BlocoArena *)malloc(sizeof(BlocoArena) + capacidade);
+  if (novo == NULL)
+    return NULL;
+  novo->usado = capacidade;
+  novo->capacidade = capacidade;
+
+  if (arena->blocos != NULL)
+  {
+    novo->prox = arena->blocos->prox;
+    arena->blocos->prox = novo;
+  }
+  else
+  {
+    novo->prox = NULL;
+    arena->blocos = novo;
+  }
+  arena->totalUsado += capacidade;
+  return novo->dados;
+}
+
+/*
+ * Junta duas arenas.
+ * Os blocos da origem entram logo atrás do bloco atual do destino, que
+ * continua recebendo os próximos textos.
+ */
+void juntarArena(Arena *destino, Arena *origem)
+{
+  if (origem->blocos == NULL)
+    return;
+
+  if (destino->blocos == NULL)
+  {
+    destino->blocos = origem->blocos;
+  }
+  else
+  {
+    BlocoArena *ultimo = origem->blocos;
+    while (ultimo->prox != NULL)
+    {
+      ultimo = ultimo->prox;
+    }
+    ultimo->prox = destino->blocos->prox;
+    destino->blocos->prox = origem->blocos;
+  }
+  destino->totalUsado += origem->totalUsado;
+  iniciarArena(origem);
+}
+
+/*
+ * Lê o prefixo de tamanho gravado antes do texto.
+ */
+uint32_t tamanhoTexto(const char *texto)
+{
+  uint32_t tamanho;
+  memcpy(&tamanho, texto - sizeof(tamanho), sizeof(tamanho));
+  return tamanho;
+}
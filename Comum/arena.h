@@ -0,0 +1,81 @@
+/*
+ * arena.h
+ *
+ * Este arquivo contém as definições do alocador em arena usado pelas duas
+ * implementações da biblioteca para guardar títulos e autores. Os textos
+ * são copiados um após o outro em blocos grandes (alocação por incremento
+ * de ponteiro) e só são liberados todos de uma vez, quando a biblioteca
+ * é destruída.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAMANHO_BLOCO_ARENA (256 * 1024) // Tamanho padrão de cada bloco da arena
+
+/*
+ * Bloco de memória da arena.
+ * Os blocos formam uma lista ligada; só o primeiro recebe novos textos.
+ */
+typedef struct BlocoArena
+{
+  struct BlocoArena *prox; // Bloco alocado anteriormente
+  size_t usado;            // Bytes já ocupados em dados
+  size_t capacidade;       // Bytes disponíveis em dados
+  char dados[];            // Área onde os textos são gravados
+} BlocoArena;
+
+/*
+ * Arena de textos.
+ * Cada texto é gravado com um prefixo de 4 bytes com seu tamanho, seguido
+ * dos caracteres e de um '\0' final, para continuar compatível com as
+ * funções de string do C.
+ */
+typedef struct
+{
+  BlocoArena *blocos; // Bloco atual (início da lista de blocos)
+  size_t totalUsado;  // Total de bytes ocupados por textos
+} Arena;
+
+/*
+ * Inicializa uma arena vazia. Nenhuma memória é alocada até o primeiro texto.
+ */
+void iniciarArena(Arena *arena);
+
+/*
+ * Libera todos os blocos da arena de uma só vez.
+ * Todos os textos guardados nela deixam de ser válidos.
+ */
+void liberarArena(Arena *arena);
+
+/*
+ * Copia exatamente `tamanho` bytes de `texto` para a arena.
+ * Retorna o ponteiro para os caracteres copiados (terminados em '\0')
+ * ou NULL se não houver memória.
+ */
+char *guardarTexto(Arena *arena, const char *texto, size_t tamanho);
+
+/*
+ * Reserva na arena um bloco exclusivo de `tamanho` bytes, para ser
+ * preenchido de uma vez (por exemplo, lido de um arquivo) com textos já no
+ * formato da arena. Retorna o início do bloco ou NULL se não houver memória.
+ */
+char *reservarArena(Arena *arena, size_t tamanho);
+
+/*
+ * Passa todos os blocos de origem para o destino, sem copiar os textos,
+ * que continuam válidos e passam a ser liberados com o destino. A origem
+ * fica vazia.
+ */
+void juntarArena(Arena *destino, Arena *origem);
+
+/*
+ * Retorna o tamanho de um texto guardado na arena, lido do seu prefixo,
+ * sem precisar percorrer os caracteres.
+ */
+uint32_t tamanhoTexto(const char *texto);
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * autores.c
+ *
+ * Implementação do índice secundário por autor.
+ * Este arquivo contém todas as funções declaradas em autores.h.
+ */
+
+#include "autores.h"
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACIDADE_INICIAL_AUTORES 256 // Posições alocadas no primeiro autor
+#define IDS_INICIAIS_AUTOR 4           // IDs alocados no primeiro livro de um autor
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarAutores(IndiceAutores *indice)
+{
+  indice->entradas = NULL;
+  indice->capacidade = 0;
+  indice->quantidade = 0;
+}
+
+/*
+ * Libera os vetores de IDs de cada autor e depois a tabela.
+ */
+void liberarAutores(IndiceAutores *indice)
+{
+  for (size_t i = 0; i < indice->capacidade; i++)
+  {
+    free(indice->entradas[i].ids);
+  }
+  free(indice->entradas);
+  iniciarAutores(indice);
+}
+
+/*
+ * Hash de um nome: FNV-1a de 32 bits, byte a byte.
+ */
+uint32_t hashAutor(const char *autor, size_t tamanho)
+{
+  uint32_t hash = 0x811C9DC5u;
+  for (size_t i = 0; i < tamanho; i++)
+  {
+    hash = (hash ^ (uint8_t)autor[i]) * 0x01000193u;
+  }
+  return hash;
+}
+
+/*
+ * Retorna a posição de um autor na tabela ou, se ele não estiver nela, a
+ * posição vazia onde a sondagem parou. O hash guardado é comparado antes
+ * do nome, então nomes diferentes quase nunca chegam ao memcmp. A tabela
+ * não pode estar vazia.
+ */
+EntradaAutor *procurarAutor(const IndiceAutores *indice, const char *autor, size_t tamanho,
+                            uint32_t hash)
+{
+  size_t mascara = indice->capacidade - 1;
+  size_t pos = hash & mascara;
+  while (indice->entradas[pos].autor != NULL)
+  {
+    EntradaAutor *entrada = &indice->entradas[pos];
+    if (entrada->hash == hash && tamanhoTexto(entrada->autor) == tamanho &&
+        memcmp(entrada->autor, autor, tamanho) == 0)
+      return entrada;
+    pos = (pos + 1) & mascara;
+  }
+  return &indice->entradas[pos];
+}
+
+/*
+ * Troca a tabela por uma com o dobro da capacidade (ou a inicial),
+ * movendo as entradas pelo hash guardado, sem reler os nomes.
+ * Retorna 0 se não houver memória (a tabela antiga é mantida).
+ */
+int crescerAutores(IndiceAutores *indice)
+{
+  size_t capacidade = indice->capacidade > 0 ? indice->capacidade * 2 : CAPACIDADE_INICIAL_AUTORES;
+  EntradaAutor *entradas = (EntradaAutor *)calloc(capacidade, sizeof(EntradaAutor));
+  if (entradas == NULL)
+    return 0;
+
+  for (size_t i = 0; i < indice->capacidade; i++)
+  {
+    EntradaAutor *antiga = &indice->entradas[i];
+    if (antiga->autor != NULL)
+    {
+      size_t pos = antiga->hash & (capacidade - 1);
+      while (entradas[pos].autor != NULL)
+      {
+        pos = (pos + 1) & (capacidade - 1);
+      }
+      entradas[pos] = *antiga;
+    }
+  }
+  free(indice->entradas);
+  indice->entradas = entradas;
+  indice->capacidade = capacidade;
+  return 1;
+}
+
+/*
+ * Acrescenta um ID aos livros de um autor.
+ *
+ * Como funciona:
+ * 1. Calcula o hash do nome, com o tamanho lido do prefixo da arena
+ * 2. Cresce a tabela se o novo autor passaria de 3/4 de ocupação
+ * 3. Acha a entrada do autor ou ocupa a posição vazia com ele
+ * 4. Dobra o vetor de IDs do autor se estiver cheio e acrescenta o ID
+ */
+int adicionarAutor(IndiceAutores *indice, const char *autor, int id)
+{
+  size_t tamanho = tamanhoTexto(autor);
+  uint32_t hash = hashAutor(autor, tamanho);
+  if (indice->quantidade + 1 >= indice->capacidade / 4 * 3 && !crescerAutores(indice))
+    return 0;
+
+  EntradaAutor *entrada = procurarAutor(indice, autor, tamanho, hash);
+  if (entrada->quantidade == entrada->capacidade)
+  {
+    int capacidade = entrada->capacidade > 0 ? entrada->capacidade * 2 : IDS_INICIAIS_AUTOR;
+    int *ids = (int *)realloc(entrada->ids, (size_t)capacidade * sizeof(int));
+    if (ids == NULL)
+      return 0;
+    entrada->ids = ids;
+    entrada->capacidade = capacidade;
+  }
+  if (entrada->autor == NULL)
+  {
+    entrada->autor = autor;
+    entrada->hash = hash;
+    indice->quantidade++;
+  }
+  entrada->ids[entrada->quantidade++] = id;
+  return 1;
+}
+
+/*
+ * Retira um ID dos livros de um autor.
+ * Procura o ID no vetor do autor de trás para frente (os livros mais
+ * recentes são removidos com mais frequência) e põe o último no lugar.
+ */
+void removerAutor(IndiceAutores *indice, const char *autor, int id)
+{
+  if (indice->quantidade == 0)
+    return;
+
+  size_t tamanho = tamanhoTexto(autor);
+  EntradaAutor *entrada = procurarAutor(indice, autor, tamanho, hashAutor(autor, tamanho));
+  for (int i = entrada->quantidade - 1; i >= 0; i--)
+  {
+    if (entrada->ids[i] == id)
+    {
+      entrada->ids[i] = entrada->ids[--entrada->quantidade];
+      return;
+    }
+  }
+}
+
+/*
+ * Procura um autor pelo nome.
+ */
+const EntradaAutor *consultarAutor(const IndiceAutores *indice, const char *autor, size_t tamanho)
+{
+  if (indice->quantidade == 0)
+    return NULL;
+  EntradaAutor *entrada = procurarAutor(indice, autor, tamanho, hashAutor(autor, tamanho));
+  return entrada->autor != NULL ? entrada : NULL;
+}
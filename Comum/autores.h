@@ -0,0 +1,81 @@
+/*
+ * autores.h
+ *
+ * Este arquivo contém as definições do índice secundário por autor usado
+ * pelas duas implementações da biblioteca. É uma tabela hash de
+ * endereçamento aberto (sondagem linear), como o índice por ID, que leva
+ * do nome de um autor ao vetor com os IDs dos seus livros. Assim, achar
+ * todos os livros de um autor custa o tamanho da resposta, e não o tamanho
+ * da biblioteca.
+ *
+ * O nome não é copiado: a chave aponta para o autor de um dos livros, que
+ * fica na arena da biblioteca ou nas páginas do catálogo mapeado e vale
+ * até a biblioteca ser destruída. O nome precisa estar no formato da arena
+ * (com o tamanho no prefixo). A comparação é exata, byte a byte.
+ */
+
+#ifndef AUTORES_H
+#define AUTORES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Posição da tabela: um autor e os IDs dos seus livros.
+ * Uma posição com autor NULL está vazia. Um autor cujos livros foram todos
+ * removidos continua na tabela, com quantidade 0, até o índice ser
+ * liberado.
+ */
+typedef struct
+{
+  const char *autor; // Nome do autor (no formato da arena)
+  uint32_t hash;     // Hash do nome, guardado para crescer a tabela sem recalcular
+  int quantidade;    // Livros do autor
+  int capacidade;    // Tamanho alocado do vetor ids
+  int *ids;          // IDs dos livros, na ordem em que entraram no índice
+} EntradaAutor;
+
+/*
+ * Índice hash de autores.
+ * A capacidade é sempre uma potência de 2 e a tabela cresce antes de
+ * passar de 3/4 de ocupação.
+ */
+typedef struct
+{
+  EntradaAutor *entradas; // Tabela (NULL enquanto o índice está vazio)
+  size_t capacidade;      // Quantidade de posições da tabela
+  size_t quantidade;      // Posições ocupadas (autores distintos)
+} IndiceAutores;
+
+/*
+ * Inicializa um índice vazio.
+ * Nenhuma memória é alocada até o primeiro livro.
+ */
+void iniciarAutores(IndiceAutores *indice);
+
+/*
+ * Libera a tabela e os vetores de IDs (os nomes não são liberados).
+ */
+void liberarAutores(IndiceAutores *indice);
+
+/*
+ * Acrescenta um ID aos livros de um autor, criando a entrada do autor se
+ * for o primeiro livro dele.
+ * Retorna 0 se não houver memória (o índice continua válido, sem o ID).
+ */
+int adicionarAutor(IndiceAutores *indice, const char *autor, int id);
+
+/*
+ * Retira um ID dos livros de um autor, se estiver lá. O último ID do
+ * vetor ocupa o lugar do retirado.
+ */
+void removerAutor(IndiceAutores *indice, const char *autor, int id);
+
+/*
+ * Procura um autor pelo nome, com `tamanho` bytes (o nome não precisa
+ * estar no formato da arena).
+ * Retorna a entrada do autor ou NULL se ele não estiver no índice.
+ */
+const EntradaAutor *consultarAutor(const IndiceAutores *indice, const char *autor, size_t tamanho);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * catalogo.c
+ *
+ * Implementação do catálogo mapeado.
+ * Este arquivo contém todas as funções declaradas em catalogo.h.
+ */
+
+#include "catalogo.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Texto vazio no formato da arena, usado no lugar de uma posição inválida.
+ */
+const struct
+{
+  uint32_t tamanho;
+  char texto[4];
+} textoVazio = {0, ""};
+
+/*
+ * Inicializa um catálogo fechado.
+ */
+void iniciarCatalogo(Catalogo *catalogo)
+{
+  memset(catalogo, 0, sizeof(*catalogo));
+}
+
+/*
+ * Mapeia um snapshot como catálogo.
+ *
+ * Como funciona:
+ * 1. Abre o arquivo e mapeia ele inteiro, só para leitura; o descritor
+ *    pode ser fechado logo depois, o mapeamento continua valendo
+ * 2. Confere o cabeçalho e se o arquivo cobre todas as seções
+ * 3. Aponta os vetores para as seções mapeadas
+ * 4. Aloca os estados zerados (todas as entradas mapeadas); o calloc de
+ *    um bloco grande recebe páginas zeradas do sistema sob demanda, então
+ *    também não custa proporcional à quantidade de livros
+ */
+int abrirCatalogo(Catalogo *catalogo, const char *nomeArquivo)
+{
+  int fd = open(nomeArquivo, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  struct stat info;
+  void *mapa = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(CabecalhoSnapshot))
+    mapa = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapa == MAP_FAILED)
+    return 0;
+
+  size_t tamanho = (size_t)info.st_size;
+  const CabecalhoSnapshot *cabecalho = (const CabecalhoSnapshot *)mapa;
+  SecoesSnapshot secoes;
+  calcularSecoes(cabecalho->quantidade, &secoes);
+  size_t inicioTextos = sizeof(CabecalhoSnapshot) + secoes.tamanhoVetores;
+  uint8_t *estados = NULL;
+  if (cabecalhoValido(cabecalho) && inicioTextos <= tamanho &&
+      cabecalho->tamanhoTextos <= tamanho - inicioTextos)
+    estados = (uint8_t *)calloc(cabecalho->quantidade + 1, 1);
+  if (estados == NULL)
+  {
+    munmap(mapa, tamanho);
+    return 0;
+  }
+
+  const char *vetores = (const char *)mapa + sizeof(CabecalhoSnapshot);
+  catalogo->mapa = mapa;
+  catalogo->tamanho = tamanho;
+  catalogo->quantidade = cabecalho->quantidade;
+  catalogo->ids = (const int32_t *)(vetores + secoes.ids);
+  catalogo->disponiveis = (const uint8_t *)(vetores + secoes.disponiveis);
+  catalogo->titulos = (const uint32_t *)(vetores + secoes.titulos);
+  catalogo->autores = (const uint32_t *)(vetores + secoes.autores);
+  catalogo->textos = (const char *)mapa + inicioTextos;
+  catalogo->tamanhoTextos = cabecalho->tamanhoTextos;
+  catalogo->estados = estados;
+  catalogo->removidas = 0;
+  return 1;
+}
+
+/*
+ * Desfaz o mapeamento e libera os estados.
+ */
+void fecharCatalogo(Catalogo *catalogo)
+{
+  if (catalogo->mapa != NULL)
+    munmap(catalogo->mapa, catalogo->tamanho);
+  free(catalogo->estados);
+  iniciarCatalogo(catalogo);
+}
+
+/*
+ * Acha a primeira posição com ID maior ou igual ao informado, por busca
+ * binária. Só as páginas do caminho da busca (cerca de log2(n) posições do vetor
+ * de IDs) são trazidas do arquivo.
+ */
+size_t posicaoCatalogo(const Catalogo *catalogo, int id)
+{
+  size_t inicio = 0, fim = catalogo->quantidade;
+  while (inicio < fim)
+  {
+    size_t meio = inicio + (fim - inicio) / 2;
+    if (catalogo->ids[meio] < id)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio;
+}
+
+/*
+ * Procura um ID no catálogo: a posição dada por posicaoCatalogo só é o
+ * livro procurado se tiver o mesmo ID.
+ */
+long procurarCatalogo(const Catalogo *catalogo, int id)
+{
+  size_t pos = posicaoCatalogo(catalogo, id);
+  if (pos < catalogo->quantidade && catalogo->ids[pos] == id)
+    return (long)pos;
+  return -1;
+}
+
+/*
+ * Devolve o texto de uma posição da seção de textos, ou o texto vazio se
+ * a posição não apontar para um texto válido.
+ */
+char *textoCatalogo(const Catalogo *catalogo, uint32_t posicao)
+{
+  if (!textoValido(catalogo->textos, catalogo->tamanhoTextos, posicao))
+    return (char *)textoVazio.texto;
+  return (char *)catalogo->textos + posicao;
+}
+
+/*
+ * Lê o livro de uma posição do catálogo.
+ */
+void lerEntradaCatalogo(const Catalogo *catalogo, size_t pos, RegistroLivro *registro)
+{
+  registro->id = catalogo->ids[pos];
+  registro->disponivel = catalogo->disponiveis[pos];
+  registro->titulo = textoCatalogo(catalogo, catalogo->titulos[pos]);
+  registro->autor = textoCatalogo(catalogo, catalogo->autores[pos]);
+}
@@ -0,0 +1,99 @@
+/*
+ * catalogo.h
+ *
+ * Este arquivo contém as definições do catálogo mapeado usado pelas duas
+ * implementações da biblioteca. Em vez de ler o snapshot para a memória,
+ * o arquivo é mapeado (mmap) e os vetores de IDs, disponibilidade e
+ * posições, junto com a seção de textos, são usados direto das páginas
+ * mapeadas. Abrir o catálogo custa O(1), independente da quantidade de
+ * livros: só o cabeçalho é lido, e o resto das páginas é trazido pelo
+ * sistema conforme é acessado. Como o mapeamento é só de leitura, vários
+ * processos que abrem o mesmo arquivo dividem as mesmas páginas em cache.
+ *
+ * O arquivo nunca é alterado. O que muda depois de aberto (empréstimos,
+ * devoluções e remoções) fica no vetor estados, que é privado do processo,
+ * e nos livros materializados pela implementação.
+ */
+
+#ifndef CATALOGO_H
+#define CATALOGO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "registro.h"
+#include "snapshot.h"
+
+/*
+ * Estado de uma entrada do catálogo.
+ */
+typedef enum
+{
+  ENTRADA_MAPEADA,       // Dados só nas páginas mapeadas
+  ENTRADA_MATERIALIZADA, // Já tem um livro na memória, registrado no índice
+  ENTRADA_REMOVIDA       // Removida da biblioteca
+} EstadoEntrada;
+
+/*
+ * Catálogo mapeado.
+ * Um catálogo fechado tem mapa NULL e quantidade 0.
+ */
+typedef struct
+{
+  void *mapa;                 // Início do arquivo mapeado
+  size_t tamanho;             // Tamanho do mapeamento
+  size_t quantidade;          // Quantidade de livros no arquivo
+  const int32_t *ids;         // IDs em ordem crescente (mapeados)
+  const uint8_t *disponiveis; // Disponibilidade gravada no arquivo (mapeada)
+  const uint32_t *titulos;    // Posição de cada título nos textos (mapeada)
+  const uint32_t *autores;    // Posição de cada autor nos textos (mapeada)
+  const char *textos;         // Seção de textos (mapeada)
+  uint64_t tamanhoTextos;     // Tamanho da seção de textos
+  uint8_t *estados;           // EstadoEntrada de cada livro (memória privada)
+  size_t removidas;           // Entradas no estado ENTRADA_REMOVIDA
+} Catalogo;
+
+/*
+ * Inicializa um catálogo fechado.
+ */
+void iniciarCatalogo(Catalogo *catalogo);
+
+/*
+ * Mapeia um snapshot como catálogo.
+ * Confere o cabeçalho e se o arquivo tem o tamanho que ele indica; a soma
+ * de verificação não é conferida, porque exigiria ler o arquivo inteiro.
+ * As posições dos textos são conferidas quando cada livro é lido.
+ * Retorna 0 se o arquivo não existir, não for um snapshot válido ou não
+ * houver memória.
+ */
+int abrirCatalogo(Catalogo *catalogo, const char *nomeArquivo);
+
+/*
+ * Desfaz o mapeamento e libera os estados. Os textos do catálogo deixam
+ * de valer.
+ */
+void fecharCatalogo(Catalogo *catalogo);
+
+/*
+ * Retorna a primeira posição do catálogo com ID maior ou igual ao
+ * informado (quantidade, se não houver), por busca binária no vetor
+ * mapeado. É o ponto de partida das consultas por faixa de IDs.
+ */
+size_t posicaoCatalogo(const Catalogo *catalogo, int id);
+
+/*
+ * Procura um ID no catálogo por busca binária no vetor mapeado.
+ * Retorna a posição do livro ou -1 se o ID não estiver no catálogo
+ * (qualquer que seja o estado da entrada).
+ */
+long procurarCatalogo(const Catalogo *catalogo, int id);
+
+/*
+ * Lê o livro de uma posição do catálogo, com os dados gravados no arquivo.
+ * Título e autor apontam para as páginas mapeadas, no formato da arena
+ * (tamanhoTexto funciona com eles); uma posição inválida vira texto vazio.
+ * Os textos não podem ser alterados.
+ */
+void lerEntradaCatalogo(const Catalogo *catalogo, size_t pos, RegistroLivro *registro);
+
+#endif
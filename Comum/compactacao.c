@@ -0,0 +1,106 @@
+/*
+ * compactacao.c
+ *
+ * Implementação do salvamento em segundo plano.
+ * Este arquivo contém todas as funções declaradas em compactacao.h.
+ */
+
+#include "compactacao.h"
+#include "snapshot.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Inicializa um salvamento parado.
+ */
+void iniciarCompactacao(Compactacao *compactacao)
+{
+  compactacao->processo = 0;
+  compactacao->diario = NULL;
+}
+
+/*
+ * Grava o snapshot no processo filho e termina.
+ * Usa _exit, e não exit, para não descarregar uma segunda vez os buffers
+ * de saída herdados do processo original.
+ */
+void gravarNoFilho(const char *nomeNovo, const char *nomeArquivo, GravarSnapshot gravar, void *contexto)
+{
+  FILE *arquivo = fopen(nomeNovo, "wb");
+  int ok = arquivo != NULL && gravar(contexto, arquivo) && sincronizarArquivo(arquivo);
+  ok = arquivo != NULL && fclose(arquivo) == 0 && ok && trocarArquivo(nomeNovo, nomeArquivo);
+  if (!ok)
+    remove(nomeNovo);
+  _exit(ok ? 0 : 1);
+}
+
+/*
+ * Inicia o salvamento em segundo plano.
+ *
+ * Como funciona:
+ * 1. Rotaciona o diário: tudo o que foi registrado até aqui vai para o
+ *    diário antigo, e as próximas operações vão para o diário vazio
+ * 2. Duplica o processo; o filho grava o snapshot da cópia da memória e o
+ *    processo original volta na hora para o menu
+ *
+ * Se a rotação falhar, o salvamento continua: o diário antigo (se houver)
+ * e o diário ainda têm todas as operações, e reaplicar as que já estão no
+ * snapshot não muda nada.
+ */
+int compactarEmSegundoPlano(Compactacao *compactacao, Diario *diario, const char *nomeArquivo,
+                            GravarSnapshot gravar, void *contexto)
+{
+  if (compactacao->processo != 0)
+    return 0;
+
+  size_t tamanhoNome = strlen(nomeArquivo);
+  char *nomeNovo = (char *)malloc(tamanhoNome + sizeof(".novo"));
+  if (nomeNovo == NULL)
+    return 0;
+  memcpy(nomeNovo, nomeArquivo, tamanhoNome);
+  memcpy(nomeNovo + tamanhoNome, ".novo", sizeof(".novo"));
+
+  if (diario != NULL && !rotacionarDiario(diario))
+    printf("Aviso: não foi possível rotacionar o diário.\n");
+
+  fflush(stdout);
+  pid_t processo = fork();
+  if (processo == 0)
+    gravarNoFilho(nomeNovo, nomeArquivo, gravar, contexto);
+  free(nomeNovo);
+  if (processo < 0)
+    return 0;
+
+  compactacao->processo = processo;
+  compactacao->diario = diario;
+  return 1;
+}
+
+/*
+ * Confere o processo filho com waitpid (sem bloquear, a não ser que
+ * esperar seja diferente de 0).
+ */
+EstadoCompactacao verificarCompactacao(Compactacao *compactacao, int esperar)
+{
+  if (compactacao->processo == 0)
+    return COMPACTACAO_PARADA;
+
+  int status;
+  pid_t terminou;
+  do
+  {
+    terminou = waitpid(compactacao->processo, &status, esperar ? 0 : WNOHANG);
+  } while (terminou < 0 && errno == EINTR);
+  if (terminou == 0)
+    return COMPACTACAO_EM_ANDAMENTO;
+
+  int ok = terminou > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  if (ok && compactacao->diario != NULL)
+    descartarDiarioAntigo(compactacao->diario);
+  iniciarCompactacao(compactacao);
+  return ok ? COMPACTACAO_CONCLUIDA : COMPACTACAO_FALHOU;
+}
@@ -0,0 +1,82 @@
+/*
+ * compactacao.h
+ *
+ * Este arquivo contém as definições do salvamento em segundo plano usado
+ * pelas duas implementações da biblioteca. Em vez de gravar o snapshot com
+ * o programa parado, o processo é duplicado com fork(): o processo filho
+ * recebe uma cópia da memória no instante da chamada e grava o snapshot a
+ * partir dela, enquanto o processo original continua atendendo inserções,
+ * empréstimos e as demais operações.
+ *
+ * A cópia é feita por cópia na escrita (copy-on-write): o sistema só
+ * duplica uma página quando um dos processos a altera, então o custo da
+ * chamada é copiar as tabelas de páginas, e o filho vê sempre a biblioteca
+ * exatamente como estava no instante do fork, sem travas nem versões nos
+ * nós.
+ *
+ * No mesmo instante o diário é rotacionado: as operações anteriores ao
+ * snapshot vão para o diário antigo, que é apagado quando o filho termina
+ * com o snapshot no disco.
+ */
+
+#ifndef COMPACTACAO_H
+#define COMPACTACAO_H
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "diario.h"
+
+/*
+ * Estado de um salvamento em segundo plano.
+ */
+typedef enum
+{
+  COMPACTACAO_PARADA,       // Nenhum salvamento em andamento
+  COMPACTACAO_EM_ANDAMENTO, // O processo filho ainda está gravando
+  COMPACTACAO_CONCLUIDA,    // O snapshot está no disco e o diário antigo foi apagado
+  COMPACTACAO_FALHOU        // O filho não conseguiu gravar; o diário antigo foi mantido
+} EstadoCompactacao;
+
+/*
+ * Salvamento em segundo plano.
+ */
+typedef struct
+{
+  pid_t processo; // Processo filho que grava o snapshot (0 se nenhum)
+  Diario *diario; // Diário rotacionado no início (NULL se não houver)
+} Compactacao;
+
+/*
+ * Função que grava o snapshot da biblioteca no arquivo, chamada no
+ * processo filho. Não deve escrever na saída padrão.
+ * Retorna 0 se a gravação falhar.
+ */
+typedef int (*GravarSnapshot)(void *contexto, FILE *arquivo);
+
+/*
+ * Inicializa um salvamento parado.
+ */
+void iniciarCompactacao(Compactacao *compactacao);
+
+/*
+ * Rotaciona o diário (se houver) e inicia o processo filho, que grava o
+ * snapshot em nomeArquivo + ".novo", sincroniza e o renomeia para
+ * nomeArquivo. Volta assim que o filho é criado. Com diario NULL, o
+ * diário não é rotacionado nem apagado; é o que se deve passar quando a
+ * memória pode não conter todas as operações dele.
+ * Retorna 0 se já houver um salvamento em andamento ou se o processo não
+ * puder ser criado.
+ */
+int compactarEmSegundoPlano(Compactacao *compactacao, Diario *diario, const char *nomeArquivo,
+                            GravarSnapshot gravar, void *contexto);
+
+/*
+ * Confere se o processo filho terminou; com esperar diferente de 0, espera
+ * por ele. Ao terminar com sucesso, apaga o diário antigo.
+ * Retorna COMPACTACAO_CONCLUIDA ou COMPACTACAO_FALHOU uma única vez, na
+ * chamada que percebe o fim; depois disso, COMPACTACAO_PARADA.
+ */
+EstadoCompactacao verificarCompactacao(Compactacao *compactacao, int esperar);
+
+#endif
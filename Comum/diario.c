@@ -0,0 +1,510 @@
+/*
+ * diario.c
+ *
+ * Implementação do diário de operações.
+ * Este arquivo contém todas as funções declaradas em diario.h.
+ */
+
+#include "diario.h"
+#include "snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Soma de verificação de um registro: FNV-1a de 32 bits, byte a byte (os
+ * registros são pequenos).
+ */
+uint32_t somarOperacao(const char *dados, size_t tamanho)
+{
+  uint32_t soma = 0x811C9DC5u;
+  for (size_t i = 0; i < tamanho; i++)
+  {
+    soma = (soma ^ (uint8_t)dados[i]) * 0x01000193u;
+  }
+  return soma;
+}
+
+/*
+ * Confere o registro que começa em dados, com `restante` bytes até o fim
+ * do arquivo. Retorna o tamanho do registro, ou 0 se ele estiver
+ * incompleto ou corrompido.
+ */
+size_t registroValido(const char *dados, size_t restante)
+{
+  CabecalhoOperacao cabecalho;
+  if (restante < sizeof(cabecalho))
+    return 0;
+  memcpy(&cabecalho, dados, sizeof(cabecalho));
+
+  size_t textos = 0;
+  if (cabecalho.operacao == OPERACAO_INSERIR)
+    textos = (size_t)cabecalho.tamanhoTitulo + 1 + (size_t)cabecalho.tamanhoAutor + 1;
+  if (cabecalho.operacao < OPERACAO_INSERIR || cabecalho.operacao > OPERACAO_DEVOLVER ||
+      cabecalho.tamanho != sizeof(cabecalho) + textos || cabecalho.tamanho > restante)
+    return 0;
+
+  size_t inicioSoma = offsetof(CabecalhoOperacao, operacao);
+  if (somarOperacao(dados + inicioSoma, cabecalho.tamanho - inicioSoma) != cabecalho.soma)
+    return 0;
+  if (textos > 0 && (dados[sizeof(cabecalho) + cabecalho.tamanhoTitulo] != '\0' ||
+                     dados[cabecalho.tamanho - 1] != '\0'))
+    return 0;
+  return cabecalho.tamanho;
+}
+
+/*
+ * Percorre os registros a partir do início e retorna onde termina o
+ * último registro válido.
+ */
+size_t tamanhoValido(const char *dados, size_t tamanho)
+{
+  size_t valido = 0, n;
+  while ((n = registroValido(dados + valido, tamanho - valido)) > 0)
+  {
+    valido += n;
+  }
+  return valido;
+}
+
+/*
+ * Lê o arquivo inteiro do diário para um buffer (com um '\0' no fim).
+ * Retorna NULL se não conseguir; *tamanho recebe o tamanho lido.
+ */
+char *lerArquivoDiario(int fd, size_t *tamanho)
+{
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+    return NULL;
+
+  size_t total = (size_t)info.st_size;
+  char *dados = (char *)malloc(total + 1);
+  if (dados == NULL)
+    return NULL;
+
+  size_t lido = 0;
+  while (lido < total)
+  {
+    ssize_t n = pread(fd, dados + lido, total - lido, (off_t)lido);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    lido += (size_t)n;
+  }
+  dados[lido] = '\0';
+  *tamanho = lido;
+  return dados;
+}
+
+/*
+ * Grava um buffer inteiro no arquivo, repetindo a escrita se ela for
+ * parcial. Retorna 0 se a escrita falhar.
+ */
+int escreverTudo(int fd, const char *dados, size_t tamanho)
+{
+  while (tamanho > 0)
+  {
+    ssize_t n = write(fd, dados, tamanho);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return 0;
+    dados += n;
+    tamanho -= (size_t)n;
+  }
+  return 1;
+}
+
+/*
+ * Soma milissegundos a um instante.
+ */
+struct timespec somarMilissegundos(struct timespec instante, long ms)
+{
+  instante.tv_sec += ms / 1000;
+  instante.tv_nsec += (ms % 1000) * 1000000L;
+  if (instante.tv_nsec >= 1000000000L)
+  {
+    instante.tv_sec++;
+    instante.tv_nsec -= 1000000000L;
+  }
+  return instante;
+}
+
+/*
+ * Laço da thread sincronizadora.
+ *
+ * Como funciona:
+ * 1. Dorme até chegar um registro
+ * 2. Espera a janela a partir do primeiro registro do lote, a não ser que
+ *    o lote encha, alguém peça sincronização ou o diário seja fechado
+ * 3. Troca o lote pelo buffer de gravação, solta a trava e grava tudo com
+ *    uma escrita e um fdatasync; enquanto isso, novas operações continuam
+ *    entrando no lote seguinte
+ * 4. Marca os registros como duráveis e avisa quem estiver esperando
+ */
+void *sincronizarLotes(void *argumento)
+{
+  Diario *diario = (Diario *)argumento;
+  pthread_mutex_lock(&diario->trava);
+  while (1)
+  {
+    while (!diario->encerrar && diario->usado == 0)
+    {
+      pthread_cond_wait(&diario->temTrabalho, &diario->trava);
+    }
+    if (diario->usado == 0)
+      break; // Encerrando, sem nada pendente
+
+    struct timespec prazo = somarMilissegundos(diario->inicioLote, JANELA_DIARIO_MS);
+    while (!diario->urgente && !diario->encerrar &&
+           pthread_cond_timedwait(&diario->temTrabalho, &diario->trava, &prazo) != ETIMEDOUT)
+      ;
+
+    char *dados = diario->lote;
+    size_t tamanho = diario->usado;
+    size_t capacidade = diario->capacidade;
+    uint64_t alvo = diario->registrados;
+    diario->lote = diario->gravando;
+    diario->capacidade = diario->capacidadeGravando;
+    diario->gravando = dados;
+    diario->capacidadeGravando = capacidade;
+    diario->usado = 0;
+    diario->urgente = 0;
+    diario->escrevendo = 1;
+    pthread_mutex_unlock(&diario->trava);
+
+    int ok = escreverTudo(diario->fd, dados, tamanho) && fdatasync(diario->fd) == 0;
+
+    pthread_mutex_lock(&diario->trava);
+    diario->escrevendo = 0;
+    diario->lotes++;
+    if (ok)
+      diario->duraveis = alvo;
+    else
+      diario->erro = 1;
+    pthread_cond_broadcast(&diario->gravou);
+  }
+  pthread_mutex_unlock(&diario->trava);
+  return NULL;
+}
+
+/*
+ * Abre (ou cria) o diário.
+ * Lê o arquivo uma vez para achar o fim do último registro válido e corta
+ * o que vier depois; depois inicia a thread sincronizadora.
+ */
+int abrirDiario(Diario *diario, const char *nomeArquivo)
+{
+  memset(diario, 0, sizeof(*diario));
+  size_t tamanhoNome = strlen(nomeArquivo);
+  diario->nome = (char *)malloc(tamanhoNome + 1);
+  diario->nomeAntigo = (char *)malloc(tamanhoNome + sizeof(".antigo"));
+  if (diario->nome != NULL && diario->nomeAntigo != NULL)
+  {
+    memcpy(diario->nome, nomeArquivo, tamanhoNome + 1);
+    memcpy(diario->nomeAntigo, nomeArquivo, tamanhoNome);
+    memcpy(diario->nomeAntigo + tamanhoNome, ".antigo", sizeof(".antigo"));
+    diario->fd = open(nomeArquivo, O_RDWR | O_CREAT | O_APPEND, 0644);
+  }
+  else
+  {
+    diario->fd = -1;
+  }
+  if (diario->fd < 0)
+  {
+    free(diario->nome);
+    free(diario->nomeAntigo);
+    return 0;
+  }
+
+  size_t tamanho;
+  char *dados = lerArquivoDiario(diario->fd, &tamanho);
+  int ok = dados != NULL;
+  if (ok)
+  {
+    size_t valido = tamanhoValido(dados, tamanho);
+    if (valido < tamanho)
+      ok = ftruncate(diario->fd, (off_t)valido) == 0 && fsync(diario->fd) == 0;
+    free(dados);
+  }
+
+  if (ok)
+  {
+    pthread_mutex_init(&diario->trava, NULL);
+    pthread_cond_init(&diario->temTrabalho, NULL);
+    pthread_cond_init(&diario->gravou, NULL);
+    ok = pthread_create(&diario->sincronizador, NULL, sincronizarLotes, diario) == 0;
+    if (!ok)
+    {
+      pthread_mutex_destroy(&diario->trava);
+      pthread_cond_destroy(&diario->temTrabalho);
+      pthread_cond_destroy(&diario->gravou);
+    }
+  }
+  if (!ok)
+  {
+    close(diario->fd);
+    free(diario->nome);
+    free(diario->nomeAntigo);
+    diario->fd = -1;
+  }
+  return ok;
+}
+
+/*
+ * Pede à thread que grave o que estiver pendente e termine, espera por
+ * ela e libera tudo.
+ */
+void fecharDiario(Diario *diario)
+{
+  pthread_mutex_lock(&diario->trava);
+  diario->encerrar = 1;
+  pthread_cond_signal(&diario->temTrabalho);
+  pthread_mutex_unlock(&diario->trava);
+  pthread_join(diario->sincronizador, NULL);
+
+  pthread_mutex_destroy(&diario->trava);
+  pthread_cond_destroy(&diario->temTrabalho);
+  pthread_cond_destroy(&diario->gravou);
+  close(diario->fd);
+  free(diario->lote);
+  free(diario->gravando);
+  free(diario->nome);
+  free(diario->nomeAntigo);
+  diario->fd = -1;
+}
+
+/*
+ * Acrescenta uma operação ao lote atual.
+ * O registro é montado direto no fim do lote, que dobra de tamanho quando
+ * preciso. O primeiro registro de um lote marca o início da janela.
+ */
+int registrarOperacao(Diario *diario, TipoOperacao operacao, int id,
+                      const char *titulo, const char *autor)
+{
+  CabecalhoOperacao cabecalho;
+  memset(&cabecalho, 0, sizeof(cabecalho));
+  cabecalho.operacao = operacao;
+  cabecalho.id = id;
+  size_t textos = 0;
+  if (operacao == OPERACAO_INSERIR)
+  {
+    cabecalho.tamanhoTitulo = (uint32_t)strlen(titulo);
+    cabecalho.tamanhoAutor = (uint32_t)strlen(autor);
+    textos = (size_t)cabecalho.tamanhoTitulo + 1 + (size_t)cabecalho.tamanhoAutor + 1;
+  }
+  cabecalho.tamanho = (uint32_t)(sizeof(cabecalho) + textos);
+
+  pthread_mutex_lock(&diario->trava);
+  if (diario->erro)
+  {
+    pthread_mutex_unlock(&diario->trava);
+    return 0;
+  }
+  if (diario->usado + cabecalho.tamanho > diario->capacidade)
+  {
+    size_t capacidade = diario->capacidade > 0 ? diario->capacidade : 4096;
+    while (diario->usado + cabecalho.tamanho > capacidade)
+    {
+      capacidade *= 2;
+    }
+    char *lote = (char *)realloc(diario->lote, capacidade);
+    if (lote == NULL)
+    {
+      pthread_mutex_unlock(&diario->trava);
+      return 0;
+    }
+    diario->lote = lote;
+    diario->capacidade = capacidade;
+  }
+
+  char *registro = diario->lote + diario->usado;
+  if (textos > 0)
+  {
+    memcpy(registro + sizeof(cabecalho), titulo, cabecalho.tamanhoTitulo + 1);
+    memcpy(registro + sizeof(cabecalho) + cabecalho.tamanhoTitulo + 1, autor, cabecalho.tamanhoAutor + 1);
+  }
+  memcpy(registro, &cabecalho, sizeof(cabecalho));
+  size_t inicioSoma = offsetof(CabecalhoOperacao, operacao);
+  cabecalho.soma = somarOperacao(registro + inicioSoma, cabecalho.tamanho - inicioSoma);
+  memcpy(registro + offsetof(CabecalhoOperacao, soma), &cabecalho.soma, sizeof(cabecalho.soma));
+
+  if (diario->usado == 0)
+    clock_gettime(CLOCK_REALTIME, &diario->inicioLote);
+  diario->usado += cabecalho.tamanho;
+  diario->registrados++;
+  if (diario->usado >= TAMANHO_LOTE_DIARIO)
+    diario->urgente = 1;
+  pthread_cond_signal(&diario->temTrabalho);
+  pthread_mutex_unlock(&diario->trava);
+  return 1;
+}
+
+/*
+ * Pede a gravação imediata do lote e espera até que todos os registros
+ * aceitos até agora estejam no disco.
+ */
+int sincronizarDiario(Diario *diario)
+{
+  pthread_mutex_lock(&diario->trava);
+  uint64_t alvo = diario->registrados;
+  if (diario->duraveis < alvo)
+  {
+    diario->urgente = 1;
+    pthread_cond_signal(&diario->temTrabalho);
+  }
+  while (diario->duraveis < alvo && !diario->erro)
+  {
+    pthread_cond_wait(&diario->gravou, &diario->trava);
+  }
+  int ok = !diario->erro;
+  pthread_mutex_unlock(&diario->trava);
+  return ok;
+}
+
+/*
+ * Acrescenta os registros do diário ao fim do diário antigo, que já
+ * existe, e esvazia o diário.
+ * Um registro incompleto no fim do diário antigo (de uma queda no meio de
+ * uma cópia anterior) é cortado antes, senão esconderia os novos registros
+ * na reprodução. Se houver uma queda no meio da cópia, os registros ainda
+ * estão inteiros no diário e são reaplicados de novo, sem problema.
+ */
+int acrescentarAoAntigo(Diario *diario)
+{
+  int antigo = open(diario->nomeAntigo, O_RDWR | O_APPEND);
+  if (antigo < 0)
+    return 0;
+
+  size_t tamanho, tamanhoAntigo;
+  char *dados = lerArquivoDiario(diario->fd, &tamanho);
+  char *dadosAntigos = lerArquivoDiario(antigo, &tamanhoAntigo);
+  int ok = dados != NULL && dadosAntigos != NULL;
+  if (ok)
+  {
+    size_t valido = tamanhoValido(dadosAntigos, tamanhoAntigo);
+    if (valido < tamanhoAntigo)
+      ok = ftruncate(antigo, (off_t)valido) == 0;
+  }
+  ok = ok && escreverTudo(antigo, dados, tamanhoValido(dados, tamanho)) && fdatasync(antigo) == 0;
+  ok = ok && ftruncate(diario->fd, 0) == 0 && fsync(diario->fd) == 0;
+  free(dados);
+  free(dadosAntigos);
+  close(antigo);
+  return ok;
+}
+
+/*
+ * Rotaciona o diário.
+ *
+ * Como funciona:
+ * 1. Pede a gravação do lote pendente e espera a thread terminar, ficando
+ *    com a trava (novas operações esperam a rotação)
+ * 2. Se não houver diário antigo, renomeia o diário para ele e cria um
+ *    diário novo no lugar; senão, copia os registros para o fim dele
+ * 3. Sincroniza o diretório, para os nomes sobreviverem a uma queda
+ */
+int rotacionarDiario(Diario *diario)
+{
+  pthread_mutex_lock(&diario->trava);
+  while ((diario->usado > 0 || diario->escrevendo) && !diario->erro)
+  {
+    diario->urgente = 1;
+    pthread_cond_signal(&diario->temTrabalho);
+    pthread_cond_wait(&diario->gravou, &diario->trava);
+  }
+
+  int ok = !diario->erro;
+  if (ok && access(diario->nomeAntigo, F_OK) != 0)
+  {
+    ok = rename(diario->nome, diario->nomeAntigo) == 0;
+    int fd = ok ? open(diario->nome, O_RDWR | O_CREAT | O_APPEND, 0644) : -1;
+    if (fd >= 0)
+    {
+      close(diario->fd);
+      diario->fd = fd;
+    }
+    else if (ok)
+    {
+      // Sem um diário novo, o antigo volta para o lugar
+      rename(diario->nomeAntigo, diario->nome);
+      ok = 0;
+    }
+    ok = ok && sincronizarDiretorio(diario->nome);
+  }
+  else if (ok)
+  {
+    ok = acrescentarAoAntigo(diario);
+  }
+  pthread_mutex_unlock(&diario->trava);
+  return ok;
+}
+
+/*
+ * Apaga o diário antigo e sincroniza o diretório.
+ */
+int descartarDiarioAntigo(Diario *diario)
+{
+  return unlink(diario->nomeAntigo) == 0 && sincronizarDiretorio(diario->nomeAntigo);
+}
+
+/*
+ * Reaplica os registros de um buffer, até o primeiro inválido.
+ * Título e autor são passados apontando para dentro do buffer.
+ */
+long reproduzirRegistros(const char *dados, size_t tamanho, AplicarOperacao aplicar, void *contexto)
+{
+  long aplicadas = 0;
+  size_t pos = 0, n;
+  while ((n = registroValido(dados + pos, tamanho - pos)) > 0)
+  {
+    CabecalhoOperacao cabecalho;
+    memcpy(&cabecalho, dados + pos, sizeof(cabecalho));
+    const char *titulo = NULL, *autor = NULL;
+    if (cabecalho.operacao == OPERACAO_INSERIR)
+    {
+      titulo = dados + pos + sizeof(cabecalho);
+      autor = titulo + cabecalho.tamanhoTitulo + 1;
+    }
+    aplicar(contexto, (TipoOperacao)cabecalho.operacao, cabecalho.id, titulo, autor);
+    aplicadas++;
+    pos += n;
+  }
+  return aplicadas;
+}
+
+/*
+ * Reaplica as operações do diário antigo e depois as do diário.
+ * Cada arquivo é lido de uma vez e os registros são percorridos no buffer.
+ */
+long reproduzirDiario(Diario *diario, AplicarOperacao aplicar, void *contexto)
+{
+  if (!sincronizarDiario(diario))
+    return -1;
+
+  long aplicadas = 0;
+  size_t tamanho;
+  char *dados;
+  int antigo = open(diario->nomeAntigo, O_RDONLY);
+  if (antigo >= 0)
+  {
+    dados = lerArquivoDiario(antigo, &tamanho);
+    close(antigo);
+    if (dados == NULL)
+      return -1;
+    aplicadas += reproduzirRegistros(dados, tamanho, aplicar, contexto);
+    free(dados);
+  }
+
+  dados = lerArquivoDiario(diario->fd, &tamanho);
+  if (dados == NULL)
+    return -1;
+  aplicadas += reproduzirRegistros(dados, tamanho, aplicar, contexto);
+  free(dados);
+  return aplicadas;
+}
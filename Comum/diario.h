@@ -0,0 +1,164 @@
+/*
+ * diario.h
+ *
+ * Este arquivo contém as definições do diário de operações usado pelas
+ * duas implementações da biblioteca. O diário é um arquivo em que só se
+ * acrescenta: cada inserção, remoção, empréstimo ou devolução vira um
+ * registro pequeno no fim do arquivo. Ao carregar livros.dat (o último
+ * snapshot ou o arquivo texto original), as operações do diário são
+ * reaplicadas por cima dele, então nada feito depois do último salvamento
+ * se perde se o programa for interrompido.
+ *
+ * Gravação em lote (group commit): os registros são juntados na memória e
+ * uma thread grava o lote inteiro com uma escrita e um fdatasync, no
+ * máximo JANELA_DIARIO_MS depois do primeiro registro do lote (ou antes,
+ * se o lote encher ou alguém pedir sincronizarDiario). Assim o custo de
+ * durabilidade é uma escrita sequencial pequena por lote, e não uma por
+ * operação nem um salvamento completo da biblioteca.
+ *
+ * Formato de cada registro (na ordem de bytes da máquina): o cabeçalho
+ * CabecalhoOperacao seguido do título e do autor, cada um com '\0' (só na
+ * inserção; nas demais operações os dois têm tamanho 0 e não são
+ * gravados). A soma de verificação detecta um registro gravado pela
+ * metade no fim do arquivo, que é descartado.
+ *
+ * As operações do diário podem ser reaplicadas mais de uma vez sobre um
+ * snapshot que já as contém sem mudar o resultado (inserir um ID que já
+ * existe não faz nada, e empréstimo e devolução só definem o status), então
+ * o diário pode ser esvaziado depois que o novo snapshot estiver gravado.
+ *
+ * Para salvar sem parar as operações, o diário é rotacionado: os registros
+ * até o instante do snapshot passam para o diário antigo (o mesmo nome com
+ * ".antigo") e os novos continuam no arquivo original. O diário antigo só
+ * é apagado depois que o snapshot estiver no disco; até lá, os dois são
+ * reaplicados, primeiro o antigo.
+ */
+
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define JANELA_DIARIO_MS 10       // Atraso máximo entre uma operação e a gravação do seu lote
+#define TAMANHO_LOTE_DIARIO 65536 // Bytes que fazem um lote ser gravado sem esperar a janela
+
+/*
+ * Tipos de operação registrados no diário.
+ */
+typedef enum
+{
+  OPERACAO_INSERIR = 1,
+  OPERACAO_REMOVER,
+  OPERACAO_EMPRESTAR,
+  OPERACAO_DEVOLVER
+} TipoOperacao;
+
+/*
+ * Cabeçalho de um registro do diário (24 bytes).
+ * Os tamanhos dos textos não contam o '\0'.
+ */
+typedef struct
+{
+  uint32_t tamanho;       // Tamanho do registro inteiro, com os textos
+  uint32_t soma;          // Soma de verificação dos bytes depois deste campo
+  uint32_t operacao;      // TipoOperacao
+  int32_t id;             // ID do livro
+  uint32_t tamanhoTitulo; // Tamanho do título (só na inserção)
+  uint32_t tamanhoAutor;  // Tamanho do autor (só na inserção)
+} CabecalhoOperacao;
+
+/*
+ * Diário de operações aberto.
+ * Tudo abaixo de trava é protegido por ela; só a thread sincronizadora
+ * grava no arquivo, a partir do buffer gravando.
+ */
+typedef struct
+{
+  int fd;                     // Arquivo do diário
+  char *nome;                 // Nome do arquivo do diário
+  char *nomeAntigo;           // Nome do diário antigo (nome + ".antigo")
+  pthread_t sincronizador;    // Thread que grava os lotes
+  pthread_mutex_t trava;      // Protege os campos abaixo
+  pthread_cond_t temTrabalho; // Avisa a thread de um lote novo ou urgente
+  pthread_cond_t gravou;      // Avisa quem espera que um lote foi gravado
+  char *lote;                 // Registros ainda não gravados
+  size_t usado;               // Bytes ocupados em lote
+  size_t capacidade;          // Tamanho alocado de lote
+  char *gravando;             // Lote que a thread está gravando
+  size_t capacidadeGravando;  // Tamanho alocado de gravando
+  struct timespec inicioLote; // Quando o primeiro registro do lote chegou
+  uint64_t registrados;       // Registros aceitos desde a abertura
+  uint64_t duraveis;          // Registros já gravados com fdatasync
+  uint64_t lotes;             // Lotes gravados (quantidade de fdatasync)
+  int escrevendo;             // 1 enquanto a thread grava fora da trava
+  int urgente;                // Gravar sem esperar a janela
+  int encerrar;               // Pedido para a thread terminar
+  int erro;                   // Alguma gravação falhou
+} Diario;
+
+/*
+ * Função chamada para cada registro por reproduzirDiario.
+ * Título e autor só valem durante a chamada (e são NULL fora da inserção).
+ */
+typedef void (*AplicarOperacao)(void *contexto, TipoOperacao operacao, int id,
+                                const char *titulo, const char *autor);
+
+/*
+ * Abre (ou cria) o diário e inicia a thread que grava os lotes.
+ * Um registro incompleto no fim do arquivo, deixado por uma interrupção
+ * no meio de uma gravação, é cortado antes de novos registros entrarem.
+ * Retorna 0 se o arquivo não puder ser aberto ou faltar memória.
+ */
+int abrirDiario(Diario *diario, const char *nomeArquivo);
+
+/*
+ * Grava o que estiver pendente, encerra a thread e fecha o arquivo.
+ */
+void fecharDiario(Diario *diario);
+
+/*
+ * Acrescenta uma operação ao lote atual. Não espera a gravação: a
+ * operação fica durável em até JANELA_DIARIO_MS (ou em sincronizarDiario).
+ * Título e autor só são usados na inserção.
+ * Retorna 0 se faltar memória ou se uma gravação anterior tiver falhado.
+ */
+int registrarOperacao(Diario *diario, TipoOperacao operacao, int id,
+                      const char *titulo, const char *autor);
+
+/*
+ * Espera até que todas as operações registradas estejam gravadas no disco.
+ * Retorna 0 se alguma gravação falhar.
+ */
+int sincronizarDiario(Diario *diario);
+
+/*
+ * Grava o lote pendente e passa todos os registros do diário para o diário
+ * antigo, deixando o diário vazio para as próximas operações. Se o diário
+ * antigo ainda existir (um salvamento anterior não terminou), os registros
+ * são acrescentados a ele. Deve ser chamado no instante do snapshot, sem
+ * operações registradas ao mesmo tempo.
+ * Retorna 0 se alguma gravação falhar; nesse caso nenhum registro se perde.
+ */
+int rotacionarDiario(Diario *diario);
+
+/*
+ * Apaga o diário antigo. Deve ser chamado só depois que um snapshot com
+ * todas as operações dele estiver no disco.
+ * Retorna 0 se o arquivo não puder ser apagado.
+ */
+int descartarDiarioAntigo(Diario *diario);
+
+/*
+ * Reaplica, em ordem, todas as operações gravadas no diário antigo (se
+ * existir) e no diário, parando no primeiro registro inválido de cada um.
+ * Sincroniza antes, para incluir o lote pendente. Quem chama não deve registrar novas operações no diário
+ * enquanto reaplica.
+ * Retorna a quantidade de operações reaplicadas ou -1 se o arquivo não
+ * puder ser lido.
+ */
+long reproduzirDiario(Diario *diario, AplicarOperacao aplicar, void *contexto);
+
+#endif
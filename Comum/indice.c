@@ -0,0 +1,181 @@
+/*
+ * indice.c
+ *
+ * Implementação do índice hash de IDs.
+ * Este arquivo contém todas as funções declaradas em indice.h.
+ */
+
+#include "indice.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CAPACIDADE_INICIAL_INDICE 1024 // Posições alocadas no primeiro livro
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarIndice(IndiceHash *indice)
+{
+  indice->entradas = NULL;
+  indice->capacidade = 0;
+  indice->quantidade = 0;
+}
+
+/*
+ * Libera a tabela do índice.
+ */
+void liberarIndice(IndiceHash *indice)
+{
+  free(indice->entradas);
+  iniciarIndice(indice);
+}
+
+/*
+ * Posição inicial de um ID na tabela.
+ * Multiplica pela constante de Fibonacci e mistura os bits altos nos
+ * baixos, para que IDs sequenciais não caiam em posições vizinhas.
+ */
+size_t posicaoIndice(const IndiceHash *indice, int id)
+{
+  uint32_t h = (uint32_t)id * 0x9E3779B1u;
+  h ^= h >> 16;
+  return h & (indice->capacidade - 1);
+}
+
+/*
+ * Troca a tabela por uma com a capacidade informada, reinserindo todos
+ * os livros. Retorna 0 se não houver memória (a tabela antiga é mantida).
+ */
+int redimensionarIndice(IndiceHash *indice, size_t capacidade)
+{
+  EntradaIndice *entradas = (EntradaIndice *)calloc(capacidade, sizeof(EntradaIndice));
+  if (entradas == NULL)
+    return 0;
+
+  EntradaIndice *antigas = indice->entradas;
+  size_t capacidadeAntiga = indice->capacidade;
+  indice->entradas = entradas;
+  indice->capacidade = capacidade;
+
+  for (size_t i = 0; i < capacidadeAntiga; i++)
+  {
+    if (antigas[i].livro != NULL)
+    {
+      size_t pos = posicaoIndice(indice, antigas[i].id);
+      while (entradas[pos].livro != NULL)
+      {
+        pos = (pos + 1) & (capacidade - 1);
+      }
+      entradas[pos] = antigas[i];
+    }
+  }
+  free(antigas);
+  return 1;
+}
+
+/*
+ * Garante espaço para `quantidade` livros.
+ * Dobra a capacidade até que `quantidade` fique abaixo de 3/4 dela.
+ */
+int reservarIndice(IndiceHash *indice, size_t quantidade)
+{
+  size_t capacidade = indice->capacidade > 0 ? indice->capacidade : CAPACIDADE_INICIAL_INDICE;
+  while (quantidade >= capacidade / 4 * 3)
+  {
+    capacidade *= 2;
+  }
+  if (capacidade == indice->capacidade)
+    return 1;
+  return redimensionarIndice(indice, capacidade);
+}
+
+/*
+ * Retorna a posição de um ID na tabela ou, se ele não estiver nela, a
+ * posição vazia onde a sondagem parou (onde o ID seria colocado).
+ * A sondagem pode parar na primeira posição vazia porque a remoção não
+ * deixa buracos no meio de uma sequência. A tabela não pode estar vazia.
+ */
+EntradaIndice *procurarPosicao(const IndiceHash *indice, int id)
+{
+  size_t pos = posicaoIndice(indice, id);
+  while (indice->entradas[pos].livro != NULL && indice->entradas[pos].id != id)
+  {
+    pos = (pos + 1) & (indice->capacidade - 1);
+  }
+  return &indice->entradas[pos];
+}
+
+/*
+ * Associa um ID a um livro.
+ * Se o ID já estiver no índice, só troca o livro (sem alocar nada, então
+ * não falha); senão cresce a tabela se preciso e ocupa a posição vazia.
+ */
+int inserirIndice(IndiceHash *indice, int id, void *livro)
+{
+  if (indice->capacidade > 0)
+  {
+    EntradaIndice *entrada = procurarPosicao(indice, id);
+    if (entrada->livro != NULL)
+    {
+      entrada->livro = livro;
+      return 1;
+    }
+  }
+
+  if (!reservarIndice(indice, indice->quantidade + 1))
+    return 0;
+  EntradaIndice *entrada = procurarPosicao(indice, id);
+  entrada->id = id;
+  entrada->livro = livro;
+  indice->quantidade++;
+  return 1;
+}
+
+/*
+ * Procura um ID no índice.
+ */
+void *consultarIndice(const IndiceHash *indice, int id)
+{
+  if (indice->quantidade == 0)
+    return NULL;
+  return procurarPosicao(indice, id)->livro;
+}
+
+/*
+ * Remove um ID do índice.
+ *
+ * Como funciona (remoção com deslocamento, sem marcas de "removido"):
+ * 1. Acha a posição do ID e a esvazia
+ * 2. Percorre a sequência seguinte; cada entrada cuja posição inicial não
+ *    está entre o buraco e ela mesma (em ordem circular) é puxada para o
+ *    buraco, que passa a ser a posição de onde ela saiu
+ * 3. Para na primeira posição vazia
+ */
+void removerIndice(IndiceHash *indice, int id)
+{
+  if (indice->quantidade == 0)
+    return;
+
+  size_t mascara = indice->capacidade - 1;
+  EntradaIndice *entrada = procurarPosicao(indice, id);
+  if (entrada->livro == NULL)
+    return;
+  size_t buraco = (size_t)(entrada - indice->entradas);
+
+  size_t pos = buraco;
+  while (1)
+  {
+    pos = (pos + 1) & mascara;
+    if (indice->entradas[pos].livro == NULL)
+      break;
+    size_t inicial = posicaoIndice(indice, indice->entradas[pos].id);
+    if (((pos - inicial) & mascara) >= ((pos - buraco) & mascara))
+    {
+      indice->entradas[buraco] = indice->entradas[pos];
+      buraco = pos;
+    }
+  }
+  indice->entradas[buraco].livro = NULL;
+  indice->quantidade--;
+}
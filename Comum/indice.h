@@ -0,0 +1,71 @@
+/*
+ * indice.h
+ *
+ * Este arquivo contém as definições do índice por ID usado pelas duas
+ * implementações da biblioteca. É uma tabela hash de endereçamento aberto
+ * (sondagem linear) que leva de um ID direto ao livro, em O(1) esperado,
+ * sem descer pela árvore nem percorrer a lista.
+ */
+
+#ifndef INDICE_H
+#define INDICE_H
+
+#include <stddef.h>
+
+/*
+ * Posição da tabela.
+ * Uma posição com livro NULL está vazia.
+ */
+typedef struct
+{
+  int id;      // ID do livro
+  void *livro; // Livro com esse ID (Livro * da implementação)
+} EntradaIndice;
+
+/*
+ * Índice hash de IDs.
+ * A capacidade é sempre uma potência de 2 e a tabela cresce antes de
+ * passar de 3/4 de ocupação, para as sondagens continuarem curtas.
+ */
+typedef struct
+{
+  EntradaIndice *entradas; // Tabela (NULL enquanto o índice está vazio)
+  size_t capacidade;       // Quantidade de posições da tabela
+  size_t quantidade;       // Posições ocupadas
+} IndiceHash;
+
+/*
+ * Inicializa um índice vazio.
+ * Nenhuma memória é alocada até o primeiro livro.
+ */
+void iniciarIndice(IndiceHash *indice);
+
+/*
+ * Libera a tabela do índice (os livros não são liberados).
+ */
+void liberarIndice(IndiceHash *indice);
+
+/*
+ * Garante espaço para `quantidade` livros sem crescer a tabela.
+ * Depois de uma reserva bem-sucedida, inserirIndice não falha até esse
+ * total. Retorna 0 se não houver memória.
+ */
+int reservarIndice(IndiceHash *indice, size_t quantidade);
+
+/*
+ * Associa um ID a um livro, substituindo o livro anterior se o ID já
+ * estiver no índice. Retorna 0 se não houver memória para crescer a tabela.
+ */
+int inserirIndice(IndiceHash *indice, int id, void *livro);
+
+/*
+ * Retorna o livro associado ao ID ou NULL se o ID não estiver no índice.
+ */
+void *consultarIndice(const IndiceHash *indice, int id);
+
+/*
+ * Remove um ID do índice, se estiver nele.
+ */
+void removerIndice(IndiceHash *indice, int id);
+
+#endif
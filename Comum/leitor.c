@@ -0,0 +1,311 @@
+/*
+ * leitor.c
+ *
+ * Implementação do leitor de arquivos texto.
+ * Este arquivo contém todas as funções declaradas em leitor.h.
+ */
+
+#include "leitor.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Parte do arquivo lida por uma thread em lerRegistrosTexto.
+ */
+typedef struct
+{
+  char *inicio;                  // Início da parte (começo de uma linha)
+  size_t tamanho;                // Tamanho da parte (termina depois de um '\n')
+  Arena *textos;                 // Arena que recebe os textos
+  VetorRegistros *registros;     // Vetor que recebe os registros
+  Arena textosParte;             // Arena própria da thread
+  VetorRegistros registrosParte; // Vetor próprio da thread
+  pthread_t thread;              // Thread que lê a parte
+  int comThread;                 // 1 se a parte está numa thread separada
+  int ok;                        // 0 se faltou memória
+} ParteCarga;
+
+/*
+ * Converte um campo numérico, de inicio até fim, em int.
+ * Aceita espaços antes e depois (e o '\r' de arquivos com fim de linha do
+ * Windows) e um sinal opcional.
+ * Retorna 0 se o campo não for um número ou não couber num int.
+ */
+int lerInteiro(const char *inicio, const char *fim, int *valor)
+{
+  while (inicio < fim && (*inicio == ' ' || *inicio == '\t'))
+    inicio++;
+  int negativo = 0;
+  if (inicio < fim && (*inicio == '-' || *inicio == '+'))
+  {
+    negativo = *inicio == '-';
+    inicio++;
+  }
+
+  const char *digitos = inicio;
+  long long numero = 0;
+  while (inicio < fim && *inicio >= '0' && *inicio <= '9')
+  {
+    numero = numero * 10 + (*inicio - '0');
+    if (numero > (long long)INT_MAX + 1)
+      return 0;
+    inicio++;
+  }
+  if (inicio == digitos)
+    return 0;
+  while (inicio < fim && (*inicio == ' ' || *inicio == '\t' || *inicio == '\r'))
+    inicio++;
+  if (inicio != fim)
+    return 0;
+
+  if (negativo)
+    numero = -numero;
+  if (numero > INT_MAX)
+    return 0;
+  *valor = (int)numero;
+  return 1;
+}
+
+/*
+ * Separa os campos de uma linha.
+ * O título vai até o segundo '|' e a disponibilidade começa depois do
+ * terceiro; o autor é tudo o que fica entre eles.
+ */
+int lerLinhaLivro(char *inicio, char *fim, CamposLivro *campos)
+{
+  char *barraId = (char *)memchr(inicio, '|', (size_t)(fim - inicio));
+  if (barraId == NULL || !lerInteiro(inicio, barraId, &campos->id))
+    return 0;
+
+  char *titulo = barraId + 1;
+  char *barraTitulo = (char *)memchr(titulo, '|', (size_t)(fim - titulo));
+  if (barraTitulo == NULL)
+    return 0;
+
+  char *autor = barraTitulo + 1;
+  char *barraAutor = (char *)memchr(autor, '|', (size_t)(fim - autor));
+  if (barraAutor == NULL || !lerInteiro(barraAutor + 1, fim, &campos->disponivel))
+    return 0;
+
+  *barraTitulo = '\0';
+  *barraAutor = '\0';
+  campos->titulo = titulo;
+  campos->tamanhoTitulo = (size_t)(barraTitulo - titulo);
+  campos->autor = autor;
+  campos->tamanhoAutor = (size_t)(barraAutor - autor);
+  return 1;
+}
+
+/*
+ * Lê as linhas completas de um bloco.
+ * Cada '\n' é achado com memchr a partir do fim da linha anterior, então
+ * cada byte do bloco é visto poucas vezes.
+ */
+int lerBlocoLivros(char *dados, size_t tamanho, int final, size_t *consumido,
+                   ReceberLivro receber, void *contexto)
+{
+  char *linha = dados;
+  char *fimDados = dados + tamanho;
+  int ok = 1;
+  while (ok && linha < fimDados)
+  {
+    char *fimLinha = (char *)memchr(linha, '\n', (size_t)(fimDados - linha));
+    if (fimLinha == NULL)
+    {
+      if (!final)
+        break; // Linha incompleta; fica para o próximo bloco
+      fimLinha = fimDados;
+    }
+
+    CamposLivro campos;
+    if (lerLinhaLivro(linha, fimLinha, &campos))
+      ok = receber(contexto, &campos);
+    linha = fimLinha < fimDados ? fimLinha + 1 : fimDados;
+  }
+  *consumido = (size_t)(linha - dados);
+  return ok;
+}
+
+/*
+ * Lê o arquivo em blocos.
+ *
+ * Como funciona:
+ * 1. Completa o bloco com fread depois do que sobrou da leitura anterior
+ * 2. Lê as linhas completas do bloco com lerBlocoLivros
+ * 3. Move a linha incompleta do fim para o início do bloco; se ela ocupar
+ *    o bloco inteiro, dobra o bloco antes da próxima leitura
+ */
+int lerArquivoLivros(FILE *arquivo, ReceberLivro receber, void *contexto)
+{
+  size_t capacidade = TAMANHO_BLOCO_LEITURA;
+  char *bloco = (char *)malloc(capacidade);
+  if (bloco == NULL)
+    return 0;
+
+  size_t usado = 0;
+  int ok = 1, final = 0;
+  while (ok && !final)
+  {
+    if (usado == capacidade)
+    {
+      char *maior = (char *)realloc(bloco, capacidade * 2);
+      if (maior == NULL)
+      {
+        ok = 0;
+        break;
+      }
+      bloco = maior;
+      capacidade *= 2;
+    }
+
+    size_t lido = fread(bloco + usado, 1, capacidade - usado, arquivo);
+    usado += lido;
+    if (lido == 0)
+    {
+      final = 1;
+      ok = !ferror(arquivo);
+    }
+
+    size_t consumido = 0;
+    ok = ok && lerBlocoLivros(bloco, usado, final, &consumido, receber, contexto);
+    memmove(bloco, bloco + consumido, usado - consumido);
+    usado -= consumido;
+  }
+
+  free(bloco);
+  return ok;
+}
+
+/*
+ * Guarda uma linha lida na arena e no vetor da parte.
+ * Retorna 0 se não houver memória.
+ */
+int guardarCampos(void *contexto, const CamposLivro *campos)
+{
+  ParteCarga *parte = (ParteCarga *)contexto;
+  RegistroLivro registro;
+  registro.id = campos->id;
+  registro.disponivel = campos->disponivel;
+  registro.titulo = guardarTexto(parte->textos, campos->titulo, campos->tamanhoTitulo);
+  registro.autor = guardarTexto(parte->textos, campos->autor, campos->tamanhoAutor);
+  return registro.titulo != NULL && registro.autor != NULL &&
+         adicionarRegistro(parte->registros, &registro);
+}
+
+/*
+ * Lê uma parte do arquivo (função das threads de lerRegistrosTexto).
+ */
+void *lerParte(void *argumento)
+{
+  ParteCarga *parte = (ParteCarga *)argumento;
+  size_t consumido;
+  parte->ok = lerBlocoLivros(parte->inicio, parte->tamanho, 1, &consumido, guardarCampos, parte);
+  return NULL;
+}
+
+/*
+ * Decide quantas threads usar: o pedido (ou uma por processador), sem
+ * passar de MAX_THREADS_CARGA nem de uma por TAMANHO_MINIMO_PARTE.
+ */
+int escolherThreads(int threads, size_t tamanho)
+{
+  if (threads <= 0)
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > MAX_THREADS_CARGA)
+    threads = MAX_THREADS_CARGA;
+  size_t partes = tamanho / TAMANHO_MINIMO_PARTE;
+  if ((size_t)threads > partes)
+    threads = (int)partes;
+  return threads > 1 ? threads : 1;
+}
+
+/*
+ * Lê um arquivo texto para registros, em paralelo.
+ *
+ * Como funciona:
+ * 1. Com uma thread só, lê em blocos direto para a arena e o vetor finais
+ * 2. Senão, lê o arquivo inteiro para a memória e divide em partes de
+ *    tamanhos parecidos, cada uma terminando no primeiro '\n' depois do
+ *    seu tamanho alvo, então nenhuma linha fica dividida
+ * 3. Cada parte é lida numa thread (a primeira, na thread atual) com arena
+ *    e vetor próprios; nenhuma trava é necessária
+ * 4. Junta as arenas e os vetores na ordem das partes, que é a ordem do
+ *    arquivo, então IDs repetidos continuam na mesma ordem de antes
+ */
+int lerRegistrosTexto(FILE *arquivo, int threads, Arena *textos, VetorRegistros *registros)
+{
+  struct stat info;
+  long posicao = ftell(arquivo);
+  size_t tamanho = 0;
+  if (posicao >= 0 && fstat(fileno(arquivo), &info) == 0 && info.st_size > posicao)
+    tamanho = (size_t)(info.st_size - posicao);
+
+  int quantidade = escolherThreads(threads, tamanho);
+  if (quantidade == 1)
+  {
+    ParteCarga parte;
+    parte.textos = textos;
+    parte.registros = registros;
+    return lerArquivoLivros(arquivo, guardarCampos, &parte);
+  }
+
+  char *dados = (char *)malloc(tamanho);
+  if (dados == NULL)
+    return 0;
+  tamanho = fread(dados, 1, tamanho, arquivo);
+  if (ferror(arquivo))
+  {
+    free(dados);
+    return 0;
+  }
+
+  ParteCarga partes[MAX_THREADS_CARGA];
+  size_t inicio = 0;
+  for (int i = 0; i < quantidade; i++)
+  {
+    size_t fim = tamanho;
+    size_t alvo = tamanho / (size_t)quantidade * (size_t)(i + 1);
+    if (i < quantidade - 1 && alvo > inicio)
+    {
+      char *quebra = (char *)memchr(dados + alvo - 1, '\n', tamanho - alvo + 1);
+      if (quebra != NULL)
+        fim = (size_t)(quebra - dados) + 1;
+    }
+    else if (i < quantidade - 1)
+    {
+      fim = inicio; // A parte anterior já passou do alvo desta
+    }
+
+    ParteCarga *parte = &partes[i];
+    parte->inicio = dados + inicio;
+    parte->tamanho = fim - inicio;
+    iniciarArena(&parte->textosParte);
+    iniciarRegistros(&parte->registrosParte);
+    parte->textos = &parte->textosParte;
+    parte->registros = &parte->registrosParte;
+    parte->comThread = i > 0 && pthread_create(&parte->thread, NULL, lerParte, parte) == 0;
+    inicio = fim;
+  }
+
+  lerParte(&partes[0]);
+  int ok = 1;
+  for (int i = 0; i < quantidade; i++)
+  {
+    ParteCarga *parte = &partes[i];
+    if (parte->comThread)
+      pthread_join(parte->thread, NULL);
+    else if (i > 0)
+      lerParte(parte); // Não foi possível criar a thread
+    ok = ok && parte->ok && juntarRegistros(registros, &parte->registrosParte);
+    juntarArena(textos, &parte->textosParte);
+    liberarRegistros(&parte->registrosParte);
+  }
+
+  free(dados);
+  return ok;
+}
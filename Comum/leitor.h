@@ -0,0 +1,92 @@
+/*
+ * leitor.h
+ *
+ * Este arquivo contém as definições do leitor de arquivos texto usado pelas
+ * duas implementações da biblioteca, no formato id|titulo|autor|disponivel
+ * (uma linha por livro).
+ *
+ * O arquivo é lido em blocos grandes com fread, e as linhas são separadas
+ * direto no bloco: memchr acha o '\n' e cada '|' (a memchr da biblioteca
+ * padrão compara vários bytes por instrução), os números são convertidos
+ * à mão, sem sscanf nem atoi, e título e autor não são copiados; o '|'
+ * que termina cada um é trocado por '\0' no próprio bloco. Uma linha maior
+ * que o bloco faz o bloco crescer, então os campos não têm tamanho máximo.
+ *
+ * Para a carga em lote, lerRegistrosTexto divide o arquivo em partes que
+ * terminam em '\n' e lê cada parte numa thread, com arena e vetor de
+ * registros próprios; no fim, as arenas e os vetores são juntados na ordem
+ * do arquivo, sem copiar os textos.
+ */
+
+#ifndef LEITOR_H
+#define LEITOR_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "registro.h"
+
+#define TAMANHO_BLOCO_LEITURA (1 << 20) // Tamanho inicial do bloco de leitura (1 MB)
+#define MAX_THREADS_CARGA 16            // Máximo de threads na carga em lote
+#define TAMANHO_MINIMO_PARTE (4 << 20)  // Menor parte do arquivo que ganha uma thread (4 MB)
+
+/*
+ * Campos de uma linha lida.
+ * Título e autor apontam para dentro do bloco (terminados em '\0') e só
+ * valem durante a chamada de ReceberLivro.
+ */
+typedef struct
+{
+  int id;               // ID do livro
+  int disponivel;       // 1 se disponível, 0 se emprestado
+  char *titulo;         // Título do livro
+  size_t tamanhoTitulo; // Tamanho do título, sem o '\0'
+  char *autor;          // Nome do autor
+  size_t tamanhoAutor;  // Tamanho do autor, sem o '\0'
+} CamposLivro;
+
+/*
+ * Função chamada para cada linha válida.
+ * Retorna 0 para parar a leitura (por exemplo, se faltar memória).
+ */
+typedef int (*ReceberLivro)(void *contexto, const CamposLivro *campos);
+
+/*
+ * Separa os campos de uma linha (sem o '\n'), que vai de inicio até fim.
+ * Os separadores depois do título e do autor viram '\0'.
+ * Retorna 0 se a linha estiver mal formatada (menos de quatro campos ou
+ * ID ou disponibilidade que não sejam números).
+ */
+int lerLinhaLivro(char *inicio, char *fim, CamposLivro *campos);
+
+/*
+ * Lê as linhas completas de um bloco, chamando receber para cada linha
+ * válida; linhas mal formatadas são ignoradas. Se final for diferente de
+ * 0, o bloco vai até o fim do arquivo e a última linha, mesmo sem '\n',
+ * também é lida. *consumido recebe a quantidade de bytes das linhas lidas.
+ * Retorna 0 se receber pedir para parar.
+ */
+int lerBlocoLivros(char *dados, size_t tamanho, int final, size_t *consumido,
+                   ReceberLivro receber, void *contexto);
+
+/*
+ * Lê o arquivo inteiro, a partir da posição atual, em blocos de
+ * TAMANHO_BLOCO_LEITURA, chamando receber para cada linha válida.
+ * Retorna 0 se faltar memória, se a leitura falhar ou se receber pedir
+ * para parar.
+ */
+int lerArquivoLivros(FILE *arquivo, ReceberLivro receber, void *contexto);
+
+/*
+ * Lê o arquivo inteiro, a partir da posição atual, para um vetor de
+ * registros, com os textos guardados na arena. Com threads igual a 0, usa
+ * uma thread por processador; arquivos pequenos usam menos threads (uma
+ * por TAMANHO_MINIMO_PARTE) e, com uma thread só, o arquivo é lido em
+ * blocos por lerArquivoLivros, sem ficar inteiro na memória.
+ * Os registros ficam na ordem do arquivo (não são ordenados).
+ * Retorna 0 se faltar memória ou se a leitura falhar.
+ */
+int lerRegistrosTexto(FILE *arquivo, int threads, Arena *textos, VetorRegistros *registros);
+
+#endif
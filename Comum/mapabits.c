@@ -0,0 +1,384 @@
+/*
+ * mapabits.c
+ *
+ * Implementação do mapa de bits comprimido.
+ * Este arquivo contém todas as funções declaradas em mapabits.h.
+ */
+
+#include "mapabits.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Os IDs são tratados como inteiros sem sinal com o bit de sinal
+ * invertido, para que a ordem dos contêineres e dos bits seja a mesma dos
+ * IDs, inclusive dos negativos.
+ */
+uint32_t valorSemSinal(int id)
+{
+  return (uint32_t)id ^ 0x80000000u;
+}
+
+/*
+ * Volta do valor sem sinal para o ID.
+ */
+int idDoValor(uint32_t valor)
+{
+  return (int)(valor ^ 0x80000000u);
+}
+
+/*
+ * Inicializa um mapa vazio.
+ */
+void iniciarMapa(MapaBits *mapa)
+{
+  mapa->conteineres = NULL;
+  mapa->quantidade = 0;
+  mapa->capacidade = 0;
+  mapa->total = 0;
+}
+
+/*
+ * Libera o vetor ou o mapa de cada contêiner e depois a lista.
+ */
+void liberarMapa(MapaBits *mapa)
+{
+  for (int i = 0; i < mapa->quantidade; i++)
+  {
+    free(mapa->conteineres[i].vetor);
+    free(mapa->conteineres[i].bits);
+  }
+  free(mapa->conteineres);
+  iniciarMapa(mapa);
+}
+
+/*
+ * Busca binária da chave na lista de contêineres.
+ * Retorna a posição do primeiro contêiner com chave maior ou igual.
+ */
+int procurarConteiner(const MapaBits *mapa, uint16_t chave)
+{
+  int inicio = 0, fim = mapa->quantidade;
+  while (inicio < fim)
+  {
+    int meio = inicio + (fim - inicio) / 2;
+    if (mapa->conteineres[meio].chave < chave)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio;
+}
+
+/*
+ * Busca binária de um valor no vetor de um contêiner pequeno.
+ * Retorna a posição do primeiro valor maior ou igual.
+ */
+int procurarValor(const Conteiner *conteiner, uint16_t valor)
+{
+  int inicio = 0, fim = conteiner->quantidade;
+  while (inicio < fim)
+  {
+    int meio = inicio + (fim - inicio) / 2;
+    if (conteiner->vetor[meio] < valor)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio;
+}
+
+/*
+ * Troca o vetor de um contêiner por um mapa de bits com os mesmos IDs.
+ * Retorna 0 se não houver memória (o contêiner não muda).
+ */
+int converterEmMapa(Conteiner *conteiner)
+{
+  uint64_t *bits = (uint64_t *)calloc(PALAVRAS_MAPA, sizeof(uint64_t));
+  if (bits == NULL)
+    return 0;
+  for (int i = 0; i < conteiner->quantidade; i++)
+  {
+    bits[conteiner->vetor[i] >> 6] |= 1ULL << (conteiner->vetor[i] & 63);
+  }
+  free(conteiner->vetor);
+  conteiner->vetor = NULL;
+  conteiner->capacidade = 0;
+  conteiner->bits = bits;
+  return 1;
+}
+
+/*
+ * Troca o mapa de bits de um contêiner por um vetor com os mesmos IDs.
+ * Se não houver memória, o contêiner continua como mapa, que também é
+ * válido.
+ */
+void converterEmVetor(Conteiner *conteiner)
+{
+  int capacidade = conteiner->quantidade > 0 ? conteiner->quantidade : 1;
+  uint16_t *vetor = (uint16_t *)malloc((size_t)capacidade * sizeof(uint16_t));
+  if (vetor == NULL)
+    return;
+  int n = 0;
+  for (int p = 0; p < PALAVRAS_MAPA; p++)
+  {
+    uint64_t palavra = conteiner->bits[p];
+    while (palavra != 0)
+    {
+      vetor[n++] = (uint16_t)(p * 64 + __builtin_ctzll(palavra));
+      palavra &= palavra - 1;
+    }
+  }
+  free(conteiner->bits);
+  conteiner->bits = NULL;
+  conteiner->vetor = vetor;
+  conteiner->capacidade = capacidade;
+}
+
+/*
+ * Acrescenta um ID ao mapa.
+ *
+ * Como funciona:
+ * 1. Acha o contêiner dos 16 bits altos; se não existir, cria um vazio na
+ *    posição da chave, mantendo a lista em ordem
+ * 2. Num contêiner em mapa, liga o bit
+ * 3. Num contêiner em vetor, insere o valor na posição ordenada; se o
+ *    vetor já tiver LIMITE_VETOR_BITS valores, converte o contêiner em
+ *    mapa antes
+ */
+int marcarBit(MapaBits *mapa, int id)
+{
+  uint32_t valor = valorSemSinal(id);
+  uint16_t chave = (uint16_t)(valor >> 16);
+  uint16_t baixo = (uint16_t)valor;
+
+  int pos = procurarConteiner(mapa, chave);
+  if (pos == mapa->quantidade || mapa->conteineres[pos].chave != chave)
+  {
+    if (mapa->quantidade == mapa->capacidade)
+    {
+      int capacidade = mapa->capacidade > 0 ? mapa->capacidade * 2 : 4;
+      Conteiner *conteineres =
+          (Conteiner *)realloc(mapa->conteineres, (size_t)capacidade * sizeof(Conteiner));
+      if (conteineres == NULL)
+        return 0;
+      mapa->conteineres = conteineres;
+      mapa->capacidade = capacidade;
+    }
+    memmove(&mapa->conteineres[pos + 1], &mapa->conteineres[pos],
+            (size_t)(mapa->quantidade - pos) * sizeof(Conteiner));
+    memset(&mapa->conteineres[pos], 0, sizeof(Conteiner));
+    mapa->conteineres[pos].chave = chave;
+    mapa->quantidade++;
+  }
+
+  Conteiner *conteiner = &mapa->conteineres[pos];
+  if (conteiner->bits == NULL)
+  {
+    int i = procurarValor(conteiner, baixo);
+    if (i < conteiner->quantidade && conteiner->vetor[i] == baixo)
+      return 1;
+    if (conteiner->quantidade < LIMITE_VETOR_BITS)
+    {
+      if (conteiner->quantidade == conteiner->capacidade)
+      {
+        int capacidade = conteiner->capacidade > 0 ? conteiner->capacidade * 2 : 4;
+        uint16_t *vetor = (uint16_t *)realloc(conteiner->vetor, (size_t)capacidade * sizeof(uint16_t));
+        if (vetor == NULL)
+          return 0;
+        conteiner->vetor = vetor;
+        conteiner->capacidade = capacidade;
+      }
+      memmove(&conteiner->vetor[i + 1], &conteiner->vetor[i],
+              (size_t)(conteiner->quantidade - i) * sizeof(uint16_t));
+      conteiner->vetor[i] = baixo;
+      conteiner->quantidade++;
+      mapa->total++;
+      return 1;
+    }
+    if (!converterEmMapa(conteiner))
+      return 0;
+  }
+
+  uint64_t mascara = 1ULL << (baixo & 63);
+  if (conteiner->bits[baixo >> 6] & mascara)
+    return 1;
+  conteiner->bits[baixo >> 6] |= mascara;
+  conteiner->quantidade++;
+  mapa->total++;
+  return 1;
+}
+
+/*
+ * Retira um ID do mapa.
+ * Um contêiner em mapa que cai para metade de LIMITE_VETOR_BITS volta a
+ * ser vetor (a folga evita converter de novo a cada empréstimo e
+ * devolução perto do limite), e um contêiner vazio sai da lista.
+ */
+void desmarcarBit(MapaBits *mapa, int id)
+{
+  uint32_t valor = valorSemSinal(id);
+  uint16_t chave = (uint16_t)(valor >> 16);
+  uint16_t baixo = (uint16_t)valor;
+
+  int pos = procurarConteiner(mapa, chave);
+  if (pos == mapa->quantidade || mapa->conteineres[pos].chave != chave)
+    return;
+
+  Conteiner *conteiner = &mapa->conteineres[pos];
+  if (conteiner->bits != NULL)
+  {
+    uint64_t mascara = 1ULL << (baixo & 63);
+    if (!(conteiner->bits[baixo >> 6] & mascara))
+      return;
+    conteiner->bits[baixo >> 6] &= ~mascara;
+    conteiner->quantidade--;
+    if (conteiner->quantidade <= LIMITE_VETOR_BITS / 2)
+      converterEmVetor(conteiner);
+  }
+  else
+  {
+    int i = procurarValor(conteiner, baixo);
+    if (i == conteiner->quantidade || conteiner->vetor[i] != baixo)
+      return;
+    memmove(&conteiner->vetor[i], &conteiner->vetor[i + 1],
+            (size_t)(conteiner->quantidade - i - 1) * sizeof(uint16_t));
+    conteiner->quantidade--;
+  }
+  mapa->total--;
+
+  if (conteiner->quantidade == 0)
+  {
+    free(conteiner->vetor);
+    free(conteiner->bits);
+    memmove(&mapa->conteineres[pos], &mapa->conteineres[pos + 1],
+            (size_t)(mapa->quantidade - pos - 1) * sizeof(Conteiner));
+    mapa->quantidade--;
+  }
+}
+
+/*
+ * Procura um ID no mapa.
+ */
+int contemBit(const MapaBits *mapa, int id)
+{
+  uint32_t valor = valorSemSinal(id);
+  uint16_t chave = (uint16_t)(valor >> 16);
+  uint16_t baixo = (uint16_t)valor;
+
+  int pos = procurarConteiner(mapa, chave);
+  if (pos == mapa->quantidade || mapa->conteineres[pos].chave != chave)
+    return 0;
+  const Conteiner *conteiner = &mapa->conteineres[pos];
+  if (conteiner->bits != NULL)
+    return (conteiner->bits[baixo >> 6] >> (baixo & 63)) & 1;
+  int i = procurarValor(conteiner, baixo);
+  return i < conteiner->quantidade && conteiner->vetor[i] == baixo;
+}
+
+/*
+ * Máscara com os bits de `de` até `ate` (inclusive) de uma palavra.
+ */
+uint64_t mascaraBits(int de, int ate)
+{
+  uint64_t ateMascara = ate == 63 ? ~0ULL : (1ULL << (ate + 1)) - 1;
+  return ateMascara & ~((1ULL << de) - 1);
+}
+
+/*
+ * Conta os valores de um contêiner entre baixo e alto (inclusive).
+ * Num mapa, soma o popcount das palavras inteiras da faixa e das pontas
+ * com máscara.
+ */
+size_t contarConteiner(const Conteiner *conteiner, uint32_t baixo, uint32_t alto)
+{
+  if (baixo == 0 && alto == 0xFFFF)
+    return (size_t)conteiner->quantidade;
+  if (conteiner->bits == NULL)
+  {
+    int inicio = procurarValor(conteiner, (uint16_t)baixo);
+    int fim = alto == 0xFFFF ? conteiner->quantidade : procurarValor(conteiner, (uint16_t)(alto + 1));
+    return (size_t)(fim - inicio);
+  }
+
+  uint32_t primeira = baixo >> 6, ultima = alto >> 6;
+  if (primeira == ultima)
+    return (size_t)__builtin_popcountll(conteiner->bits[primeira] & mascaraBits(baixo & 63, alto & 63));
+  size_t total = (size_t)__builtin_popcountll(conteiner->bits[primeira] & mascaraBits(baixo & 63, 63));
+  for (uint32_t p = primeira + 1; p < ultima; p++)
+  {
+    total += (size_t)__builtin_popcountll(conteiner->bits[p]);
+  }
+  total += (size_t)__builtin_popcountll(conteiner->bits[ultima] & mascaraBits(0, alto & 63));
+  return total;
+}
+
+/*
+ * Conta os IDs de uma faixa, contêiner por contêiner.
+ */
+size_t contarBitsFaixa(const MapaBits *mapa, int primeiro, int ultimo)
+{
+  if (primeiro > ultimo)
+    return 0;
+  uint32_t de = valorSemSinal(primeiro), ate = valorSemSinal(ultimo);
+  size_t total = 0;
+  for (int pos = procurarConteiner(mapa, (uint16_t)(de >> 16));
+       pos < mapa->quantidade && mapa->conteineres[pos].chave <= (ate >> 16); pos++)
+  {
+    const Conteiner *conteiner = &mapa->conteineres[pos];
+    uint32_t base = (uint32_t)conteiner->chave << 16;
+    uint32_t baixo = de > base ? de - base : 0;
+    uint32_t alto = ate - base < 0xFFFF ? ate - base : 0xFFFF;
+    total += contarConteiner(conteiner, baixo, alto);
+  }
+  return total;
+}
+
+/*
+ * Visita os IDs de uma faixa.
+ * Num contêiner em mapa, cada palavra de 64 bits é lida de uma vez: a
+ * contagem de zeros à direita dá o próximo bit ligado, e `palavra &=
+ * palavra - 1` o desliga, então palavras vazias custam uma comparação só.
+ */
+int percorrerBits(const MapaBits *mapa, int primeiro, int ultimo, VisitarBit visitar, void *contexto)
+{
+  if (primeiro > ultimo)
+    return 1;
+  uint32_t de = valorSemSinal(primeiro), ate = valorSemSinal(ultimo);
+  for (int pos = procurarConteiner(mapa, (uint16_t)(de >> 16));
+       pos < mapa->quantidade && mapa->conteineres[pos].chave <= (ate >> 16); pos++)
+  {
+    const Conteiner *conteiner = &mapa->conteineres[pos];
+    uint32_t base = (uint32_t)conteiner->chave << 16;
+    uint32_t baixo = de > base ? de - base : 0;
+    uint32_t alto = ate - base < 0xFFFF ? ate - base : 0xFFFF;
+
+    if (conteiner->bits == NULL)
+    {
+      for (int i = procurarValor(conteiner, (uint16_t)baixo);
+           i < conteiner->quantidade && conteiner->vetor[i] <= alto; i++)
+      {
+        if (!visitar(idDoValor(base | conteiner->vetor[i]), contexto))
+          return 0;
+      }
+      continue;
+    }
+
+    for (uint32_t p = baixo >> 6; p <= alto >> 6; p++)
+    {
+      uint64_t palavra = conteiner->bits[p];
+      if (p == baixo >> 6)
+        palavra &= mascaraBits(baixo & 63, 63);
+      if (p == alto >> 6)
+        palavra &= mascaraBits(0, alto & 63);
+      while (palavra != 0)
+      {
+        if (!visitar(idDoValor(base | (p * 64 + (uint32_t)__builtin_ctzll(palavra))), contexto))
+          return 0;
+        palavra &= palavra - 1;
+      }
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,101 @@
+/*
+ * mapabits.h
+ *
+ * Este arquivo contém as definições do mapa de bits comprimido usado pelas
+ * duas implementações da biblioteca para guardar o conjunto dos IDs dos
+ * livros disponíveis. Com ele, contar os disponíveis (no total ou numa
+ * faixa de IDs) é somar bits, e não visitar cada livro.
+ *
+ * O mapa segue a ideia dos "roaring bitmaps": os IDs são divididos em
+ * contêineres de 65.536 IDs seguidos (os 16 bits altos escolhem o
+ * contêiner e os 16 baixos, a posição dentro dele). Um contêiner com
+ * poucos IDs guarda um vetor ordenado dos 16 bits baixos (2 bytes por
+ * ID); quando passa de LIMITE_VETOR_BITS, vira um mapa de 65.536 bits
+ * (8 KB), que é menor a partir daí. Os contêineres vazios não existem,
+ * então IDs espalhados não gastam memória com os intervalos entre eles.
+ *
+ * Os mapas contam os bits de 64 em 64 (popcount) e, para percorrer os IDs,
+ * acham cada bit ligado com a contagem de zeros à direita, uma palavra de
+ * 64 bits por vez.
+ */
+
+#ifndef MAPABITS_H
+#define MAPABITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LIMITE_VETOR_BITS 4096 // IDs a partir dos quais o contêiner vira mapa de bits
+#define PALAVRAS_MAPA 1024     // Palavras de 64 bits de um contêiner em mapa
+
+/*
+ * Contêiner com os IDs cujos 16 bits altos são `chave`.
+ * Só um de vetor e bits é usado, conforme o tamanho.
+ */
+typedef struct
+{
+  uint16_t chave;  // 16 bits altos dos IDs do contêiner
+  int quantidade;  // IDs no contêiner
+  int capacidade;  // Tamanho alocado do vetor (0 quando o contêiner é um mapa)
+  uint16_t *vetor; // 16 bits baixos dos IDs, em ordem (contêiner pequeno)
+  uint64_t *bits;  // Mapa de PALAVRAS_MAPA palavras (contêiner grande)
+} Conteiner;
+
+/*
+ * Mapa de bits comprimido: os contêineres não vazios, em ordem de chave.
+ */
+typedef struct
+{
+  Conteiner *conteineres; // Contêineres em ordem de chave
+  int quantidade;         // Contêineres em uso
+  int capacidade;         // Tamanho alocado do vetor de contêineres
+  size_t total;           // IDs no mapa
+} MapaBits;
+
+/*
+ * Função chamada para cada ID por percorrerBits.
+ * Retorna 0 para interromper o percurso.
+ */
+typedef int (*VisitarBit)(int id, void *contexto);
+
+/*
+ * Inicializa um mapa vazio.
+ */
+void iniciarMapa(MapaBits *mapa);
+
+/*
+ * Libera todos os contêineres.
+ */
+void liberarMapa(MapaBits *mapa);
+
+/*
+ * Acrescenta um ID ao mapa (não faz nada se já estiver nele).
+ * Retorna 0 se não houver memória (o mapa continua válido, sem o ID).
+ */
+int marcarBit(MapaBits *mapa, int id);
+
+/*
+ * Retira um ID do mapa, se estiver nele.
+ */
+void desmarcarBit(MapaBits *mapa, int id);
+
+/*
+ * Retorna 1 se o ID estiver no mapa.
+ */
+int contemBit(const MapaBits *mapa, int id);
+
+/*
+ * Conta os IDs do mapa entre primeiro e ultimo (inclusive). Os contêineres
+ * inteiros dentro da faixa são contados pelo campo quantidade, sem olhar
+ * os bits.
+ */
+size_t contarBitsFaixa(const MapaBits *mapa, int primeiro, int ultimo);
+
+/*
+ * Visita, em ordem crescente, os IDs do mapa entre primeiro e ultimo
+ * (inclusive). O mapa não pode ser alterado durante a visita.
+ * Retorna 0 se a visita for interrompida.
+ */
+int percorrerBits(const MapaBits *mapa, int primeiro, int ultimo, VisitarBit visitar, void *contexto);
+
+#endif
@@ -0,0 +1,612 @@
+/*
+ * palavras.c
+ *
+ * Implementação do índice de palavras.
+ * Este arquivo contém todas as funções declaradas em palavras.h.
+ */
+
+#include "palavras.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACIDADE_INICIAL_PALAVRAS 1024 // Posições alocadas na primeira palavra
+#define PESO_TITULO 2.0                  // Peso de uma palavra achada no título
+#define PESO_AUTOR 1.0                   // Peso de uma palavra achada só no autor
+
+/*
+ * Letras sem acento para os caracteres de U+00C0 a U+00FF (em UTF-8, 0xC3
+ * seguido de 0x80 a 0xBF). Um espaço marca os que não são letras (× e ÷).
+ */
+const char letrasSemAcento[64] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                 "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarPalavras(IndicePalavras *indice)
+{
+  indice->entradas = NULL;
+  indice->capacidade = 0;
+  indice->quantidade = 0;
+  iniciarArena(&indice->textos);
+  indice->livros = 0;
+  indice->removidos = 0;
+}
+
+/*
+ * Libera os vetores de cada lista, a tabela e as palavras.
+ */
+void liberarPalavras(IndicePalavras *indice)
+{
+  for (size_t i = 0; i < indice->capacidade; i++)
+  {
+    ListaPalavra *lista = &indice->entradas[i].lista;
+    free(lista->dados);
+    free(lista->primeiros);
+    free(lista->inicios);
+    free(lista->pendentes);
+  }
+  free(indice->entradas);
+  liberarArena(&indice->textos);
+  iniciarPalavras(indice);
+}
+
+/*
+ * Normaliza o caractere que começa em p.
+ * Grava em *avanco quantos bytes ele ocupa e retorna a letra ou o dígito
+ * normalizado, ou 0 se for um separador. A pontuação do Latin-1 e a de
+ * U+2000 a U+203F separam palavras; os bytes de outros caracteres UTF-8
+ * fazem parte da palavra sem mudança.
+ */
+char normalizarCaractere(const char *p, const char *fim, size_t *avanco)
+{
+  unsigned char c = (unsigned char)p[0];
+  *avanco = 1;
+  if (c >= 'A' && c <= 'Z')
+    return (char)(c - 'A' + 'a');
+  if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+    return (char)c;
+  if (c == 0xC3 && p + 1 < fim && ((unsigned char)p[1] & 0xC0) == 0x80)
+  {
+    *avanco = 2;
+    char letra = letrasSemAcento[(unsigned char)p[1] - 0x80];
+    return letra != ' ' ? letra : 0;
+  }
+  if (c == 0xC2 && p + 1 < fim)
+  {
+    *avanco = 2; // U+0080 a U+00BF: espaço rígido, «, », ¿, º...
+    return 0;
+  }
+  if (c == 0xE2 && p + 2 < fim && (unsigned char)p[1] == 0x80)
+  {
+    *avanco = 3; // U+2000 a U+203F: travessões, aspas curvas, reticências...
+    return 0;
+  }
+  return c >= 0x80 ? (char)c : 0;
+}
+
+/*
+ * Lê a próxima palavra: pula os separadores e junta os caracteres
+ * normalizados até o próximo separador.
+ */
+size_t lerPalavra(const char **cursor, const char *fim, char *palavra)
+{
+  const char *p = *cursor;
+  size_t tamanho = 0;
+  size_t avanco;
+  char c = 0;
+  while (p < fim && (c = normalizarCaractere(p, fim, &avanco)) == 0)
+  {
+    p += avanco;
+  }
+  while (p < fim && c != 0)
+  {
+    if (tamanho < TAMANHO_MAXIMO_PALAVRA)
+      palavra[tamanho++] = c;
+    p += avanco;
+    if (p < fim)
+      c = normalizarCaractere(p, fim, &avanco);
+  }
+  *cursor = p;
+  return tamanho;
+}
+
+/*
+ * Hash de uma palavra: FNV-1a de 32 bits, byte a byte.
+ */
+uint32_t hashPalavra(const char *palavra, size_t tamanho)
+{
+  uint32_t hash = 0x811C9DC5u;
+  for (size_t i = 0; i < tamanho; i++)
+  {
+    hash = (hash ^ (uint8_t)palavra[i]) * 0x01000193u;
+  }
+  return hash;
+}
+
+/*
+ * Retorna a posição de uma palavra na tabela ou a posição vazia onde a
+ * sondagem parou. A tabela não pode estar vazia.
+ */
+EntradaPalavra *procurarPalavra(const IndicePalavras *indice, const char *palavra, size_t tamanho,
+                                uint32_t hash)
+{
+  size_t mascara = indice->capacidade - 1;
+  size_t pos = hash & mascara;
+  while (indice->entradas[pos].palavra != NULL)
+  {
+    EntradaPalavra *entrada = &indice->entradas[pos];
+    if (entrada->hash == hash && tamanhoTexto(entrada->palavra) == tamanho &&
+        memcmp(entrada->palavra, palavra, tamanho) == 0)
+      return entrada;
+    pos = (pos + 1) & mascara;
+  }
+  return &indice->entradas[pos];
+}
+
+/*
+ * Dobra a tabela (ou aloca a inicial), movendo as entradas pelo hash
+ * guardado. Retorna 0 se não houver memória (a tabela antiga é mantida).
+ */
+int crescerPalavras(IndicePalavras *indice)
+{
+  size_t capacidade = indice->capacidade > 0 ? indice->capacidade * 2 : CAPACIDADE_INICIAL_PALAVRAS;
+  EntradaPalavra *entradas = (EntradaPalavra *)calloc(capacidade, sizeof(EntradaPalavra));
+  if (entradas == NULL)
+    return 0;
+
+  for (size_t i = 0; i < indice->capacidade; i++)
+  {
+    EntradaPalavra *antiga = &indice->entradas[i];
+    if (antiga->palavra != NULL)
+    {
+      size_t pos = antiga->hash & (capacidade - 1);
+      while (entradas[pos].palavra != NULL)
+      {
+        pos = (pos + 1) & (capacidade - 1);
+      }
+      entradas[pos] = *antiga;
+    }
+  }
+  free(indice->entradas);
+  indice->entradas = entradas;
+  indice->capacidade = capacidade;
+  return 1;
+}
+
+/*
+ * Acrescenta um ID ao fim da parte comprimida de uma lista. O ID precisa
+ * ser maior que o último. A cada IDS_POR_BLOCO IDs começa um bloco novo,
+ * cujo primeiro ID vai para a tabela de saltos; os outros são gravados
+ * como a diferença para o anterior, em varint (7 bits por byte, com o bit
+ * mais alto indicando que há mais bytes).
+ */
+int comprimirId(ListaPalavra *lista, int id)
+{
+  if (lista->quantidade % IDS_POR_BLOCO == 0)
+  {
+    if (lista->blocos == lista->capacidadeBlocos)
+    {
+      int capacidade = lista->capacidadeBlocos > 0 ? lista->capacidadeBlocos * 2 : 1;
+      int *primeiros = (int *)realloc(lista->primeiros, (size_t)capacidade * sizeof(int));
+      if (primeiros == NULL)
+        return 0;
+      lista->primeiros = primeiros;
+      uint32_t *inicios = (uint32_t *)realloc(lista->inicios, (size_t)capacidade * sizeof(uint32_t));
+      if (inicios == NULL)
+        return 0;
+      lista->inicios = inicios;
+      lista->capacidadeBlocos = capacidade;
+    }
+    lista->primeiros[lista->blocos] = id;
+    lista->inicios[lista->blocos] = (uint32_t)lista->tamanho;
+    lista->blocos++;
+  }
+  else
+  {
+    if (lista->capacidade - lista->tamanho < 5)
+    {
+      size_t capacidade = lista->capacidade > 0 ? lista->capacidade * 2 : 16;
+      uint8_t *dados = (uint8_t *)realloc(lista->dados, capacidade);
+      if (dados == NULL)
+        return 0;
+      lista->dados = dados;
+      lista->capacidade = capacidade;
+    }
+    uint32_t diferenca = (uint32_t)id - (uint32_t)lista->ultimo;
+    while (diferenca >= 0x80)
+    {
+      lista->dados[lista->tamanho++] = (uint8_t)(diferenca | 0x80);
+      diferenca >>= 7;
+    }
+    lista->dados[lista->tamanho++] = (uint8_t)diferenca;
+  }
+  lista->ultimo = id;
+  lista->quantidade++;
+  return 1;
+}
+
+/*
+ * Decodifica um bloco da lista em ids (com espaço para IDS_POR_BLOCO).
+ * Retorna a quantidade de IDs do bloco.
+ */
+int decodificarBloco(const ListaPalavra *lista, int bloco, int *ids)
+{
+  int quantidade = lista->quantidade - bloco * IDS_POR_BLOCO;
+  if (quantidade > IDS_POR_BLOCO)
+    quantidade = IDS_POR_BLOCO;
+  const uint8_t *p = quantidade > 1 ? lista->dados + lista->inicios[bloco] : NULL;
+  int id = lista->primeiros[bloco];
+  ids[0] = id;
+  for (int i = 1; i < quantidade; i++)
+  {
+    uint32_t diferenca = 0;
+    int deslocamento = 0;
+    uint8_t byte;
+    do
+    {
+      byte = *p++;
+      diferenca |= (uint32_t)(byte & 0x7F) << deslocamento;
+      deslocamento += 7;
+    } while (byte & 0x80);
+    id = (int)((uint32_t)id + diferenca);
+    ids[i] = id;
+  }
+  return quantidade;
+}
+
+/*
+ * Acrescenta um ID à lista de uma palavra.
+ * Os IDs de um livro são acrescentados em sequência, então um ID igual ao
+ * último acrescentado é a mesma palavra repetida no livro e é ignorado.
+ */
+int acrescentarId(ListaPalavra *lista, int id)
+{
+  if (lista->quantidadePendentes > 0)
+  {
+    if (lista->pendentes[lista->quantidadePendentes - 1] == id)
+      return 1;
+  }
+  else if (lista->quantidade > 0 && lista->ultimo == id)
+  {
+    return 1;
+  }
+  if (lista->quantidadePendentes == 0 && (lista->quantidade == 0 || lista->ultimo < id))
+    return comprimirId(lista, id);
+
+  if (lista->quantidadePendentes == lista->capacidadePendentes)
+  {
+    int capacidade = lista->capacidadePendentes > 0 ? lista->capacidadePendentes * 2 : 4;
+    int *pendentes = (int *)realloc(lista->pendentes, (size_t)capacidade * sizeof(int));
+    if (pendentes == NULL)
+      return 0;
+    lista->pendentes = pendentes;
+    lista->capacidadePendentes = capacidade;
+  }
+  lista->pendentes[lista->quantidadePendentes++] = id;
+  return 1;
+}
+
+/*
+ * Compara dois IDs (para o qsort).
+ */
+int compararPendentes(const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Intercala os pendentes com a parte comprimida da lista.
+ *
+ * Como funciona:
+ * 1. Decodifica a lista inteira num vetor e ordena os pendentes
+ * 2. Zera a parte comprimida, mantendo a memória alocada
+ * 3. Comprime de novo a intercalação dos dois vetores, sem repetir IDs
+ */
+int consolidarLista(ListaPalavra *lista)
+{
+  if (lista->quantidadePendentes == 0)
+    return 1;
+
+  int quantidade = lista->quantidade;
+  int *ids = (int *)malloc(((size_t)quantidade + IDS_POR_BLOCO) * sizeof(int));
+  if (ids == NULL)
+    return 0;
+  for (int b = 0; b < lista->blocos; b++)
+  {
+    decodificarBloco(lista, b, ids + b * IDS_POR_BLOCO);
+  }
+  qsort(lista->pendentes, (size_t)lista->quantidadePendentes, sizeof(int), compararPendentes);
+
+  lista->tamanho = 0;
+  lista->blocos = 0;
+  lista->quantidade = 0;
+  int i = 0, j = 0, ok = 1;
+  while (ok && (i < quantidade || j < lista->quantidadePendentes))
+  {
+    int id;
+    if (j == lista->quantidadePendentes || (i < quantidade && ids[i] <= lista->pendentes[j]))
+      id = ids[i++];
+    else
+      id = lista->pendentes[j++];
+    if (lista->quantidade == 0 || lista->ultimo < id)
+      ok = comprimirId(lista, id);
+  }
+  free(ids);
+  if (ok)
+    lista->quantidadePendentes = 0;
+  return ok;
+}
+
+/*
+ * Acrescenta o ID às listas das palavras de um texto.
+ */
+int adicionarTexto(IndicePalavras *indice, const char *texto, int id)
+{
+  const char *cursor = texto;
+  const char *fim = texto + tamanhoTexto(texto);
+  char palavra[TAMANHO_MAXIMO_PALAVRA];
+  size_t tamanho;
+  while ((tamanho = lerPalavra(&cursor, fim, palavra)) > 0)
+  {
+    uint32_t hash = hashPalavra(palavra, tamanho);
+    if (indice->quantidade + 1 >= indice->capacidade / 4 * 3 && !crescerPalavras(indice))
+      return 0;
+    EntradaPalavra *entrada = procurarPalavra(indice, palavra, tamanho, hash);
+    if (entrada->palavra == NULL)
+    {
+      const char *copia = guardarTexto(&indice->textos, palavra, tamanho);
+      if (copia == NULL)
+        return 0;
+      entrada->palavra = copia;
+      entrada->hash = hash;
+      indice->quantidade++;
+    }
+    if (!acrescentarId(&entrada->lista, id))
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * Acrescenta um livro ao índice.
+ */
+int adicionarPalavras(IndicePalavras *indice, const char *titulo, const char *autor, int id)
+{
+  if (!adicionarTexto(indice, titulo, id) || !adicionarTexto(indice, autor, id))
+    return 0;
+  indice->livros++;
+  return 1;
+}
+
+/*
+ * Conta a remoção de um livro.
+ */
+void removerPalavras(IndicePalavras *indice)
+{
+  indice->livros--;
+  indice->removidos++;
+}
+
+/*
+ * Quebra a consulta em palavras.
+ * O peso de cada palavra é log(1 + N / n), com N livros no índice e n
+ * livros na lista da palavra: uma palavra que está em quase todos os
+ * livros pesa pouco. Uma palavra que não está no índice fica com n = 0.
+ */
+int prepararConsulta(const IndicePalavras *indice, const char *texto, ConsultaPalavras *consulta)
+{
+  const char *cursor = texto;
+  const char *fim = texto + strlen(texto);
+  consulta->quantidade = 0;
+  while (consulta->quantidade < MAX_TERMOS_CONSULTA)
+  {
+    int q = consulta->quantidade;
+    size_t tamanho = lerPalavra(&cursor, fim, consulta->termos[q]);
+    if (tamanho == 0)
+      break;
+
+    int repetida = 0;
+    for (int i = 0; i < q && !repetida; i++)
+    {
+      repetida = consulta->tamanhos[i] == tamanho &&
+                 memcmp(consulta->termos[i], consulta->termos[q], tamanho) == 0;
+    }
+    if (repetida)
+      continue;
+
+    int livros = 0;
+    if (indice->quantidade > 0)
+    {
+      const EntradaPalavra *entrada =
+          procurarPalavra(indice, consulta->termos[q], tamanho, hashPalavra(consulta->termos[q], tamanho));
+      if (entrada->palavra != NULL)
+        livros = entrada->lista.quantidade + entrada->lista.quantidadePendentes;
+    }
+    consulta->tamanhos[q] = tamanho;
+    consulta->pesos[q] = log(1.0 + (double)indice->livros / (livros + 1));
+    consulta->quantidade++;
+  }
+  return consulta->quantidade;
+}
+
+/*
+ * Cursor sobre uma lista, para procurar IDs em ordem crescente.
+ * Guarda o bloco atual já decodificado.
+ */
+typedef struct
+{
+  const ListaPalavra *lista; // Lista percorrida
+  int bloco;                 // Bloco atual
+  int decodificado;          // Bloco que está em ids (-1 se nenhum)
+  int quantidade;            // IDs do bloco decodificado
+  int ids[IDS_POR_BLOCO];    // IDs do bloco decodificado
+} CursorLista;
+
+/*
+ * Procura um ID na lista, a partir do bloco atual do cursor. Os IDs
+ * procurados precisam vir em ordem crescente.
+ *
+ * Como funciona:
+ * 1. Busca galopante nos primeiros IDs dos blocos: dá saltos de 1, 2, 4,
+ *    ... blocos até passar do ID, e faz busca binária no último salto
+ * 2. Decodifica o bloco encontrado, se não for o que já está no cursor
+ * 3. Busca binária dentro do bloco
+ *
+ * Como os IDs procurados crescem, o cursor nunca volta, e procurar os k
+ * IDs da menor lista numa lista com n IDs custa O(k log(n / k)) saltos.
+ */
+int contemId(CursorLista *cursor, int id)
+{
+  const ListaPalavra *lista = cursor->lista;
+  int atual = cursor->bloco;
+  if (atual >= lista->blocos || lista->primeiros[atual] > id)
+    return 0;
+
+  int salto = 1;
+  while (atual + salto < lista->blocos && lista->primeiros[atual + salto] <= id)
+  {
+    atual += salto;
+    salto *= 2;
+  }
+  int baixo = atual, alto = atual + salto < lista->blocos ? atual + salto : lista->blocos;
+  while (alto - baixo > 1)
+  {
+    int meio = baixo + (alto - baixo) / 2;
+    if (lista->primeiros[meio] <= id)
+      baixo = meio;
+    else
+      alto = meio;
+  }
+  cursor->bloco = baixo;
+
+  if (cursor->decodificado != baixo)
+  {
+    cursor->quantidade = decodificarBloco(lista, baixo, cursor->ids);
+    cursor->decodificado = baixo;
+  }
+  int inicio = 0, fim = cursor->quantidade;
+  while (inicio < fim)
+  {
+    int meio = inicio + (fim - inicio) / 2;
+    if (cursor->ids[meio] < id)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio < cursor->quantidade && cursor->ids[inicio] == id;
+}
+
+/*
+ * Intersecção das listas das palavras da consulta.
+ *
+ * Como funciona:
+ * 1. Acha a lista de cada palavra; se alguma faltar, nenhum livro tem
+ *    todas
+ * 2. Consolida os pendentes de cada lista e ordena as listas pelo tamanho
+ * 3. Decodifica a menor lista inteira e procura cada ID dela nas outras,
+ *    da menor para a maior, com contemId, mantendo só os que estão em
+ *    todas; assim as listas grandes só são consultadas com os poucos IDs
+ *    que sobraram das pequenas
+ */
+int intersectarPalavras(IndicePalavras *indice, const ConsultaPalavras *consulta, VetorIds *ids)
+{
+  if (consulta->quantidade == 0 || indice->quantidade == 0)
+    return 1;
+
+  // Listas em ordem crescente de tamanho (inserção ordenada)
+  ListaPalavra *listas[MAX_TERMOS_CONSULTA];
+  for (int i = 0; i < consulta->quantidade; i++)
+  {
+    EntradaPalavra *entrada = procurarPalavra(indice, consulta->termos[i], consulta->tamanhos[i],
+                                              hashPalavra(consulta->termos[i], consulta->tamanhos[i]));
+    if (entrada->palavra == NULL)
+      return 1;
+    if (!consolidarLista(&entrada->lista))
+      return 0;
+    int j = i;
+    while (j > 0 && listas[j - 1]->quantidade > entrada->lista.quantidade)
+    {
+      listas[j] = listas[j - 1];
+      j--;
+    }
+    listas[j] = &entrada->lista;
+  }
+
+  int bloco[IDS_POR_BLOCO];
+  for (int b = 0; b < listas[0]->blocos; b++)
+  {
+    int quantidade = decodificarBloco(listas[0], b, bloco);
+    for (int i = 0; i < quantidade; i++)
+    {
+      if (!adicionarId(ids, bloco[i]))
+        return 0;
+    }
+  }
+
+  for (int t = 1; t < consulta->quantidade && ids->quantidade > 0; t++)
+  {
+    CursorLista cursor;
+    cursor.lista = listas[t];
+    cursor.bloco = 0;
+    cursor.decodificado = -1;
+    cursor.quantidade = 0;
+    size_t mantidos = 0;
+    for (size_t i = 0; i < ids->quantidade; i++)
+    {
+      if (contemId(&cursor, ids->itens[i]))
+        ids->itens[mantidos++] = ids->itens[i];
+    }
+    ids->quantidade = mantidos;
+  }
+  return 1;
+}
+
+/*
+ * Marca em achadas as palavras da consulta que aparecem no texto e
+ * retorna quantas palavras o texto tem.
+ */
+int marcarPalavras(const ConsultaPalavras *consulta, const char *texto, int *achadas)
+{
+  const char *cursor = texto;
+  const char *fim = texto + tamanhoTexto(texto);
+  char palavra[TAMANHO_MAXIMO_PALAVRA];
+  size_t tamanho;
+  int palavras = 0;
+  while ((tamanho = lerPalavra(&cursor, fim, palavra)) > 0)
+  {
+    palavras++;
+    for (int i = 0; i < consulta->quantidade; i++)
+    {
+      if (consulta->tamanhos[i] == tamanho && memcmp(consulta->termos[i], palavra, tamanho) == 0)
+        achadas[i] = 1;
+    }
+  }
+  return palavras;
+}
+
+/*
+ * Pontua um livro para a consulta.
+ */
+double pontuarLivro(const ConsultaPalavras *consulta, const char *titulo, const char *autor)
+{
+  int noTitulo[MAX_TERMOS_CONSULTA] = {0};
+  int noAutor[MAX_TERMOS_CONSULTA] = {0};
+  int palavras = marcarPalavras(consulta, titulo, noTitulo) + marcarPalavras(consulta, autor, noAutor);
+
+  double pontos = 0.0;
+  for (int i = 0; i < consulta->quantidade; i++)
+  {
+    if (noTitulo[i])
+      pontos += PESO_TITULO * consulta->pesos[i];
+    else if (noAutor[i])
+      pontos += PESO_AUTOR * consulta->pesos[i];
+    else
+      return -1.0;
+  }
+  return palavras > 0 ? pontos / sqrt((double)palavras) : pontos;
+}
@@ -0,0 +1,155 @@
+/*
+ * palavras.h
+ *
+ * Este arquivo contém as definições do índice de palavras (índice
+ * invertido) usado pelas duas implementações da biblioteca, para buscas
+ * por palavras do título e do autor, como "Tolkien anéis".
+ *
+ * Os textos são quebrados em palavras nos caracteres que não são letras
+ * nem dígitos. Cada palavra é normalizada: as letras ficam minúsculas e os
+ * acentos das letras do português (e das outras letras latinas do
+ * Latin-1, em UTF-8) são retirados, então "Anéis", "ANEIS" e "aneis" são a
+ * mesma palavra.
+ *
+ * Cada palavra leva a uma lista com os IDs dos livros que a contêm no
+ * título ou no autor. A lista guarda os IDs em ordem crescente, em blocos
+ * de IDS_POR_BLOCO, com a diferença para o ID anterior gravada em varint
+ * (um byte para diferenças menores que 128); o primeiro ID de cada bloco
+ * fica num vetor à parte, que serve de tabela de saltos. Na busca, os IDs
+ * da menor lista são procurados nas outras com busca galopante nessa
+ * tabela, e só os blocos onde eles podem estar são decodificados.
+ *
+ * Um ID menor que o último da lista não pode ser acrescentado ao fim: ele
+ * espera num vetor de pendentes, que é intercalado com a lista na próxima
+ * busca que a usar. Como no índice de títulos, os livros removidos ficam
+ * nas listas até o índice ser remontado, e quem busca confere cada livro
+ * encontrado com pontuarLivro.
+ */
+
+#ifndef PALAVRAS_H
+#define PALAVRAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "titulos.h"
+
+#define TAMANHO_MAXIMO_PALAVRA 48 // Bytes guardados de cada palavra (o resto é ignorado)
+#define MAX_TERMOS_CONSULTA 16    // Palavras distintas consideradas numa consulta
+#define IDS_POR_BLOCO 128         // IDs em cada bloco de uma lista
+
+/*
+ * Lista de IDs de uma palavra, comprimida em blocos.
+ */
+typedef struct
+{
+  uint8_t *dados;          // Diferenças entre IDs seguidos, em varint
+  size_t tamanho;          // Bytes usados em dados
+  size_t capacidade;       // Bytes alocados em dados
+  int *primeiros;          // Primeiro ID de cada bloco (não está em dados)
+  uint32_t *inicios;       // Byte de dados onde cada bloco começa
+  int blocos;              // Blocos na lista
+  int capacidadeBlocos;    // Tamanho alocado de primeiros e inicios
+  int quantidade;          // IDs comprimidos
+  int ultimo;              // Maior ID comprimido
+  int *pendentes;          // IDs que chegaram fora de ordem
+  int quantidadePendentes; // IDs em pendentes
+  int capacidadePendentes; // Tamanho alocado de pendentes
+} ListaPalavra;
+
+/*
+ * Posição da tabela de palavras.
+ * Uma posição com palavra NULL está vazia.
+ */
+typedef struct
+{
+  const char *palavra; // Palavra normalizada (na arena do índice)
+  uint32_t hash;       // Hash da palavra
+  ListaPalavra lista;  // Livros que contêm a palavra
+} EntradaPalavra;
+
+/*
+ * Índice invertido de palavras.
+ * A tabela usa endereçamento aberto, com capacidade potência de 2, e
+ * cresce antes de passar de 3/4 de ocupação.
+ */
+typedef struct
+{
+  EntradaPalavra *entradas; // Tabela (NULL enquanto o índice está vazio)
+  size_t capacidade;        // Posições da tabela
+  size_t quantidade;        // Palavras distintas
+  Arena textos;             // Cópias normalizadas das palavras
+  size_t livros;            // Livros no índice
+  size_t removidos;         // Livros removidos ainda presentes nas listas
+} IndicePalavras;
+
+/*
+ * Consulta já quebrada em palavras, com o peso de cada uma.
+ */
+typedef struct
+{
+  char termos[MAX_TERMOS_CONSULTA][TAMANHO_MAXIMO_PALAVRA]; // Palavras normalizadas
+  size_t tamanhos[MAX_TERMOS_CONSULTA];                     // Bytes de cada palavra
+  double pesos[MAX_TERMOS_CONSULTA];                        // Raridade de cada palavra (idf)
+  int quantidade;                                           // Palavras na consulta
+} ConsultaPalavras;
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarPalavras(IndicePalavras *indice);
+
+/*
+ * Libera a tabela, as listas e as palavras.
+ */
+void liberarPalavras(IndicePalavras *indice);
+
+/*
+ * Lê a próxima palavra de um texto a partir de *cursor, sem passar de fim.
+ * Grava em palavra (com pelo menos TAMANHO_MAXIMO_PALAVRA bytes, sem '\0')
+ * a palavra normalizada e avança o cursor para depois dela.
+ * Retorna o tamanho da palavra ou 0 se o texto acabou.
+ */
+size_t lerPalavra(const char **cursor, const char *fim, char *palavra);
+
+/*
+ * Acrescenta um livro ao índice: cada palavra do título e do autor (no
+ * formato da arena) ganha o ID na sua lista.
+ * Retorna 0 se não houver memória; o índice fica só com parte do livro e
+ * deve ser descartado.
+ */
+int adicionarPalavras(IndicePalavras *indice, const char *titulo, const char *autor, int id);
+
+/*
+ * Conta a remoção de um livro. As listas não mudam.
+ */
+void removerPalavras(IndicePalavras *indice);
+
+/*
+ * Quebra o texto de uma consulta em palavras, sem repetir palavras, e
+ * calcula o peso de cada uma: quanto menos livros têm a palavra, maior o
+ * peso.
+ * Retorna a quantidade de palavras (0 se a consulta não tiver nenhuma).
+ */
+int prepararConsulta(const IndicePalavras *indice, const char *texto, ConsultaPalavras *consulta);
+
+/*
+ * Junta em ids, em ordem crescente, os IDs que estão nas listas de todas
+ * as palavras da consulta. Podem vir livros já removidos ou que mudaram;
+ * quem chama confere cada um com pontuarLivro.
+ * Retorna 0 se não houver memória.
+ */
+int intersectarPalavras(IndicePalavras *indice, const ConsultaPalavras *consulta, VetorIds *ids);
+
+/*
+ * Pontua um livro para a consulta: soma o peso de cada palavra, em dobro
+ * quando ela está no título, e divide pela raiz da quantidade de palavras
+ * do livro, para que um título curto que contém as palavras fique na
+ * frente de um longo.
+ * Retorna um valor negativo se alguma palavra da consulta não estiver no
+ * título nem no autor.
+ */
+double pontuarLivro(const ConsultaPalavras *consulta, const char *titulo, const char *autor);
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * pool.c
+ *
+ * Implementação do pool de nós de tamanho fixo.
+ * Este arquivo contém todas as funções declaradas em pool.h.
+ */
+
+#include "pool.h"
+
+#include <stdlib.h>
+
+/*
+ * Inicializa um pool vazio.
+ * O tamanho do nó é arredondado para múltiplo de 8 (alinhamento dos
+ * ponteiros) e nunca é menor que um ponteiro, que a lista de livres usa.
+ */
+void iniciarPool(PoolNos *pool, size_t tamanhoNo)
+{
+  if (tamanhoNo < sizeof(void *))
+    tamanhoNo = sizeof(void *);
+  pool->tamanhoNo = (tamanhoNo + 7) & ~(size_t)7;
+  pool->blocos = NULL;
+  pool->livres = NULL;
+  pool->ativos = 0;
+}
+
+/*
+ * Retorna um nó livre do pool.
+ *
+ * Como funciona:
+ * 1. Se houver nó devolvido, retira o primeiro da lista de livres
+ * 2. Senão, recorta o próximo nó do bloco atual
+ * 3. Se o bloco atual estiver cheio, aloca um novo bloco
+ */
+void *alocarNo(PoolNos *pool)
+{
+  void *no;
+
+  if (pool->livres != NULL)
+  {
+    no = pool->livres;
+    pool->livres = *(void **)no;
+  }
+  else
+  {
+    BlocoPool *bloco = pool->blocos;
+    if (bloco == NULL || bloco->usados == NOS_POR_BLOCO)
+    {
+      bloco = (BlocoPool *)malloc(sizeof(BlocoPool) + NOS_POR_BLOCO * pool->tamanhoNo);
+      if (bloco == NULL)
+        return NULL;
+      bloco->usados = 0;
+      bloco->prox = pool->blocos;
+      pool->blocos = bloco;
+    }
+    no = bloco->dados + bloco->usados * pool->tamanhoNo;
+    bloco->usados++;
+  }
+
+  pool->ativos++;
+  return no;
+}
+
+/*
+ * Devolve um nó ao pool.
+ * O nó passa a ser o primeiro da lista de livres.
+ */
+void devolverNo(PoolNos *pool, void *no)
+{
+  *(void **)no = pool->livres;
+  pool->livres = no;
+  pool->ativos--;
+}
+
+/*
+ * Libera todos os blocos do pool.
+ * Os nós não são percorridos: cada bloco é liberado inteiro.
+ */
+void liberarPool(PoolNos *pool)
+{
+  BlocoPool *atual = pool->blocos;
+  while (atual != NULL)
+  {
+    BlocoPool *prox = atual->prox;
+    free(atual);
+    atual = prox;
+  }
+  pool->blocos = NULL;
+  pool->livres = NULL;
+  pool->ativos = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * pool.h
+ *
+ * Este arquivo contém as definições do pool de nós usado pelas duas
+ * implementações da biblioteca. Os nós (Livro) têm todos o mesmo tamanho,
+ * então são recortados de blocos grandes (slabs) e os nós removidos vão
+ * para uma lista de livres, sendo reaproveitados nas próximas inserções.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+#define NOS_POR_BLOCO 4096 // Quantidade de nós em cada bloco do pool
+
+/*
+ * Bloco (slab) do pool.
+ * Os blocos formam uma lista ligada para serem liberados no final.
+ */
+typedef struct BlocoPool
+{
+  struct BlocoPool *prox; // Bloco alocado anteriormente
+  size_t usados;          // Nós já recortados deste bloco
+  char dados[];           // Espaço para NOS_POR_BLOCO nós
+} BlocoPool;
+
+/*
+ * Pool de nós de tamanho fixo.
+ * Um nó devolvido guarda, no seu próprio espaço, o ponteiro para o
+ * próximo nó livre, então a lista de livres não usa memória extra.
+ */
+typedef struct
+{
+  size_t tamanhoNo;  // Tamanho de cada nó (já alinhado)
+  BlocoPool *blocos; // Bloco atual (início da lista de blocos)
+  void *livres;      // Lista de nós devolvidos
+  size_t ativos;     // Nós atualmente em uso
+} PoolNos;
+
+/*
+ * Inicializa um pool vazio para nós de `tamanhoNo` bytes.
+ * Nenhuma memória é alocada até o primeiro nó.
+ */
+void iniciarPool(PoolNos *pool, size_t tamanhoNo);
+
+/*
+ * Retorna um nó do pool: reaproveita um nó devolvido ou recorta um novo
+ * do bloco atual, alocando outro bloco só quando este acabar.
+ * Retorna NULL se não houver memória.
+ */
+void *alocarNo(PoolNos *pool);
+
+/*
+ * Devolve um nó ao pool, colocando-o na lista de livres.
+ */
+void devolverNo(PoolNos *pool, void *no);
+
+/*
+ * Libera todos os blocos do pool de uma só vez.
+ * Todos os nós alocados nele deixam de ser válidos.
+ */
+void liberarPool(PoolNos *pool);
+
+#endif
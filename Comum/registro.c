@@ -0,0 +1,145 @@
+/*
+ * registro.c
+ *
+ * Implementação do vetor de registros de livros.
+ * Este arquivo contém todas as funções declaradas em registro.h.
+ */
+
+#include "registro.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Inicializa um vetor vazio.
+ */
+void iniciarRegistros(VetorRegistros *vetor)
+{
+  vetor->itens = NULL;
+  vetor->quantidade = 0;
+  vetor->capacidade = 0;
+}
+
+/*
+ * Libera o vetor de registros.
+ */
+void liberarRegistros(VetorRegistros *vetor)
+{
+  free(vetor->itens);
+  iniciarRegistros(vetor);
+}
+
+/*
+ * Adiciona um registro no fim do vetor.
+ */
+int adicionarRegistro(VetorRegistros *vetor, const RegistroLivro *registro)
+{
+  if (vetor->quantidade == vetor->capacidade)
+  {
+    size_t novaCapacidade = vetor->capacidade > 0 ? vetor->capacidade * 2 : 1024;
+    RegistroLivro *novos = (RegistroLivro *)realloc(vetor->itens, novaCapacidade * sizeof(RegistroLivro));
+    if (novos == NULL)
+      return 0;
+    vetor->itens = novos;
+    vetor->capacidade = novaCapacidade;
+  }
+  vetor->itens[vetor->quantidade++] = *registro;
+  return 1;
+}
+
+/*
+ * Acrescenta os registros de outro vetor, aumentando a capacidade só o
+ * necessário.
+ */
+int juntarRegistros(VetorRegistros *destino, const VetorRegistros *origem)
+{
+  size_t total = destino->quantidade + origem->quantidade;
+  if (total > destino->capacidade)
+  {
+    RegistroLivro *novos = (RegistroLivro *)realloc(destino->itens, total * sizeof(RegistroLivro));
+    if (novos == NULL)
+      return 0;
+    destino->itens = novos;
+    destino->capacidade = total;
+  }
+  if (origem->quantidade > 0)
+    memcpy(destino->itens + destino->quantidade, origem->itens, origem->quantidade * sizeof(RegistroLivro));
+  destino->quantidade = total;
+  return 1;
+}
+
+/*
+ * Chave de ordenação de um ID.
+ * Inverte o bit de sinal para que a ordem dos inteiros sem sinal seja a
+ * mesma dos IDs com sinal (negativos antes dos positivos).
+ */
+uint32_t chaveRegistro(int id)
+{
+  return (uint32_t)id ^ 0x80000000u;
+}
+
+/*
+ * Ordena os registros por ID.
+ *
+ * Como funciona:
+ * 1. Confere se o vetor já está em ordem (caso comum: arquivo salvo ordenado)
+ * 2. Senão, faz radix sort LSD em 4 passadas de 8 bits cada, alternando
+ *    entre o vetor e um auxiliar; cada passada é uma contagem estável
+ * 3. Após 4 passadas (número par) o resultado volta ao vetor original
+ */
+int ordenarRegistros(VetorRegistros *vetor)
+{
+  size_t n = vetor->quantidade;
+  size_t i;
+
+  for (i = 1; i < n; i++)
+  {
+    if (vetor->itens[i - 1].id > vetor->itens[i].id)
+      break;
+  }
+  if (i >= n)
+    return 1;
+
+  RegistroLivro *auxiliar = (RegistroLivro *)malloc(n * sizeof(RegistroLivro));
+  if (auxiliar == NULL)
+    return 0;
+
+  RegistroLivro *origem = vetor->itens;
+  RegistroLivro *destino = auxiliar;
+
+  for (int deslocamento = 0; deslocamento < 32; deslocamento += 8)
+  {
+    size_t contagem[257] = {0};
+
+    for (i = 0; i < n; i++)
+      contagem[((chaveRegistro(origem[i].id) >> deslocamento) & 0xFF) + 1]++;
+    for (i = 1; i < 257; i++)
+      contagem[i] += contagem[i - 1];
+    for (i = 0; i < n; i++)
+      destino[contagem[(chaveRegistro(origem[i].id) >> deslocamento) & 0xFF]++] = origem[i];
+
+    RegistroLivro *troca = origem;
+    origem = destino;
+    destino = troca;
+  }
+
+  free(auxiliar);
+  return 1;
+}
+
+/*
+ * Remove IDs repetidos de um vetor ordenado, mantendo o primeiro.
+ */
+void removerRegistrosRepetidos(VetorRegistros *vetor)
+{
+  size_t escrita = 0;
+  for (size_t i = 0; i < vetor->quantidade; i++)
+  {
+    if (escrita == 0 || vetor->itens[escrita - 1].id != vetor->itens[i].id)
+    {
+      vetor->itens[escrita++] = vetor->itens[i];
+    }
+  }
+  vetor->quantidade = escrita;
+}
@@ -0,0 +1,75 @@
+/*
+ * registro.h
+ *
+ * Este arquivo contém as definições do vetor de registros de livros usado
+ * pelas duas implementações na carga em lote. Um registro é a forma
+ * "plana" de um livro (sem ponteiros de árvore ou lista), usada entre a
+ * leitura do arquivo e a montagem da estrutura.
+ */
+
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stddef.h>
+
+/*
+ * Dados de um livro lido do arquivo.
+ * Título e autor apontam para textos já guardados na arena da biblioteca.
+ */
+typedef struct
+{
+  int id;         // ID único do livro
+  int disponivel; // 1 se disponível, 0 se emprestado
+  char *titulo;   // Título do livro
+  char *autor;    // Nome do autor
+} RegistroLivro;
+
+/*
+ * Vetor dinâmico de registros.
+ */
+typedef struct
+{
+  RegistroLivro *itens; // Registros armazenados
+  size_t quantidade;    // Quantidade de registros no vetor
+  size_t capacidade;    // Tamanho alocado do vetor
+} VetorRegistros;
+
+/*
+ * Inicializa um vetor de registros vazio.
+ */
+void iniciarRegistros(VetorRegistros *vetor);
+
+/*
+ * Libera a memória do vetor (os textos pertencem à arena e não são liberados).
+ */
+void liberarRegistros(VetorRegistros *vetor);
+
+/*
+ * Adiciona um registro no fim do vetor, dobrando a capacidade quando
+ * necessário. Retorna 0 se não houver memória.
+ */
+int adicionarRegistro(VetorRegistros *vetor, const RegistroLivro *registro);
+
+/*
+ * Acrescenta todos os registros de origem no fim do destino, com uma só
+ * realocação. A origem não é alterada.
+ * Retorna 0 se não houver memória.
+ */
+int juntarRegistros(VetorRegistros *destino, const VetorRegistros *origem);
+
+/*
+ * Ordena os registros por ID em tempo linear.
+ * Se o vetor já estiver em ordem, só confere e retorna. Senão usa radix
+ * sort (estável), então registros com o mesmo ID mantêm a ordem do arquivo.
+ * Retorna 0 se não houver memória para o vetor auxiliar.
+ */
+int ordenarRegistros(VetorRegistros *vetor);
+
+/*
+ * Remove registros com ID repetido de um vetor ordenado, mantendo o
+ * primeiro de cada ID (mesmo efeito de inserir um por um, já que a
+ * inserção ignora IDs repetidos).
+ */
+void removerRegistrosRepetidos(VetorRegistros *vetor);
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * saida.c
+ *
+ * Implementação da saída em buffer.
+ * Este arquivo contém todas as funções declaradas em saida.h.
+ */
+
+#include "saida.h"
+#include "arena.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Grava um trecho inteiro no descritor, repetindo a escrita se ela for
+ * parcial ou interrompida. Marca erro na saída se falhar.
+ */
+void gravarSaida(Saida *saida, const char *dados, size_t tamanho)
+{
+  while (tamanho > 0 && !saida->erro)
+  {
+    ssize_t n = write(saida->fd, dados, tamanho);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+    {
+      saida->erro = 1;
+      break;
+    }
+    dados += n;
+    tamanho -= (size_t)n;
+  }
+}
+
+/*
+ * Prepara a saída.
+ */
+int abrirSaida(Saida *saida, int fd)
+{
+  saida->fd = fd;
+  saida->usado = 0;
+  saida->erro = 0;
+  saida->dados = (char *)malloc(TAMANHO_BUFFER_SAIDA);
+  return saida->dados != NULL;
+}
+
+/*
+ * Copia um texto para o buffer.
+ * Se não couber, grava o buffer antes; um texto maior que o buffer inteiro
+ * é gravado direto, sem passar por ele.
+ */
+void escreverSaida(Saida *saida, const char *texto, size_t tamanho)
+{
+  if (TAMANHO_BUFFER_SAIDA - saida->usado < tamanho)
+  {
+    gravarSaida(saida, saida->dados, saida->usado);
+    saida->usado = 0;
+    if (tamanho > TAMANHO_BUFFER_SAIDA)
+    {
+      gravarSaida(saida, texto, tamanho);
+      return;
+    }
+  }
+  memcpy(saida->dados + saida->usado, texto, tamanho);
+  saida->usado += tamanho;
+}
+
+/*
+ * Escreve um inteiro em decimal.
+ * Os dígitos são gerados do fim para o começo num buffer pequeno; o valor
+ * é convertido para unsigned antes de trocar o sinal, para INT_MIN não
+ * estourar.
+ */
+void escreverInteiro(Saida *saida, int valor)
+{
+  char digitos[12];
+  char *p = digitos + sizeof(digitos);
+  unsigned int numero = valor < 0 ? 0u - (unsigned int)valor : (unsigned int)valor;
+  do
+  {
+    *--p = (char)('0' + numero % 10);
+    numero /= 10;
+  } while (numero > 0);
+  if (valor < 0)
+    *--p = '-';
+  escreverSaida(saida, p, (size_t)(digitos + sizeof(digitos) - p));
+}
+
+/*
+ * Rótulos da listagem de livros. Como são vetores, sizeof dá o tamanho
+ * sem strlen.
+ */
+const char rotuloId[] = "ID: ";
+const char rotuloTitulo[] = "\nTítulo: ";
+const char rotuloAutor[] = "\nAutor: ";
+const char rotuloDisponivel[] = "\nDisponível: Sim\n------------------------\n";
+const char rotuloEmprestado[] = "\nDisponível: Não\n------------------------\n";
+
+/*
+ * Escreve um livro com o mesmo formato que a listagem tinha com printf.
+ */
+void escreverLivro(Saida *saida, int id, const char *titulo, const char *autor, int disponivel)
+{
+  escreverSaida(saida, rotuloId, sizeof(rotuloId) - 1);
+  escreverInteiro(saida, id);
+  escreverSaida(saida, rotuloTitulo, sizeof(rotuloTitulo) - 1);
+  escreverSaida(saida, titulo, tamanhoTexto(titulo));
+  escreverSaida(saida, rotuloAutor, sizeof(rotuloAutor) - 1);
+  escreverSaida(saida, autor, tamanhoTexto(autor));
+  if (disponivel)
+    escreverSaida(saida, rotuloDisponivel, sizeof(rotuloDisponivel) - 1);
+  else
+    escreverSaida(saida, rotuloEmprestado, sizeof(rotuloEmprestado) - 1);
+}
+
+/*
+ * Grava o resto do buffer e o libera.
+ */
+int fecharSaida(Saida *saida)
+{
+  gravarSaida(saida, saida->dados, saida->usado);
+  free(saida->dados);
+  saida->dados = NULL;
+  saida->usado = 0;
+  return !saida->erro;
+}
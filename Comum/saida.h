@@ -0,0 +1,61 @@
+/*
+ * saida.h
+ *
+ * Este arquivo contém as definições da saída em buffer usada pelas duas
+ * implementações da biblioteca para listar os livros. Em vez de um printf
+ * por linha, os textos são copiados para um buffer grande, os números são
+ * convertidos à mão e o buffer é gravado no descritor com um único write
+ * sempre que enche. Assim, listar muitos livros custa poucas chamadas ao
+ * sistema, e o tempo fica limitado pela velocidade de quem recebe a saída
+ * (terminal, arquivo ou pipe).
+ */
+
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAMANHO_BUFFER_SAIDA (256 * 1024) // Bytes juntados antes de cada write
+
+/*
+ * Saída em buffer para um descritor de arquivo.
+ */
+typedef struct
+{
+  int fd;       // Descritor onde a saída é gravada
+  char *dados;  // Buffer
+  size_t usado; // Bytes ocupados no buffer
+  int erro;     // Alguma gravação falhou (as seguintes são ignoradas)
+} Saida;
+
+/*
+ * Prepara a saída para o descritor fd, alocando o buffer.
+ * Retorna 0 se não houver memória.
+ */
+int abrirSaida(Saida *saida, int fd);
+
+/*
+ * Copia `tamanho` bytes para a saída, gravando o buffer quando ele enche.
+ * Textos maiores que o buffer são gravados direto.
+ */
+void escreverSaida(Saida *saida, const char *texto, size_t tamanho);
+
+/*
+ * Escreve um inteiro em decimal, sem printf.
+ */
+void escreverInteiro(Saida *saida, int valor);
+
+/*
+ * Escreve os dados de um livro no formato da listagem. Título e autor
+ * devem estar no formato da arena (o tamanho é lido do prefixo).
+ */
+void escreverLivro(Saida *saida, int id, const char *titulo, const char *autor, int disponivel);
+
+/*
+ * Grava o que estiver no buffer e o libera. O descritor não é fechado.
+ * Retorna 0 se alguma gravação tiver falhado.
+ */
+int fecharSaida(Saida *saida);
+
+#endif
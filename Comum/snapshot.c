@@ -0,0 +1,268 @@
+/*
+ * snapshot.c
+ *
+ * Implementação do formato binário de salvamento.
+ * Este arquivo contém todas as funções declaradas em snapshot.h.
+ */
+
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SOMA_INICIAL 0xCBF29CE484222325ull // Base do FNV-1a de 64 bits
+
+/*
+ * Arredonda o tamanho de uma seção para o próximo múltiplo de 8,
+ * mantendo todas as seções alinhadas dentro do arquivo.
+ */
+size_t alinharSecao(size_t tamanho)
+{
+  return (tamanho + 7) & ~(size_t)7;
+}
+
+/*
+ * Calcula onde fica cada seção de vetores: IDs, disponibilidade, títulos
+ * e autores, uma depois da outra, cada uma alinhada em 8 bytes.
+ */
+void calcularSecoes(size_t quantidade, SecoesSnapshot *secoes)
+{
+  size_t secaoPosicoes = alinharSecao(quantidade * sizeof(uint32_t));
+  secoes->ids = 0;
+  secoes->disponiveis = alinharSecao(quantidade * sizeof(int32_t));
+  secoes->titulos = secoes->disponiveis + alinharSecao(quantidade);
+  secoes->autores = secoes->titulos + secaoPosicoes;
+  secoes->tamanhoVetores = secoes->autores + secaoPosicoes;
+}
+
+/*
+ * Espaço que um texto ocupa na seção de textos: prefixo, caracteres e
+ * '\0', arredondado para múltiplo de 4 como na arena.
+ */
+size_t espacoTexto(const char *texto)
+{
+  return (sizeof(uint32_t) + tamanhoTexto(texto) + 1 + 3) & ~(size_t)3;
+}
+
+/*
+ * Acumula bytes na soma de verificação (FNV-1a de 64 bits aplicado a
+ * palavras de 8 bytes, bem mais rápido que byte a byte). O tamanho deve
+ * ser múltiplo de 8, o que vale para todas as seções.
+ */
+uint64_t somarBytes(uint64_t soma, const char *dados, size_t tamanho)
+{
+  for (size_t i = 0; i < tamanho; i += 8)
+  {
+    uint64_t palavra;
+    memcpy(&palavra, dados + i, sizeof(palavra));
+    soma = (soma ^ palavra) * 0x100000001B3ull;
+  }
+  return soma;
+}
+
+/*
+ * Grava um snapshot.
+ *
+ * Como funciona:
+ * 1. Calcula o tamanho dos textos, lendo o prefixo de cada um na arena
+ * 2. Monta as seções de vetores num buffer e os textos em outro, copiando
+ *    cada texto com seu prefixo, como já estava na arena
+ * 3. Calcula a soma de verificação e grava cabeçalho, vetores e textos
+ *    com três escritas
+ */
+int salvarSnapshot(FILE *arquivo, const RegistroLivro *registros, size_t quantidade)
+{
+  if (quantidade > UINT32_MAX)
+    return 0;
+
+  size_t tamanhoTextos = 0;
+  for (size_t i = 0; i < quantidade; i++)
+  {
+    tamanhoTextos += espacoTexto(registros[i].titulo) + espacoTexto(registros[i].autor);
+  }
+  if (tamanhoTextos > UINT32_MAX)
+    return 0; // As posições dos textos são gravadas com 32 bits
+  tamanhoTextos = alinharSecao(tamanhoTextos);
+
+  SecoesSnapshot secoes;
+  calcularSecoes(quantidade, &secoes);
+  size_t tamanhoVetores = secoes.tamanhoVetores;
+
+  // O byte extra evita pedir 0 bytes quando a biblioteca está vazia
+  char *vetores = (char *)calloc(1, tamanhoVetores + 1);
+  char *textos = (char *)calloc(1, tamanhoTextos + 1);
+  if (vetores == NULL || textos == NULL)
+  {
+    free(vetores);
+    free(textos);
+    return 0;
+  }
+
+  int32_t *ids = (int32_t *)(vetores + secoes.ids);
+  uint8_t *disponiveis = (uint8_t *)(vetores + secoes.disponiveis);
+  uint32_t *titulos = (uint32_t *)(vetores + secoes.titulos);
+  uint32_t *autores = (uint32_t *)(vetores + secoes.autores);
+  size_t pos = 0;
+  for (size_t i = 0; i < quantidade; i++)
+  {
+    ids[i] = registros[i].id;
+    disponiveis[i] = registros[i].disponivel ? 1 : 0;
+
+    const char *campos[2] = {registros[i].titulo, registros[i].autor};
+    uint32_t *posicoes[2] = {&titulos[i], &autores[i]};
+    for (int c = 0; c < 2; c++)
+    {
+      memcpy(textos + pos, campos[c] - sizeof(uint32_t), sizeof(uint32_t) + tamanhoTexto(campos[c]) + 1);
+      *posicoes[c] = (uint32_t)(pos + sizeof(uint32_t));
+      pos += espacoTexto(campos[c]);
+    }
+  }
+
+  CabecalhoSnapshot cabecalho;
+  memset(&cabecalho, 0, sizeof(cabecalho));
+  memcpy(cabecalho.magica, MAGICA_SNAPSHOT, sizeof(cabecalho.magica));
+  cabecalho.versao = VERSAO_SNAPSHOT;
+  cabecalho.quantidade = (uint32_t)quantidade;
+  cabecalho.tamanhoTextos = tamanhoTextos;
+  cabecalho.soma = somarBytes(somarBytes(SOMA_INICIAL, vetores, tamanhoVetores), textos, tamanhoTextos);
+
+  int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+           fwrite(vetores, 1, tamanhoVetores, arquivo) == tamanhoVetores &&
+           fwrite(textos, 1, tamanhoTextos, arquivo) == tamanhoTextos;
+  free(vetores);
+  free(textos);
+  return ok;
+}
+
+/*
+ * Confere a marca do cabeçalho e volta ao início do arquivo.
+ */
+int ehSnapshot(FILE *arquivo)
+{
+  char magica[8];
+  int ok = fread(magica, 1, sizeof(magica), arquivo) == sizeof(magica) &&
+           memcmp(magica, MAGICA_SNAPSHOT, sizeof(magica)) == 0;
+  rewind(arquivo);
+  return ok;
+}
+
+/*
+ * Confere a marca, a versão e o tamanho da seção de textos, que precisa
+ * ser múltiplo de 8 e caber nas posições de 32 bits.
+ */
+int cabecalhoValido(const CabecalhoSnapshot *cabecalho)
+{
+  return memcmp(cabecalho->magica, MAGICA_SNAPSHOT, sizeof(cabecalho->magica)) == 0 &&
+         cabecalho->versao == VERSAO_SNAPSHOT &&
+         cabecalho->tamanhoTextos % 8 == 0 && cabecalho->tamanhoTextos <= UINT32_MAX;
+}
+
+/*
+ * Confere se uma posição aponta para um texto válido dentro da seção de
+ * textos: o prefixo e o '\0' final cabem na seção e estão no lugar.
+ */
+int textoValido(const char *textos, uint64_t tamanhoTextos, uint32_t posicao)
+{
+  if (posicao < sizeof(uint32_t) || posicao >= tamanhoTextos)
+    return 0;
+  uint32_t tamanho = tamanhoTexto(textos + posicao);
+  return tamanho < tamanhoTextos - posicao && textos[posicao + tamanho] == '\0';
+}
+
+/*
+ * Lê um snapshot.
+ *
+ * Como funciona:
+ * 1. Lê e confere o cabeçalho (marca e versão)
+ * 2. Lê as seções de vetores num buffer temporário e a de textos direto
+ *    para um bloco reservado na arena
+ * 3. Confere a soma de verificação e cada posição de texto
+ * 4. Monta os registros apontando para os textos na arena
+ */
+int lerSnapshot(FILE *arquivo, Arena *textos, VetorRegistros *registros)
+{
+  CabecalhoSnapshot cabecalho;
+  if (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 || !cabecalhoValido(&cabecalho))
+    return 0;
+
+  size_t quantidade = cabecalho.quantidade;
+  SecoesSnapshot secoes;
+  calcularSecoes(quantidade, &secoes);
+  size_t tamanhoVetores = secoes.tamanhoVetores;
+  size_t tamanhoTextos = (size_t)cabecalho.tamanhoTextos;
+
+  char *vetores = (char *)malloc(tamanhoVetores + 1);
+  if (vetores == NULL)
+    return 0;
+  // Em caso de erro daqui em diante, o bloco de textos só volta com a arena
+  char *blocoTextos = reservarArena(textos, tamanhoTextos);
+  int ok = blocoTextos != NULL &&
+           fread(vetores, 1, tamanhoVetores, arquivo) == tamanhoVetores &&
+           fread(blocoTextos, 1, tamanhoTextos, arquivo) == tamanhoTextos &&
+           somarBytes(somarBytes(SOMA_INICIAL, vetores, tamanhoVetores), blocoTextos, tamanhoTextos) == cabecalho.soma;
+
+  const int32_t *ids = (const int32_t *)(vetores + secoes.ids);
+  const uint8_t *disponiveis = (const uint8_t *)(vetores + secoes.disponiveis);
+  const uint32_t *titulos = (const uint32_t *)(vetores + secoes.titulos);
+  const uint32_t *autores = (const uint32_t *)(vetores + secoes.autores);
+  for (size_t i = 0; ok && i < quantidade; i++)
+  {
+    if (!textoValido(blocoTextos, tamanhoTextos, titulos[i]) ||
+        !textoValido(blocoTextos, tamanhoTextos, autores[i]))
+    {
+      ok = 0;
+      break;
+    }
+    RegistroLivro registro;
+    registro.id = ids[i];
+    registro.disponivel = disponiveis[i];
+    registro.titulo = blocoTextos + titulos[i];
+    registro.autor = blocoTextos + autores[i];
+    ok = adicionarRegistro(registros, &registro);
+  }
+
+  free(vetores);
+  return ok;
+}
+
+/*
+ * Descarrega o buffer do arquivo e chama fsync no descritor.
+ */
+int sincronizarArquivo(FILE *arquivo)
+{
+  return fflush(arquivo) == 0 && fsync(fileno(arquivo)) == 0;
+}
+
+/*
+ * Sincroniza o diretório de um arquivo (a parte do nome até a última '/',
+ * ou o diretório atual).
+ */
+int sincronizarDiretorio(const char *nomeArquivo)
+{
+  char diretorio[1024] = ".";
+  const char *barra = strrchr(nomeArquivo, '/');
+  if (barra != NULL && (size_t)(barra - nomeArquivo) < sizeof(diretorio))
+  {
+    memcpy(diretorio, nomeArquivo, (size_t)(barra - nomeArquivo));
+    diretorio[barra - nomeArquivo] = '\0';
+    if (barra == nomeArquivo)
+      strcpy(diretorio, "/");
+  }
+  int fd = open(diretorio, O_RDONLY);
+  if (fd < 0)
+    return 0;
+  int ok = fsync(fd) == 0;
+  close(fd);
+  return ok;
+}
+
+/*
+ * Renomeia o arquivo novo por cima do destino e sincroniza o diretório do
+ * destino.
+ */
+int trocarArquivo(const char *novo, const char *destino)
+{
+  return rename(novo, destino) == 0 && sincronizarDiretorio(destino);
+}
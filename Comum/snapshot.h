@@ -0,0 +1,120 @@
+/*
+ * snapshot.h
+ *
+ * Este arquivo contém as definições do formato binário de salvamento
+ * (snapshot) usado pelas duas implementações da biblioteca. Em vez de uma
+ * linha de texto por livro, o arquivo guarda vetores compactos que são
+ * gravados e lidos com poucas operações grandes e sequenciais.
+ *
+ * Formato (na ordem de bytes da máquina), com cada seção completada com
+ * zeros até um múltiplo de 8 bytes:
+ * 1. Cabeçalho (CabecalhoSnapshot)
+ * 2. IDs: int32_t[quantidade], em ordem crescente
+ * 3. Disponibilidade: uint8_t[quantidade] (1 disponível, 0 emprestado)
+ * 4. Títulos: uint32_t[quantidade], posição de cada título nos textos
+ * 5. Autores: uint32_t[quantidade], posição de cada autor nos textos
+ * 6. Textos: tamanhoTextos bytes no mesmo formato da arena (prefixo de
+ *    4 bytes com o tamanho, caracteres e '\0', alinhados em 4 bytes); as
+ *    posições das seções 4 e 5 apontam para os caracteres
+ *
+ * O formato texto (id|titulo|autor|disponivel) continua sendo aceito por
+ * carregarLivros e gravado por salvarLivros, para importar e exportar.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "registro.h"
+
+#define MAGICA_SNAPSHOT "BIBLIOSN" // Identifica um arquivo de snapshot (8 bytes)
+#define VERSAO_SNAPSHOT 1          // Versão atual do formato
+
+/*
+ * Cabeçalho do snapshot (32 bytes).
+ * A soma de verificação cobre todas as seções depois do cabeçalho.
+ */
+typedef struct
+{
+  char magica[8];         // MAGICA_SNAPSHOT, sem '\0'
+  uint32_t versao;        // VERSAO_SNAPSHOT
+  uint32_t quantidade;    // Quantidade de livros
+  uint64_t tamanhoTextos; // Tamanho da seção de textos
+  uint64_t soma;          // Soma de verificação das seções
+} CabecalhoSnapshot;
+
+/*
+ * Posição de cada seção de vetores, contada a partir do fim do cabeçalho.
+ * A seção de textos começa em tamanhoVetores.
+ */
+typedef struct
+{
+  size_t ids;            // Seção de IDs
+  size_t disponiveis;    // Seção de disponibilidade
+  size_t titulos;        // Seção de posições dos títulos
+  size_t autores;        // Seção de posições dos autores
+  size_t tamanhoVetores; // Tamanho das quatro seções juntas
+} SecoesSnapshot;
+
+/*
+ * Calcula onde fica cada seção de vetores para uma quantidade de livros.
+ */
+void calcularSecoes(size_t quantidade, SecoesSnapshot *secoes);
+
+/*
+ * Confere a marca, a versão e o tamanho da seção de textos do cabeçalho.
+ */
+int cabecalhoValido(const CabecalhoSnapshot *cabecalho);
+
+/*
+ * Confere se uma posição aponta para um texto válido dentro da seção de
+ * textos: o prefixo e o '\0' final cabem na seção e estão no lugar.
+ */
+int textoValido(const char *textos, uint64_t tamanhoTextos, uint32_t posicao);
+
+/*
+ * Grava um snapshot com os registros informados, que devem estar em ordem
+ * crescente de ID e ter título e autor guardados numa arena.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int salvarSnapshot(FILE *arquivo, const RegistroLivro *registros, size_t quantidade);
+
+/*
+ * Confere se o arquivo começa com um cabeçalho de snapshot, sem consumir
+ * nada do arquivo (volta ao início).
+ */
+int ehSnapshot(FILE *arquivo);
+
+/*
+ * Lê um snapshot para o vetor de registros.
+ * A seção de textos é lida direto para um bloco da arena, e os títulos e
+ * autores dos registros apontam para dentro dele, sem cópia.
+ * Retorna 0 se o arquivo estiver corrompido, for de outra versão ou não
+ * houver memória.
+ */
+int lerSnapshot(FILE *arquivo, Arena *textos, VetorRegistros *registros);
+
+/*
+ * Descarrega o buffer do arquivo e espera os dados chegarem ao disco
+ * (fsync). Retorna 0 se falhar.
+ */
+int sincronizarArquivo(FILE *arquivo);
+
+/*
+ * Sincroniza o diretório que contém o arquivo, para que a criação, a troca
+ * ou a remoção do nome sobreviva a uma queda. Retorna 0 se falhar.
+ */
+int sincronizarDiretorio(const char *nomeArquivo);
+
+/*
+ * Renomeia um arquivo já sincronizado por cima do destino e sincroniza o
+ * diretório, para a troca também sobreviver a uma queda. Quem tinha o
+ * destino aberto (ou mapeado) continua vendo o arquivo antigo.
+ * Retorna 0 se falhar.
+ */
+int trocarArquivo(const char *novo, const char *destino);
+
+#endif
@@ -0,0 +1,475 @@
+/*
+ * titulos.c
+ *
+ * Implementação do índice de títulos.
+ * Este arquivo contém todas as funções declaradas em titulos.h.
+ */
+
+#include "titulos.h"
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACIDADE_INICIAL_NGRAMAS 4096 // Posições alocadas no primeiro n-grama
+#define IDS_INICIAIS_NGRAMA 4           // IDs alocados na primeira vez que um n-grama aparece
+
+/*
+ * Inicializa um vetor de IDs vazio.
+ */
+void iniciarIds(VetorIds *vetor)
+{
+  vetor->itens = NULL;
+  vetor->quantidade = 0;
+  vetor->capacidade = 0;
+}
+
+/*
+ * Libera o vetor de IDs.
+ */
+void liberarIds(VetorIds *vetor)
+{
+  free(vetor->itens);
+  iniciarIds(vetor);
+}
+
+/*
+ * Acrescenta um ID ao vetor.
+ */
+int adicionarId(VetorIds *vetor, int id)
+{
+  if (vetor->quantidade == vetor->capacidade)
+  {
+    size_t capacidade = vetor->capacidade > 0 ? vetor->capacidade * 2 : 64;
+    int *itens = (int *)realloc(vetor->itens, capacidade * sizeof(int));
+    if (itens == NULL)
+      return 0;
+    vetor->itens = itens;
+    vetor->capacidade = capacidade;
+  }
+  vetor->itens[vetor->quantidade++] = id;
+  return 1;
+}
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarTitulos(IndiceTitulos *indice)
+{
+  memset(&indice->raiz, 0, sizeof(indice->raiz));
+  iniciarPool(&indice->nos, sizeof(NoTitulo));
+  indice->comVetor = NULL;
+  indice->ngramas = NULL;
+  indice->capacidadeNgramas = 0;
+  indice->quantidadeNgramas = 0;
+  indice->titulos = 0;
+  indice->removidos = 0;
+}
+
+/*
+ * Libera o índice.
+ * Os nós saem todos de uma vez com o pool; só os vetores de IDs dos nós
+ * precisam ser liberados um a um, e eles estão na lista comVetor, então a
+ * árvore não é percorrida.
+ */
+void liberarTitulos(IndiceTitulos *indice)
+{
+  for (NoTitulo *no = indice->comVetor; no != NULL; no = no->proxVetor)
+  {
+    free(no->ids);
+  }
+  for (size_t i = 0; i < indice->capacidadeNgramas; i++)
+  {
+    free(indice->ngramas[i].ids);
+  }
+  free(indice->ngramas);
+  liberarPool(&indice->nos);
+  iniciarTitulos(indice);
+}
+
+/*
+ * Guarda um ID num nó da árvore.
+ * O primeiro ID fica no próprio nó; o vetor só é alocado quando o nó
+ * recebe o segundo livro com o mesmo título.
+ */
+int guardarIdNo(IndiceTitulos *indice, NoTitulo *no, int id)
+{
+  if (no->quantidade == 0 && no->capacidade == 0)
+  {
+    no->id = id;
+    no->quantidade = 1;
+    return 1;
+  }
+  if (no->quantidade == no->capacidade || no->capacidade == 0)
+  {
+    int capacidade = no->capacidade > 0 ? no->capacidade * 2 : 4;
+    int *ids = (int *)realloc(no->ids, (size_t)capacidade * sizeof(int));
+    if (ids == NULL)
+      return 0;
+    if (no->capacidade == 0)
+    {
+      ids[0] = no->id; // O ID que estava no nó passa para o vetor
+      no->proxVetor = indice->comVetor;
+      indice->comVetor = no;
+    }
+    no->ids = ids;
+    no->capacidade = capacidade;
+  }
+  no->ids[no->quantidade++] = id;
+  return 1;
+}
+
+/*
+ * Retorna os IDs guardados num nó (no próprio nó ou no vetor).
+ */
+const int *idsDoNo(const NoTitulo *no)
+{
+  return no->capacidade > 0 ? no->ids : &no->id;
+}
+
+/*
+ * Conta quantos bytes iniciais dois trechos têm em comum.
+ */
+size_t prefixoComum(const char *a, const char *b, size_t tamanho)
+{
+  size_t i = 0;
+  while (i < tamanho && a[i] == b[i])
+  {
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Acha, entre os filhos de um nó, a ligação para o filho cujo rótulo
+ * começa com o byte dado, ou a ligação onde ele entraria (a lista está em
+ * ordem do primeiro byte).
+ */
+NoTitulo **procurarFilho(NoTitulo *no, unsigned char byte)
+{
+  NoTitulo **ligacao = &no->filho;
+  while (*ligacao != NULL && (unsigned char)(*ligacao)->rotulo[0] < byte)
+  {
+    ligacao = &(*ligacao)->irmao;
+  }
+  return ligacao;
+}
+
+/*
+ * Põe um título na árvore radix.
+ *
+ * Como funciona:
+ * 1. Desce pelos filhos cujo rótulo começa com o próximo byte do título
+ * 2. Se o rótulo do filho for só em parte igual ao resto do título, divide
+ *    o filho: um nó novo fica com a parte igual e o filho, com o resto
+ * 3. Se nenhum filho começar com o próximo byte, o resto do título vira o
+ *    rótulo de uma folha nova
+ * 4. O ID fica no nó onde o título termina
+ *
+ * Os rótulos novos apontam para dentro do título inserido, e a divisão só
+ * encurta rótulos que já existiam, então cada rótulo continua sendo um
+ * trecho de um título que tem o caminho até ele como prefixo.
+ */
+int inserirRadix(IndiceTitulos *indice, const char *titulo, size_t tamanho, int id)
+{
+  NoTitulo *no = &indice->raiz;
+  size_t pos = 0;
+  while (pos < tamanho)
+  {
+    NoTitulo **ligacao = procurarFilho(no, (unsigned char)titulo[pos]);
+    NoTitulo *filho = *ligacao;
+    if (filho == NULL || filho->rotulo[0] != titulo[pos])
+    {
+      NoTitulo *folha = (NoTitulo *)alocarNo(&indice->nos);
+      if (folha == NULL)
+        return 0;
+      memset(folha, 0, sizeof(*folha));
+      folha->rotulo = titulo + pos;
+      folha->tamanhoRotulo = (uint32_t)(tamanho - pos);
+      folha->irmao = filho;
+      *ligacao = folha;
+      no = folha;
+      break;
+    }
+
+    size_t limite = tamanho - pos < filho->tamanhoRotulo ? tamanho - pos : filho->tamanhoRotulo;
+    size_t comum = prefixoComum(filho->rotulo, titulo + pos, limite);
+    if (comum < filho->tamanhoRotulo)
+    {
+      NoTitulo *meio = (NoTitulo *)alocarNo(&indice->nos);
+      if (meio == NULL)
+        return 0;
+      memset(meio, 0, sizeof(*meio));
+      meio->rotulo = filho->rotulo;
+      meio->tamanhoRotulo = (uint32_t)comum;
+      meio->irmao = filho->irmao;
+      meio->filho = filho;
+      filho->rotulo += comum;
+      filho->tamanhoRotulo -= (uint32_t)comum;
+      filho->irmao = NULL;
+      *ligacao = meio;
+      filho = meio;
+    }
+    pos += comum;
+    no = filho;
+  }
+  return guardarIdNo(indice, no, id);
+}
+
+/*
+ * Junta os bytes de um n-grama num inteiro.
+ */
+uint32_t lerNgrama(const char *texto)
+{
+  return (uint32_t)(unsigned char)texto[0] << 16 | (uint32_t)(unsigned char)texto[1] << 8 |
+         (uint32_t)(unsigned char)texto[2];
+}
+
+/*
+ * Posição inicial de um n-grama na tabela (hash de Fibonacci, como no
+ * índice por ID).
+ */
+size_t posicaoNgrama(size_t capacidade, uint32_t ngrama)
+{
+  uint32_t h = ngrama * 0x9E3779B1u;
+  h ^= h >> 16;
+  return h & (capacidade - 1);
+}
+
+/*
+ * Retorna a posição de um n-grama na tabela ou a posição vazia onde a
+ * sondagem parou. A tabela não pode estar vazia.
+ */
+EntradaNgrama *procurarNgrama(EntradaNgrama *ngramas, size_t capacidade, uint32_t ngrama)
+{
+  size_t pos = posicaoNgrama(capacidade, ngrama);
+  while (ngramas[pos].ids != NULL && ngramas[pos].ngrama != ngrama)
+  {
+    pos = (pos + 1) & (capacidade - 1);
+  }
+  return &ngramas[pos];
+}
+
+/*
+ * Dobra a tabela de n-gramas (ou aloca a inicial), movendo as listas sem
+ * copiá-las. Retorna 0 se não houver memória (a tabela antiga é mantida).
+ */
+int crescerNgramas(IndiceTitulos *indice)
+{
+  size_t capacidade = indice->capacidadeNgramas > 0 ? indice->capacidadeNgramas * 2
+                                                    : CAPACIDADE_INICIAL_NGRAMAS;
+  EntradaNgrama *ngramas = (EntradaNgrama *)calloc(capacidade, sizeof(EntradaNgrama));
+  if (ngramas == NULL)
+    return 0;
+  for (size_t i = 0; i < indice->capacidadeNgramas; i++)
+  {
+    if (indice->ngramas[i].ids != NULL)
+      *procurarNgrama(ngramas, capacidade, indice->ngramas[i].ngrama) = indice->ngramas[i];
+  }
+  free(indice->ngramas);
+  indice->ngramas = ngramas;
+  indice->capacidadeNgramas = capacidade;
+  return 1;
+}
+
+/*
+ * Acrescenta um ID à lista de um n-grama, criando a lista se preciso.
+ * Um título com o mesmo n-grama mais de uma vez entra uma vez só na lista:
+ * os n-gramas de um título são acrescentados em sequência, então, se o ID
+ * já estiver na lista, ele é o último.
+ */
+int adicionarNgrama(IndiceTitulos *indice, uint32_t ngrama, int id)
+{
+  if (indice->quantidadeNgramas + 1 >= indice->capacidadeNgramas / 4 * 3 && !crescerNgramas(indice))
+    return 0;
+
+  EntradaNgrama *entrada = procurarNgrama(indice->ngramas, indice->capacidadeNgramas, ngrama);
+  if (entrada->ids != NULL && entrada->ids[entrada->quantidade - 1] == id)
+    return 1;
+  if (entrada->quantidade == entrada->capacidade)
+  {
+    int capacidade = entrada->capacidade > 0 ? entrada->capacidade * 2 : IDS_INICIAIS_NGRAMA;
+    int *ids = (int *)realloc(entrada->ids, (size_t)capacidade * sizeof(int));
+    if (ids == NULL)
+      return 0;
+    if (entrada->ids == NULL)
+    {
+      entrada->ngrama = ngrama;
+      indice->quantidadeNgramas++;
+    }
+    entrada->ids = ids;
+    entrada->capacidade = capacidade;
+  }
+  entrada->ids[entrada->quantidade++] = id;
+  return 1;
+}
+
+/*
+ * Acrescenta um livro ao índice.
+ */
+int adicionarTitulo(IndiceTitulos *indice, const char *titulo, int id)
+{
+  size_t tamanho = tamanhoTexto(titulo);
+  if (!inserirRadix(indice, titulo, tamanho, id))
+    return 0;
+  for (size_t i = 0; i + TAMANHO_NGRAMA <= tamanho; i++)
+  {
+    if (!adicionarNgrama(indice, lerNgrama(titulo + i), id))
+      return 0;
+  }
+  indice->titulos++;
+  return 1;
+}
+
+/*
+ * Retira um livro da árvore radix.
+ * Desce pelo caminho do título e tira o ID do nó onde ele termina,
+ * pondo o último ID do nó no lugar.
+ */
+void removerTitulo(IndiceTitulos *indice, const char *titulo, int id)
+{
+  size_t tamanho = tamanhoTexto(titulo);
+  NoTitulo *no = &indice->raiz;
+  size_t pos = 0;
+  while (no != NULL && pos < tamanho)
+  {
+    NoTitulo *filho = *procurarFilho(no, (unsigned char)titulo[pos]);
+    if (filho == NULL || filho->tamanhoRotulo > tamanho - pos ||
+        memcmp(filho->rotulo, titulo + pos, filho->tamanhoRotulo) != 0)
+      return;
+    pos += filho->tamanhoRotulo;
+    no = filho;
+  }
+
+  int *ids = no->capacidade > 0 ? no->ids : &no->id;
+  for (int i = no->quantidade - 1; i >= 0; i--)
+  {
+    if (ids[i] == id)
+    {
+      ids[i] = ids[--no->quantidade];
+      indice->titulos--;
+      indice->removidos++;
+      return;
+    }
+  }
+}
+
+/*
+ * Busca por início do título.
+ *
+ * Como funciona:
+ * 1. Desce pela árvore comparando o prefixo com os rótulos; o prefixo pode
+ *    terminar no meio de um rótulo
+ * 2. Percorre a subárvore do nó onde o prefixo terminou com uma pilha
+ *    explícita, juntando os IDs de cada nó; os filhos são empilhados do
+ *    último para o primeiro, então os títulos saem em ordem
+ */
+int buscarPrefixoTitulos(const IndiceTitulos *indice, const char *prefixo, size_t tamanho,
+                         VetorIds *ids)
+{
+  NoTitulo *no = (NoTitulo *)&indice->raiz;
+  size_t pos = 0;
+  while (pos < tamanho)
+  {
+    NoTitulo *filho = *procurarFilho(no, (unsigned char)prefixo[pos]);
+    if (filho == NULL || filho->rotulo[0] != prefixo[pos])
+      return 1;
+    size_t limite = tamanho - pos < filho->tamanhoRotulo ? tamanho - pos : filho->tamanhoRotulo;
+    if (prefixoComum(filho->rotulo, prefixo + pos, limite) < limite)
+      return 1;
+    pos += limite;
+    no = filho;
+  }
+
+  size_t topo = 0, capacidade = 64;
+  NoTitulo **pilha = (NoTitulo **)malloc(capacidade * sizeof(NoTitulo *));
+  if (pilha == NULL)
+    return 0;
+  pilha[topo++] = no;
+  int ok = 1;
+  while (ok && topo > 0)
+  {
+    NoTitulo *atual = pilha[--topo];
+    const int *doNo = idsDoNo(atual);
+    for (int i = 0; ok && i < atual->quantidade; i++)
+    {
+      ok = adicionarId(ids, doNo[i]);
+    }
+
+    // Empilha os filhos em ordem inversa para visitar o menor primeiro
+    size_t base = topo;
+    for (NoTitulo *filho = atual->filho; ok && filho != NULL; filho = filho->irmao)
+    {
+      if (topo == capacidade)
+      {
+        NoTitulo **maior = (NoTitulo **)realloc(pilha, capacidade * 2 * sizeof(NoTitulo *));
+        if (maior == NULL)
+        {
+          ok = 0;
+          break;
+        }
+        pilha = maior;
+        capacidade *= 2;
+      }
+      pilha[topo++] = filho;
+    }
+    for (size_t i = base, j = topo; ok && i + 1 < j; i++, j--)
+    {
+      NoTitulo *troca = pilha[i];
+      pilha[i] = pilha[j - 1];
+      pilha[j - 1] = troca;
+    }
+  }
+  free(pilha);
+  return ok;
+}
+
+/*
+ * Junta os candidatos de um trecho: procura cada n-grama do trecho e
+ * fica com a menor lista. Se algum n-grama não estiver na tabela, nenhum
+ * título contém o trecho.
+ */
+int candidatosTrecho(const IndiceTitulos *indice, const char *trecho, size_t tamanho, VetorIds *ids)
+{
+  if (indice->quantidadeNgramas == 0 || tamanho < TAMANHO_NGRAMA)
+    return 1;
+
+  const EntradaNgrama *menor = NULL;
+  for (size_t i = 0; i + TAMANHO_NGRAMA <= tamanho; i++)
+  {
+    const EntradaNgrama *entrada =
+        procurarNgrama(indice->ngramas, indice->capacidadeNgramas, lerNgrama(trecho + i));
+    if (entrada->ids == NULL)
+      return 1;
+    if (menor == NULL || entrada->quantidade < menor->quantidade)
+      menor = entrada;
+  }
+  for (int i = 0; i < menor->quantidade; i++)
+  {
+    if (!adicionarId(ids, menor->ids[i]))
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * Procura o trecho no título: memchr acha cada ocorrência do primeiro
+ * byte e memcmp confere o resto.
+ */
+int contemTrecho(const char *titulo, size_t tamanhoTitulo, const char *trecho, size_t tamanho)
+{
+  if (tamanho == 0)
+    return 1;
+  const char *fim = titulo + tamanhoTitulo;
+  const char *p = titulo;
+  while ((size_t)(fim - p) >= tamanho)
+  {
+    p = (const char *)memchr(p, trecho[0], (size_t)(fim - p) - tamanho + 1);
+    if (p == NULL)
+      return 0;
+    if (memcmp(p, trecho, tamanho) == 0)
+      return 1;
+    p++;
+  }
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * titulos.h
+ *
+ * Este arquivo contém as definições do índice de títulos usado pelas duas
+ * implementações da biblioteca, com duas estruturas:
+ *
+ * - Uma árvore radix (trie compactada) com os títulos, para buscas por
+ *   início do título: a descida custa o tamanho do prefixo, e os livros
+ *   encontrados são os da subárvore onde ela termina. Cada aresta guarda
+ *   um trecho de vários bytes, e não um byte só, então a árvore tem no
+ *   máximo dois nós por título. Os rótulos não são cópias: apontam para
+ *   dentro dos próprios títulos, na arena da biblioteca ou nas páginas do
+ *   catálogo mapeado.
+ *
+ * - Um índice invertido de n-gramas (trechos de TAMANHO_NGRAMA bytes
+ *   seguidos), para buscas por trecho em qualquer parte do título: cada
+ *   n-grama leva à lista dos IDs cujos títulos o contêm. Todo título que
+ *   contém o trecho buscado está na lista de cada n-grama do trecho, então
+ *   basta conferir os livros da menor dessas listas.
+ *
+ * As listas de n-gramas não são limpas quando um título sai (seria preciso
+ * procurar o ID em listas com até um ID por livro): os IDs removidos
+ * continuam lá até o índice ser remontado, e a conferência do trecho no
+ * título atual do livro os descarta. Os nós da árvore também ficam, mesmo
+ * sem livros. O contador `removidos` diz quando vale a pena remontar.
+ *
+ * A comparação é exata, byte a byte.
+ */
+
+#ifndef TITULOS_H
+#define TITULOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pool.h"
+
+#define TAMANHO_NGRAMA 3 // Bytes de cada n-grama (trigramas)
+
+/*
+ * Vetor dinâmico de IDs, usado para devolver os resultados das buscas.
+ */
+typedef struct
+{
+  int *itens;        // IDs
+  size_t quantidade; // IDs no vetor
+  size_t capacidade; // Tamanho alocado do vetor
+} VetorIds;
+
+/*
+ * Nó da árvore radix.
+ * O caminho da raiz até o nó, juntando os rótulos, é um prefixo de
+ * título; os livros guardados no nó são os que têm exatamente esse
+ * título. Os filhos ficam numa lista ordenada pelo primeiro byte do
+ * rótulo, e dois filhos nunca começam com o mesmo byte.
+ */
+typedef struct NoTitulo
+{
+  const char *rotulo;         // Trecho do título (dentro de um dos títulos)
+  uint32_t tamanhoRotulo;     // Bytes do rótulo
+  int quantidade;             // Livros com o título que termina neste nó
+  int capacidade;             // Tamanho do vetor ids (0 enquanto só há o id)
+  int id;                     // ID do livro, enquanto o nó tem um livro só
+  int *ids;                   // IDs dos livros, quando o nó já teve mais de um
+  struct NoTitulo *filho;     // Primeiro filho
+  struct NoTitulo *irmao;     // Próximo irmão (primeiro byte maior)
+  struct NoTitulo *proxVetor; // Próximo nó com vetor ids (para liberar)
+} NoTitulo;
+
+/*
+ * Posição da tabela de n-gramas.
+ * Uma posição com ids NULL está vazia.
+ */
+typedef struct
+{
+  uint32_t ngrama; // Bytes do n-grama, juntados num inteiro
+  int quantidade;  // IDs na lista
+  int capacidade;  // Tamanho alocado da lista
+  int *ids;        // IDs dos livros cujo título contém o n-grama
+} EntradaNgrama;
+
+/*
+ * Índice de títulos.
+ */
+typedef struct
+{
+  NoTitulo raiz;            // Raiz da árvore radix (rótulo vazio)
+  PoolNos nos;              // Pool dos nós da árvore
+  NoTitulo *comVetor;       // Lista dos nós que alocaram o vetor ids
+  EntradaNgrama *ngramas;   // Tabela de n-gramas (NULL enquanto vazia)
+  size_t capacidadeNgramas; // Posições da tabela (potência de 2)
+  size_t quantidadeNgramas; // Posições ocupadas
+  size_t titulos;           // Títulos no índice
+  size_t removidos;         // Títulos removidos ainda presentes nas listas
+} IndiceTitulos;
+
+/*
+ * Inicializa um vetor de IDs vazio.
+ */
+void iniciarIds(VetorIds *vetor);
+
+/*
+ * Libera o vetor de IDs.
+ */
+void liberarIds(VetorIds *vetor);
+
+/*
+ * Acrescenta um ID ao vetor, dobrando a capacidade quando necessário.
+ * Retorna 0 se não houver memória.
+ */
+int adicionarId(VetorIds *vetor, int id);
+
+/*
+ * Inicializa um índice vazio.
+ */
+void iniciarTitulos(IndiceTitulos *indice);
+
+/*
+ * Libera a árvore, a tabela e as listas (os títulos não são liberados).
+ */
+void liberarTitulos(IndiceTitulos *indice);
+
+/*
+ * Acrescenta um livro ao índice: seu título entra na árvore radix e o ID
+ * entra na lista de cada n-grama do título. O título precisa estar no
+ * formato da arena e continuar válido enquanto o índice existir.
+ * Retorna 0 se não houver memória; o índice fica só com parte do título
+ * e deve ser descartado.
+ */
+int adicionarTitulo(IndiceTitulos *indice, const char *titulo, int id);
+
+/*
+ * Retira um livro da árvore radix. As listas de n-gramas não mudam; o
+ * livro só é contado em `removidos`.
+ */
+void removerTitulo(IndiceTitulos *indice, const char *titulo, int id);
+
+/*
+ * Junta em ids os IDs dos livros cujo título começa com o prefixo de
+ * `tamanho` bytes, em ordem de título. Custa o tamanho do prefixo mais o
+ * tamanho da subárvore encontrada.
+ * Retorna 0 se não houver memória.
+ */
+int buscarPrefixoTitulos(const IndiceTitulos *indice, const char *prefixo, size_t tamanho,
+                         VetorIds *ids);
+
+/*
+ * Junta em ids os candidatos para um trecho de pelo menos TAMANHO_NGRAMA
+ * bytes: a menor lista entre as dos n-gramas do trecho. Todo livro cujo
+ * título contém o trecho está entre os candidatos, mas nem todo candidato
+ * o contém (e pode até já ter sido removido); quem chama confere cada um
+ * com contemTrecho.
+ * Retorna 0 se não houver memória.
+ */
+int candidatosTrecho(const IndiceTitulos *indice, const char *trecho, size_t tamanho, VetorIds *ids);
+
+/*
+ * Retorna 1 se o título, com `tamanhoTitulo` bytes, contém o trecho de
+ * `tamanho` bytes.
+ */
+int contemTrecho(const char *titulo, size_t tamanhoTitulo, const char *trecho, size_t tamanho);
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * trava.c
+ *
+ * Implementação da trava de leitura e escrita dividida em fatias.
+ * Este arquivo contém todas as funções declaradas em trava.h.
+ */
+
+#include "trava.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Aloca as fatias alinhadas à linha de cache e inicializa a trava de cada
+ * uma. Se alguma falhar, as já criadas são destruídas.
+ */
+int iniciarTrava(TravaFatiada *trava)
+{
+  void *memoria;
+  trava->fatias = NULL;
+  if (posix_memalign(&memoria, TAMANHO_LINHA_CACHE, FATIAS_TRAVA * sizeof(FatiaTrava)) != 0)
+    return 0;
+  trava->fatias = (FatiaTrava *)memoria;
+
+  for (int i = 0; i < FATIAS_TRAVA; i++)
+  {
+    if (pthread_rwlock_init(&trava->fatias[i].trava, NULL) != 0)
+    {
+      while (i-- > 0)
+        pthread_rwlock_destroy(&trava->fatias[i].trava);
+      free(trava->fatias);
+      trava->fatias = NULL;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Destrói a trava de cada fatia e libera as fatias.
+ */
+void liberarTrava(TravaFatiada *trava)
+{
+  if (trava->fatias == NULL)
+    return;
+  for (int i = 0; i < FATIAS_TRAVA; i++)
+    pthread_rwlock_destroy(&trava->fatias[i].trava);
+  free(trava->fatias);
+  trava->fatias = NULL;
+}
+
+/*
+ * Multiplica o ID pela constante de Fibonacci e usa os bits altos, como o
+ * índice por ID, para espalhar IDs seguidos pelas fatias.
+ */
+int fatiaDoId(int id)
+{
+  uint32_t h = (uint32_t)id * 0x9E3779B1u;
+  return (int)(h >> 16) & (FATIAS_TRAVA - 1);
+}
+
+/*
+ * Trava uma fatia para leitura.
+ */
+void travarLeitura(TravaFatiada *trava, int fatia)
+{
+  pthread_rwlock_rdlock(&trava->fatias[fatia].trava);
+}
+
+/*
+ * Solta uma fatia travada para leitura.
+ */
+void destravarLeitura(TravaFatiada *trava, int fatia)
+{
+  pthread_rwlock_unlock(&trava->fatias[fatia].trava);
+}
+
+/*
+ * As fatias são sempre travadas da primeira à última, então dois
+ * escritores não podem ficar esperando um pelo outro.
+ */
+void travarEscrita(TravaFatiada *trava)
+{
+  for (int i = 0; i < FATIAS_TRAVA; i++)
+    pthread_rwlock_wrlock(&trava->fatias[i].trava);
+}
+
+/*
+ * Solta as fatias na ordem inversa.
+ */
+void destravarEscrita(TravaFatiada *trava)
+{
+  for (int i = FATIAS_TRAVA - 1; i >= 0; i--)
+    pthread_rwlock_unlock(&trava->fatias[i].trava);
+}
@@ -0,0 +1,85 @@
+/*
+ * trava.h
+ *
+ * Este arquivo contém as definições da trava de leitura e escrita usada
+ * pelas duas implementações da biblioteca para atender várias threads ao
+ * mesmo tempo: muitas buscas por ID em paralelo e, de vez em quando, uma
+ * alteração.
+ *
+ * Uma trava de leitura e escrita comum (pthread_rwlock_t) guarda a
+ * contagem de leitores numa única palavra, que toda busca altera ao
+ * entrar e ao sair. Com várias threads buscando, essa linha de cache passa
+ * de um processador para outro a cada busca, e o custo dela acaba maior
+ * que o da própria busca no índice. Por isso a trava é dividida em
+ * FATIAS_TRAVA fatias, cada uma na sua linha de cache: um leitor trava só
+ * uma fatia (escolhida pelo ID buscado), e um escritor trava todas, sempre
+ * na mesma ordem. Leitores de IDs diferentes quase nunca dividem a mesma
+ * linha, e o escritor continua excluindo todos eles.
+ */
+
+#ifndef TRAVA_H
+#define TRAVA_H
+
+#include <pthread.h>
+
+#define FATIAS_TRAVA 16        // Fatias da trava (potência de 2)
+#define TAMANHO_LINHA_CACHE 64 // Bytes de uma linha de cache
+
+/*
+ * Fatia da trava, ocupando uma linha de cache inteira para que fatias
+ * vizinhas não sejam invalidadas juntas.
+ */
+typedef union
+{
+  pthread_rwlock_t trava;          // Trava da fatia
+  char linha[TAMANHO_LINHA_CACHE]; // Preenchimento até o fim da linha
+} FatiaTrava;
+
+/*
+ * Trava de leitura e escrita dividida em fatias.
+ */
+typedef struct
+{
+  FatiaTrava *fatias; // FATIAS_TRAVA fatias, alinhadas à linha de cache
+} TravaFatiada;
+
+/*
+ * Aloca e inicializa as fatias.
+ * Retorna 0 se não houver memória ou se uma trava não puder ser criada.
+ */
+int iniciarTrava(TravaFatiada *trava);
+
+/*
+ * Destrói as fatias. Nenhuma thread pode estar com a trava.
+ */
+void liberarTrava(TravaFatiada *trava);
+
+/*
+ * Retorna a fatia que um leitor do ID deve travar. IDs seguidos caem em
+ * fatias diferentes.
+ */
+int fatiaDoId(int id);
+
+/*
+ * Trava uma fatia para leitura. Basta uma fatia para impedir que um
+ * escritor entre; outros leitores continuam entrando.
+ */
+void travarLeitura(TravaFatiada *trava, int fatia);
+
+/*
+ * Solta a fatia travada por travarLeitura.
+ */
+void destravarLeitura(TravaFatiada *trava, int fatia);
+
+/*
+ * Trava todas as fatias para escrita, em ordem, esperando os leitores de
+ * cada uma saírem.
+ */
+void travarEscrita(TravaFatiada *trava);
+
+/*
+ * Solta as fatias travadas por travarEscrita.
+ */
+void destravarEscrita(TravaFatiada *trava);
+
+#endif
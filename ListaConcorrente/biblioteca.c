@@ -0,0 +1,697 @@
+/*
+ * biblioteca.c
+ *
+ * Implementação das funções da biblioteca usando a lista de saltos
+ * concorrente sem travas.
+ * Este arquivo contém todas as funções declaradas em biblioteca.h.
+ */
+
+#include "biblioteca.h"
+
+#include <limits.h>
+
+#define MARCA_REMOVIDO ((uintptr_t)1) // Bit 0 de prox[k]: o nó foi removido no nível k
+
+/*
+ * Retorna o nó de um ponteiro de prox, sem a marca de removido.
+ */
+NoLivro *noDe(uintptr_t ponteiro)
+{
+  return (NoLivro *)(ponteiro & ~MARCA_REMOVIDO);
+}
+
+/*
+ * Retorna 1 se o ponteiro de prox tem a marca de removido.
+ */
+int marcado(uintptr_t ponteiro)
+{
+  return (ponteiro & MARCA_REMOVIDO) != 0;
+}
+
+/*
+ * Aloca um nó com `nivel` níveis, todos apontando para o fim da lista.
+ * Retorna NULL se não houver memória.
+ */
+NoLivro *alocarNoLivro(int nivel)
+{
+  NoLivro *no = (NoLivro *)malloc(sizeof(NoLivro) + nivel * sizeof(_Atomic uintptr_t));
+  if (no == NULL)
+    return NULL;
+  no->id = 0;
+  no->nivel = nivel;
+  atomic_init(&no->disponivel, 1);
+  atomic_init(&no->donos, 2);
+  no->titulo = NULL;
+  no->autor = NULL;
+  no->proxRetirado = NULL;
+  for (int k = 0; k < nivel; k++)
+    atomic_init(&no->prox[k], (uintptr_t)0);
+  return no;
+}
+
+/*
+ * Cria uma nova biblioteca vazia, só com o nó sentinela.
+ */
+Biblioteca *criarBiblioteca()
+{
+  Biblioteca *bib = (Biblioteca *)malloc(sizeof(Biblioteca));
+  if (bib == NULL)
+    return NULL;
+  bib->cabeca = alocarNoLivro(MAX_NIVEL_CONCORRENTE);
+  if (bib->cabeca == NULL)
+  {
+    free(bib);
+    return NULL;
+  }
+  atomic_init(&bib->quantidade, 0);
+  atomic_init(&bib->epoca, 0);
+  atomic_init(&bib->sessoes, NULL);
+  return bib;
+}
+
+/*
+ * Libera uma lista de nós retirados.
+ */
+void liberarRetirados(NoLivro *no)
+{
+  while (no != NULL)
+  {
+    NoLivro *prox = no->proxRetirado;
+    free(no);
+    no = prox;
+  }
+}
+
+/*
+ * Libera toda a memória da biblioteca.
+ * Sem threads usando a biblioteca, todo nó ou está na lista base (os
+ * níveis de cima apontam para os mesmos nós) ou numa lista de retirados
+ * de alguma sessão, nunca nos dois.
+ */
+void destruirBiblioteca(Biblioteca *bib)
+{
+  if (bib == NULL)
+    return;
+
+  NoLivro *no = bib->cabeca;
+  while (no != NULL)
+  {
+    NoLivro *prox = noDe(atomic_load(&no->prox[0]));
+    free(no);
+    no = prox;
+  }
+
+  Sessao *sessao = atomic_load(&bib->sessoes);
+  while (sessao != NULL)
+  {
+    Sessao *prox = sessao->prox;
+    for (int i = 0; i < 3; i++)
+      liberarRetirados(sessao->retirados[i]);
+    liberarArena(&sessao->textos);
+    free(sessao);
+    sessao = prox;
+  }
+  free(bib);
+}
+
+/*
+ * Abre uma sessão: primeiro tenta tomar uma sessão fechada com um CAS em
+ * emUso; se todas estiverem em uso, cria uma e a coloca no início da
+ * lista de sessões, também com CAS.
+ */
+Sessao *abrirSessao(Biblioteca *bib)
+{
+  for (Sessao *sessao = atomic_load(&bib->sessoes); sessao != NULL; sessao = sessao->prox)
+  {
+    int livre = 0;
+    if (atomic_compare_exchange_strong(&sessao->emUso, &livre, 1))
+      return sessao;
+  }
+
+  Sessao *sessao = (Sessao *)malloc(sizeof(Sessao));
+  if (sessao == NULL)
+    return NULL;
+  sessao->bib = bib;
+  atomic_init(&sessao->estado, 0);
+  atomic_init(&sessao->emUso, 1);
+  for (int i = 0; i < 3; i++)
+  {
+    sessao->retirados[i] = NULL;
+    sessao->epocaRetirados[i] = 0;
+  }
+  sessao->retiradosSemAvanco = 0;
+  sessao->semente = 2463534242u ^ (uint32_t)(uintptr_t)sessao;
+  iniciarArena(&sessao->textos);
+
+  sessao->prox = atomic_load(&bib->sessoes);
+  while (!atomic_compare_exchange_weak(&bib->sessoes, &sessao->prox, sessao))
+    ;
+  return sessao;
+}
+
+/*
+ * Devolve a sessão para ser reaproveitada.
+ */
+void fecharSessao(Sessao *sessao)
+{
+  atomic_store(&sessao->emUso, 0);
+}
+
+/*
+ * Começa uma operação: anuncia a época global atual e libera as listas de
+ * retirados da sessão que já ficaram duas épocas para trás.
+ *
+ * Se a época avançar entre a leitura e o anúncio, a sessão anuncia uma
+ * época velha; isso só segura o próximo avanço, e os nós que ela passa a
+ * ler ainda estão na lista, então nenhum deles foi retirado antes.
+ */
+void entrarOperacao(Sessao *sessao)
+{
+  uint64_t epoca = atomic_load(&sessao->bib->epoca);
+  atomic_store(&sessao->estado, epoca * 2 + 1);
+  for (int i = 0; i < 3; i++)
+  {
+    if (sessao->retirados[i] != NULL && sessao->epocaRetirados[i] + 2 <= epoca)
+    {
+      liberarRetirados(sessao->retirados[i]);
+      sessao->retirados[i] = NULL;
+    }
+  }
+}
+
+/*
+ * Termina uma operação: a sessão deixa de segurar a época.
+ */
+void sairOperacao(Sessao *sessao)
+{
+  atomic_store(&sessao->estado, 0);
+}
+
+/*
+ * Avança a época global se todas as sessões que estão numa operação já
+ * entraram na época atual. Se outra thread avançar antes, o CAS falha e
+ * não há nada a fazer.
+ */
+void tentarAvancarEpoca(Biblioteca *bib)
+{
+  uint64_t epoca = atomic_load(&bib->epoca);
+  for (Sessao *sessao = atomic_load(&bib->sessoes); sessao != NULL; sessao = sessao->prox)
+  {
+    uint64_t estado = atomic_load(&sessao->estado);
+    if (estado != 0 && estado / 2 != epoca)
+      return;
+  }
+  atomic_compare_exchange_strong(&bib->epoca, &epoca, epoca + 1);
+}
+
+/*
+ * Retira um nó que já saiu da lista: ele vai para a lista de retirados da
+ * época global atual. A lista da mesma posição, se for de uma época
+ * anterior, é de pelo menos três épocas atrás e já pode ser liberada.
+ */
+void retirarNo(Sessao *sessao, NoLivro *no)
+{
+  uint64_t epoca = atomic_load(&sessao->bib->epoca);
+  int i = (int)(epoca % 3);
+  if (sessao->epocaRetirados[i] != epoca)
+  {
+    liberarRetirados(sessao->retirados[i]);
+    sessao->retirados[i] = NULL;
+    sessao->epocaRetirados[i] = epoca;
+  }
+  no->proxRetirado = sessao->retirados[i];
+  sessao->retirados[i] = no;
+
+  if (++sessao->retiradosSemAvanco >= RETIRADOS_POR_AVANCO)
+  {
+    sessao->retiradosSemAvanco = 0;
+    tentarAvancarEpoca(sessao->bib);
+  }
+}
+
+/*
+ * A inserção ou a remoção de um nó terminou de mexer nos seus níveis.
+ * A última das duas retira o nó.
+ */
+void soltarNo(Sessao *sessao, NoLivro *no)
+{
+  if (atomic_fetch_sub(&no->donos, 1) == 1)
+    retirarNo(sessao, no);
+}
+
+/*
+ * Sorteia quantos níveis um novo nó terá (pelo menos 1).
+ * Cada nível é alcançado com probabilidade 1/4 do anterior, como na lista
+ * de saltos da Lista Dinâmica. O sorteio é um xorshift da sessão, sem a
+ * trava interna de rand().
+ */
+int sortearNivelConcorrente(Sessao *sessao)
+{
+  int nivel = 1;
+  while (nivel < MAX_NIVEL_CONCORRENTE)
+  {
+    uint32_t x = sessao->semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sessao->semente = x;
+    if ((x & 3) != 0)
+      break;
+    nivel++;
+  }
+  return nivel;
+}
+
+/*
+ * Procura, em cada nível, o último nó com ID menor que o informado
+ * (anteriores) e o nó seguinte a ele (seguintes), descendo do nível mais
+ * alto até a lista base.
+ *
+ * Cada nó marcado encontrado no caminho é tirado do nível com um CAS no
+ * anterior. Se o CAS falhar (o anterior mudou ou também foi marcado), a
+ * procura recomeça da cabeça.
+ * Retorna 1 se seguintes[0] tem o ID procurado.
+ */
+int procurarAnteriores(Biblioteca *bib, int id, NoLivro *anteriores[], NoLivro *seguintes[])
+{
+  int refazer;
+  do
+  {
+    refazer = 0;
+    NoLivro *anterior = bib->cabeca;
+    for (int nivel = MAX_NIVEL_CONCORRENTE - 1; nivel >= 0 && !refazer; nivel--)
+    {
+      NoLivro *atual = noDe(atomic_load(&anterior->prox[nivel]));
+      while (atual != NULL)
+      {
+        uintptr_t seguinte = atomic_load(&atual->prox[nivel]);
+        if (marcado(seguinte))
+        {
+          uintptr_t esperado = (uintptr_t)atual;
+          if (!atomic_compare_exchange_strong(&anterior->prox[nivel], &esperado, seguinte & ~MARCA_REMOVIDO))
+          {
+            refazer = 1;
+            break;
+          }
+          atual = noDe(seguinte);
+        }
+        else if (atual->id < id)
+        {
+          anterior = atual;
+          atual = noDe(seguinte);
+        }
+        else
+        {
+          break;
+        }
+      }
+      anteriores[nivel] = anterior;
+      seguintes[nivel] = atual;
+    }
+  } while (refazer);
+  return seguintes[0] != NULL && seguintes[0]->id == id;
+}
+
+/*
+ * Acha o primeiro nó não removido com ID maior ou igual a `id` (NULL se
+ * não houver), descendo pelos níveis como procurarAnteriores, mas só
+ * pulando os nós marcados, sem tirá-los da lista e sem nenhum CAS.
+ */
+NoLivro *primeiroAPartir(Biblioteca *bib, int id)
+{
+  NoLivro *anterior = bib->cabeca;
+  NoLivro *atual = NULL;
+  for (int nivel = MAX_NIVEL_CONCORRENTE - 1; nivel >= 0; nivel--)
+  {
+    atual = noDe(atomic_load(&anterior->prox[nivel]));
+    while (atual != NULL)
+    {
+      uintptr_t seguinte = atomic_load(&atual->prox[nivel]);
+      if (marcado(seguinte))
+      {
+        atual = noDe(seguinte);
+      }
+      else if (atual->id < id)
+      {
+        anterior = atual;
+        atual = noDe(seguinte);
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+  return atual;
+}
+
+/*
+ * Insere um nó com os textos já na arena da sessão.
+ *
+ * Como funciona:
+ * 1. Procura os anteriores e seguintes do ID em cada nível
+ * 2. Aponta cada nível do nó novo para o seguinte e o liga na lista base
+ *    com um CAS no anterior; se o CAS falhar, procura de novo
+ * 3. Liga os níveis de cima, um a um, do mesmo jeito, parando se o nó
+ *    for removido nesse meio tempo (a marca faz o CAS no nó novo falhar)
+ * 4. Se o nó foi removido, procura o ID mais uma vez, para tirá-lo dos
+ *    níveis que esta inserção ligou depois da procura da remoção
+ *
+ * Retorna 1 se o nó foi inserido, 0 se o ID já existia ou faltou memória.
+ */
+int inserirNo(Sessao *sessao, int id, char *titulo, char *autor, int disponivel)
+{
+  Biblioteca *bib = sessao->bib;
+  NoLivro *anteriores[MAX_NIVEL_CONCORRENTE];
+  NoLivro *seguintes[MAX_NIVEL_CONCORRENTE];
+  NoLivro *novo = NULL;
+
+  for (;;)
+  {
+    if (procurarAnteriores(bib, id, anteriores, seguintes))
+    {
+      free(novo); // Nunca foi publicado
+      return 0;
+    }
+    if (novo == NULL)
+    {
+      novo = alocarNoLivro(sortearNivelConcorrente(sessao));
+      if (novo == NULL)
+        return 0;
+      novo->id = id;
+      novo->titulo = titulo;
+      novo->autor = autor;
+      atomic_store(&novo->disponivel, disponivel);
+    }
+    for (int k = 0; k < novo->nivel; k++)
+      atomic_store(&novo->prox[k], (uintptr_t)seguintes[k]);
+    uintptr_t esperado = (uintptr_t)seguintes[0];
+    if (atomic_compare_exchange_strong(&anteriores[0]->prox[0], &esperado, (uintptr_t)novo))
+      break;
+  }
+  atomic_fetch_add(&bib->quantidade, 1);
+
+  for (int k = 1; k < novo->nivel; k++)
+  {
+    int ligado = 0;
+    while (!ligado)
+    {
+      uintptr_t proximo = atomic_load(&novo->prox[k]);
+      if (marcado(proximo))
+        break;
+      if (proximo != (uintptr_t)seguintes[k] &&
+          !atomic_compare_exchange_strong(&novo->prox[k], &proximo, (uintptr_t)seguintes[k]))
+        break; // Só falha se a remoção marcou o nível
+      uintptr_t esperado = (uintptr_t)seguintes[k];
+      ligado = atomic_compare_exchange_strong(&anteriores[k]->prox[k], &esperado, (uintptr_t)novo);
+      if (!ligado)
+        procurarAnteriores(bib, id, anteriores, seguintes);
+    }
+    if (!ligado)
+      break;
+  }
+
+  if (marcado(atomic_load(&novo->prox[0])))
+    procurarAnteriores(bib, id, anteriores, seguintes);
+  soltarNo(sessao, novo);
+  return 1;
+}
+
+/*
+ * Insere um livro, copiando título e autor para a arena da sessão.
+ * Os textos de uma inserção que não acontece ficam na arena até a
+ * biblioteca ser destruída, como os de livros removidos.
+ */
+int inserirLivro(Sessao *sessao, int id, const char *titulo, const char *autor)
+{
+  char *tituloArena = guardarTexto(&sessao->textos, titulo, strlen(titulo));
+  char *autorArena = guardarTexto(&sessao->textos, autor, strlen(autor));
+  if (tituloArena == NULL || autorArena == NULL)
+    return 0;
+
+  entrarOperacao(sessao);
+  int ok = inserirNo(sessao, id, tituloArena, autorArena, 1);
+  sairOperacao(sessao);
+  return ok;
+}
+
+/*
+ * Remove um livro pelo ID.
+ *
+ * Como funciona:
+ * 1. Acha o nó e marca os seus níveis de cima, do mais alto para baixo
+ * 2. Marca o nível 0 com um fetch-or: se ele já estava marcado, outra
+ *    thread removeu o livro antes e nada mais é feito
+ * 3. Procura o ID de novo, o que tira o nó de todos os níveis
+ */
+int removerLivro(Sessao *sessao, int id)
+{
+  Biblioteca *bib = sessao->bib;
+  NoLivro *anteriores[MAX_NIVEL_CONCORRENTE];
+  NoLivro *seguintes[MAX_NIVEL_CONCORRENTE];
+  int removido = 0;
+
+  entrarOperacao(sessao);
+  if (procurarAnteriores(bib, id, anteriores, seguintes))
+  {
+    NoLivro *alvo = seguintes[0];
+    for (int k = alvo->nivel - 1; k >= 1; k--)
+      atomic_fetch_or(&alvo->prox[k], MARCA_REMOVIDO);
+    removido = !marcado(atomic_fetch_or(&alvo->prox[0], MARCA_REMOVIDO));
+    if (removido)
+    {
+      atomic_fetch_sub(&bib->quantidade, 1);
+      procurarAnteriores(bib, id, anteriores, seguintes);
+      soltarNo(sessao, alvo);
+    }
+  }
+  sairOperacao(sessao);
+  return removido;
+}
+
+/*
+ * Copia os dados de um nó para um livro.
+ */
+void copiarLivro(const NoLivro *no, Livro *copia)
+{
+  copia->id = no->id;
+  copia->disponivel = atomic_load(&no->disponivel);
+  copia->titulo = no->titulo;
+  copia->autor = no->autor;
+}
+
+/*
+ * Busca um livro pelo ID com primeiroAPartir.
+ */
+int buscarLivro(Sessao *sessao, int id, Livro *copia)
+{
+  entrarOperacao(sessao);
+  NoLivro *no = primeiroAPartir(sessao->bib, id);
+  int achou = no != NULL && no->id == id;
+  if (achou)
+    copiarLivro(no, copia);
+  sairOperacao(sessao);
+  return achou;
+}
+
+/*
+ * Troca o status de um livro de `de` para `para` com um CAS, se o livro
+ * existir.
+ * Retorna 1 se esta chamada fez a troca.
+ */
+int trocarDisponivel(Sessao *sessao, int id, int de, int para)
+{
+  entrarOperacao(sessao);
+  NoLivro *no = primeiroAPartir(sessao->bib, id);
+  int trocou = no != NULL && no->id == id && atomic_compare_exchange_strong(&no->disponivel, &de, para);
+  sairOperacao(sessao);
+  return trocou;
+}
+
+/*
+ * Marca um livro como emprestado.
+ */
+int emprestarLivro(Sessao *sessao, int id)
+{
+  return trocarDisponivel(sessao, id, 1, 0);
+}
+
+/*
+ * Marca um livro como devolvido.
+ */
+int devolverLivro(Sessao *sessao, int id)
+{
+  return trocarDisponivel(sessao, id, 0, 1);
+}
+
+/*
+ * Percorre a lista base a partir do primeiro nó da faixa, pulando os nós
+ * marcados. Um nó marcado continua apontando para o seguinte que tinha
+ * quando foi removido, então o percurso segue adiante mesmo que o nó
+ * atual saia da lista.
+ */
+int percorrerFaixa(Sessao *sessao, int primeiro, int ultimo, VisitarLivro visitar, void *contexto)
+{
+  int ok = 1;
+  entrarOperacao(sessao);
+  NoLivro *no = primeiroAPartir(sessao->bib, primeiro);
+  while (ok && no != NULL && no->id <= ultimo)
+  {
+    uintptr_t seguinte = atomic_load(&no->prox[0]);
+    if (!marcado(seguinte))
+    {
+      Livro livro;
+      copiarLivro(no, &livro);
+      ok = visitar(&livro, contexto);
+    }
+    no = noDe(seguinte);
+  }
+  sairOperacao(sessao);
+  return ok;
+}
+
+/*
+ * Percorre a faixa de todos os IDs.
+ */
+int percorrerLivros(Sessao *sessao, VisitarLivro visitar, void *contexto)
+{
+  return percorrerFaixa(sessao, INT_MIN, INT_MAX, visitar, contexto);
+}
+
+/*
+ * Estado da listagem: a saída em buffer e quantos livros foram escritos.
+ */
+typedef struct
+{
+  Saida saida;  // Saída em buffer
+  size_t total; // Livros escritos
+} Listagem;
+
+/*
+ * Escreve um livro na listagem (usado com percorrerLivros).
+ */
+int listarLivro(const Livro *livro, void *contexto)
+{
+  Listagem *listagem = (Listagem *)contexto;
+  escreverLivro(&listagem->saida, livro->id, livro->titulo, livro->autor, livro->disponivel);
+  listagem->total++;
+  return 1;
+}
+
+/*
+ * Lista os livros no descritor fd, com a mesma saída em buffer das outras
+ * implementações.
+ */
+int listarLivrosDescritor(Sessao *sessao, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = percorrerLivros(sessao, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Biblioteca vazia!\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Retorna o contador de livros.
+ */
+long quantidadeLivros(Biblioteca *bib)
+{
+  return atomic_load(&bib->quantidade);
+}
+
+/*
+ * Insere os registros lidos, com os textos já na arena da sessão. Um ID
+ * que já existe só tem a disponibilidade atualizada.
+ */
+void inserirRegistros(Sessao *sessao, const VetorRegistros *registros)
+{
+  for (size_t i = 0; i < registros->quantidade; i++)
+  {
+    const RegistroLivro *registro = &registros->itens[i];
+    entrarOperacao(sessao);
+    if (!inserirNo(sessao, registro->id, registro->titulo, registro->autor, registro->disponivel))
+    {
+      NoLivro *no = primeiroAPartir(sessao->bib, registro->id);
+      if (no != NULL && no->id == registro->id)
+        atomic_store(&no->disponivel, registro->disponivel);
+    }
+    sairOperacao(sessao);
+  }
+}
+
+/*
+ * Carrega livros de um arquivo.
+ * O arquivo é lido inteiro para um vetor de registros, por lerSnapshot ou
+ * por lerRegistrosTexto (em paralelo), numa arena à parte que depois passa
+ * para a sessão sem cópia dos textos. Os registros são ordenados por ID
+ * antes da inserção, então cada procura desce pelo mesmo caminho da
+ * anterior, que já está na cache.
+ */
+void carregarLivros(Sessao *sessao, const char *nomeArquivo)
+{
+  FILE *arquivo = fopen(nomeArquivo, "rb");
+  if (arquivo == NULL)
+  {
+    printf("Erro ao abrir arquivo para leitura.\n");
+    return;
+  }
+
+  Arena textos;
+  VetorRegistros registros;
+  iniciarArena(&textos);
+  iniciarRegistros(&registros);
+  int snapshot = ehSnapshot(arquivo);
+  int ok = snapshot ? lerSnapshot(arquivo, &textos, &registros) : lerRegistrosTexto(arquivo, 0, &textos, &registros);
+  fclose(arquivo);
+  juntarArena(&sessao->textos, &textos);
+
+  if (ok && !snapshot)
+    ok = ordenarRegistros(&registros);
+  if (ok)
+  {
+    inserirRegistros(sessao, &registros);
+    printf("Livros carregados com sucesso!\n");
+  }
+  else if (snapshot)
+  {
+    printf("Arquivo inválido ou memória insuficiente para carregar os livros.\n");
+  }
+  else
+  {
+    printf("Erro ao ler o arquivo ou memória insuficiente para carregar os livros.\n");
+  }
+  liberarRegistros(&registros);
+}
+
+/*
+ * Acrescenta um livro ao vetor de registros (usado com percorrerLivros).
+ */
+int guardarRegistro(const Livro *livro, void *contexto)
+{
+  RegistroLivro registro = {livro->id, livro->disponivel, livro->titulo, livro->autor};
+  return adicionarRegistro((VetorRegistros *)contexto, &registro);
+}
+
+/*
+ * Junta os livros em ordem num vetor de registros e grava tudo de uma vez
+ * com salvarSnapshot, como as outras implementações.
+ */
+int salvarLivrosBinario(Sessao *sessao, FILE *arquivo)
+{
+  if (arquivo == NULL)
+    return 0;
+
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  int ok = percorrerLivros(sessao, guardarRegistro, &registros) &&
+           salvarSnapshot(arquivo, registros.itens, registros.quantidade);
+  liberarRegistros(&registros);
+  return ok;
+}
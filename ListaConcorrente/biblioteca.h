@@ -0,0 +1,236 @@
+/*
+ * biblioteca.h
+ *
+ * Este arquivo contém as definições para o sistema de biblioteca usando
+ * uma lista de saltos concorrente sem travas. Várias threads podem
+ * inserir, remover, buscar, emprestar e devolver livros ao mesmo tempo,
+ * sem nenhuma trava global: cada alteração é feita com compare-and-swap
+ * (CAS) nos ponteiros da lista, então uma thread parada no meio de uma
+ * operação não impede as outras de terminarem as suas.
+ *
+ * A lista segue o algoritmo de Fraser (e de Herlihy e Shavit): um nó é
+ * removido em duas etapas. Primeiro ele é marcado, ligando o bit 0 dos
+ * seus ponteiros para o próximo nó em cada nível (o do nível 0 decide a
+ * remoção); depois, qualquer thread que passe por ele na procura o tira
+ * da lista com um CAS no nó anterior. Como o bit marca o ponteiro do
+ * próprio nó removido, nenhuma inserção consegue ligar um nó novo depois
+ * de um nó já removido.
+ *
+ * Um nó tirado da lista ainda pode estar sendo lido por outra thread, então
+ * não pode ser liberado na hora. A memória é recuperada por épocas: cada
+ * thread abre uma sessão e, durante cada operação, anuncia a época global
+ * em que entrou. Um nó retirado na época e só é liberado quando a época
+ * global chega a e + 2, o que só acontece depois que todas as threads que
+ * estavam numa operação na época e saíram dela. Títulos e autores ficam
+ * na arena da sessão que inseriu o livro e, como nas outras
+ * implementações, só são liberados quando a biblioteca é destruída.
+ *
+ * Esta implementação oferece as operações básicas das outras (inserir,
+ * remover, buscar, emprestar, devolver, percorrer, listar, carregar e
+ * salvar); os índices secundários, o catálogo mapeado e o diário ficam
+ * só nelas.
+ */
+
+#ifndef BIBLIOTECA_H
+#define BIBLIOTECA_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Comum/arena.h"
+#include "../Comum/leitor.h"
+#include "../Comum/registro.h"
+#include "../Comum/saida.h"
+#include "../Comum/snapshot.h"
+
+#define MAX_NIVEL_CONCORRENTE 16 // Níveis da lista de saltos, contando a lista base
+#define RETIRADOS_POR_AVANCO 64  // Nós retirados por uma sessão entre duas tentativas de avançar a época
+
+/*
+ * Estrutura que representa um livro, como é passado para quem busca ou
+ * percorre a biblioteca (uma cópia dos dados do nó).
+ */
+typedef struct
+{
+  int id;         // ID único do livro
+  int disponivel; // 1 se disponível, 0 se emprestado
+  char *titulo;   // Título do livro (na arena de uma sessão)
+  char *autor;    // Nome do autor (na arena de uma sessão)
+} Livro;
+
+/*
+ * Nó da lista de saltos.
+ * prox tem um ponteiro para cada nível em que o nó está; o bit 0 de
+ * prox[k] ligado marca o nó como removido no nível k.
+ *
+ * donos conta a inserção e a remoção do nó que ainda não terminaram de
+ * mexer nos seus níveis (começa em 2: a inserção e a lista). Quem o zera
+ * retira o nó, então ele só é retirado depois de a remoção o tirar da
+ * lista e de a inserção parar de ligá-lo nos níveis de cima.
+ */
+typedef struct NoLivro
+{
+  int id;                       // ID único do livro
+  int nivel;                    // Níveis em que o nó está (tamanho de prox)
+  atomic_int disponivel;        // 1 se disponível, 0 se emprestado
+  atomic_int donos;             // Inserção e remoção ainda usando os níveis do nó
+  char *titulo;                 // Título do livro (na arena da sessão que o inseriu)
+  char *autor;                  // Nome do autor (na arena da sessão que o inseriu)
+  struct NoLivro *proxRetirado; // Próximo nó na lista de retirados da sessão
+  _Atomic uintptr_t prox[];     // Próximo nó em cada nível, com a marca de removido no bit 0
+} NoLivro;
+
+/*
+ * Sessão de uma thread na biblioteca.
+ * Cada thread abre a sua com abrirSessao e a passa a todas as operações.
+ * As sessões nunca são liberadas antes da biblioteca: uma sessão fechada
+ * é reaproveitada pela próxima thread que abrir uma.
+ *
+ * estado é 0 fora das operações e 2e + 1 durante uma operação que entrou
+ * na época e. Os nós retirados ficam em três listas, uma por época módulo
+ * 3, e são liberados pela própria sessão quando a época global passa da
+ * época da lista mais 1.
+ */
+typedef struct Sessao
+{
+  struct Biblioteca *bib;     // Biblioteca da sessão
+  _Atomic uint64_t estado;    // Época da operação em andamento (2e + 1) ou 0
+  atomic_int emUso;           // 1 enquanto alguma thread usa a sessão
+  struct Sessao *prox;        // Próxima sessão da biblioteca
+  NoLivro *retirados[3];      // Nós retirados, separados por época módulo 3
+  uint64_t epocaRetirados[3]; // Época em que os nós de cada lista foram retirados
+  int retiradosSemAvanco;     // Nós retirados desde a última tentativa de avançar a época
+  uint32_t semente;           // Estado do sorteio de níveis
+  Arena textos;               // Títulos e autores dos livros inseridos pela sessão
+} Sessao;
+
+/*
+ * Estrutura principal da biblioteca.
+ * A cabeça é um nó sentinela com todos os níveis, que vem antes de
+ * qualquer ID; o fim da lista é NULL.
+ */
+typedef struct Biblioteca
+{
+  NoLivro *cabeca;           // Nó sentinela com MAX_NIVEL_CONCORRENTE níveis
+  atomic_long quantidade;    // Livros na lista
+  _Atomic uint64_t epoca;    // Época global
+  _Atomic(Sessao *) sessoes; // Sessões já abertas (em uso ou para reaproveitar)
+} Biblioteca;
+
+/*
+ * Função chamada para cada livro por percorrerLivros e percorrerFaixa.
+ * Retorna 0 para interromper o percurso.
+ */
+typedef int (*VisitarLivro)(const Livro *livro, void *contexto);
+
+/*
+ * Cria uma nova biblioteca vazia.
+ * Retorna um ponteiro para a biblioteca criada ou NULL se houver erro.
+ */
+Biblioteca *criarBiblioteca();
+
+/*
+ * Libera os nós, as sessões e os textos. Nenhuma thread pode estar usando
+ * a biblioteca.
+ */
+void destruirBiblioteca(Biblioteca *bib);
+
+/*
+ * Abre uma sessão para a thread que chama, reaproveitando uma sessão
+ * fechada se houver.
+ * Retorna NULL se não houver memória.
+ */
+Sessao *abrirSessao(Biblioteca *bib);
+
+/*
+ * Fecha a sessão; a thread não pode mais usá-la. Os nós retirados por ela
+ * que ainda não puderam ser liberados esperam na sessão até ela ser
+ * reaproveitada ou a biblioteca ser destruída.
+ */
+void fecharSessao(Sessao *sessao);
+
+/*
+ * Insere um novo livro na biblioteca. O título e o autor são copiados para
+ * a arena da sessão.
+ * Retorna 1 se o livro foi inserido e 0 se o ID já existia ou não houve
+ * memória.
+ */
+int inserirLivro(Sessao *sessao, int id, const char *titulo, const char *autor);
+
+/*
+ * Remove um livro da biblioteca pelo ID. Se duas threads removerem o
+ * mesmo livro ao mesmo tempo, só uma consegue.
+ * Retorna 1 se o livro foi removido por esta chamada.
+ */
+int removerLivro(Sessao *sessao, int id);
+
+/*
+ * Busca um livro pelo ID sem alterar nada (nem ajudar a tirar nós
+ * removidos da lista). Os dados do livro são copiados para *copia; título
+ * e autor continuam válidos até a biblioteca ser destruída.
+ * Retorna 1 se o livro foi encontrado.
+ */
+int buscarLivro(Sessao *sessao, int id, Livro *copia);
+
+/*
+ * Marca um livro como emprestado, se ele existir e estiver disponível.
+ * Retorna 1 se o livro foi emprestado por esta chamada.
+ */
+int emprestarLivro(Sessao *sessao, int id);
+
+/*
+ * Marca um livro como devolvido, se ele existir e estiver emprestado.
+ * Retorna 1 se o livro foi devolvido por esta chamada.
+ */
+int devolverLivro(Sessao *sessao, int id);
+
+/*
+ * Visita, em ordem de ID, os livros com ID entre primeiro e ultimo
+ * (inclusive). As outras threads continuam alterando a lista durante a
+ * visita: cada livro visitado estava na lista quando foi lido, e um livro
+ * que ficou na lista do começo ao fim da visita é sempre visitado.
+ * Enquanto a visita durar, nenhum nó retirado é liberado.
+ * Retorna 0 se a visita for interrompida.
+ */
+int percorrerFaixa(Sessao *sessao, int primeiro, int ultimo, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita todos os livros em ordem de ID, como percorrerFaixa.
+ * Retorna 0 se a visita for interrompida.
+ */
+int percorrerLivros(Sessao *sessao, VisitarLivro visitar, void *contexto);
+
+/*
+ * Lista todos os livros em ordem no descritor de arquivo fd, no mesmo
+ * formato das outras implementações. O descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarLivrosDescritor(Sessao *sessao, int fd);
+
+/*
+ * Conta os livros da biblioteca em O(1). Com outras threads alterando a
+ * lista, o valor pode já ter mudado quando for usado.
+ */
+long quantidadeLivros(Biblioteca *bib);
+
+/*
+ * Carrega livros de um arquivo para a biblioteca, no formato binário
+ * (snapshot) ou texto, reconhecido pelo início do arquivo. Os textos lidos
+ * passam para a arena da sessão. Um ID que já existe só tem a
+ * disponibilidade atualizada. Outras threads podem usar a biblioteca
+ * durante a carga.
+ */
+void carregarLivros(Sessao *sessao, const char *nomeArquivo);
+
+/*
+ * Salva todos os livros em um arquivo no formato binário (snapshot), em
+ * ordem de ID. Com outras threads alterando a lista, o arquivo tem os
+ * livros vistos pelo percurso, como em percorrerLivros.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int salvarLivrosBinario(Sessao *sessao, FILE *arquivo);
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * medir_concorrencia.c
+ *
+ * Mede quantas operações por segundo a lista de saltos concorrente atende
+ * quando várias threads inserem, removem e buscam ao mesmo tempo. Carrega
+ * livros.dat e, para 1, 2, 4, ... threads, cada thread faz
+ * OPERACOES_POR_THREAD operações com IDs sorteados entre 1 e o dobro do
+ * maior ID carregado: a porcentagem de escritas pedida (metade inserções,
+ * metade remoções) e buscas no resto. Com metade da faixa ocupada,
+ * inserções e remoções dão certo na mesma proporção e a quantidade de
+ * livros fica estável.
+ *
+ * Uso: ./medir_concorrencia [porcentagem de escritas] [máximo de threads]
+ */
+
+#include "biblioteca.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OPERACOES_POR_THREAD 1000000 // Operações feitas por cada thread
+#define MAX_THREADS 256              // Maior quantidade de threads aceita
+
+/*
+ * Dados de uma thread.
+ */
+typedef struct
+{
+  Biblioteca *bib;     // Biblioteca usada
+  int faixa;           // IDs sorteados entre 1 e faixa
+  int escritas;        // Porcentagem de operações que alteram a lista
+  uint32_t semente;    // Estado do sorteio da thread
+  long long inseridos; // Inserções que deram certo
+  long long removidos; // Remoções que deram certo
+  long long achados;   // Buscas que encontraram o livro
+  int erro;            // Não conseguiu abrir a sessão
+} Operadora;
+
+/*
+ * Sorteia o próximo número da thread (xorshift de 32 bits).
+ */
+uint32_t sortear(uint32_t *semente)
+{
+  uint32_t x = *semente;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *semente = x;
+  return x;
+}
+
+/*
+ * Corpo de cada thread: abre a sua sessão e faz as operações.
+ */
+void *executarOperadora(void *argumento)
+{
+  Operadora *operadora = (Operadora *)argumento;
+  Sessao *sessao = abrirSessao(operadora->bib);
+  if (sessao == NULL)
+  {
+    operadora->erro = 1;
+    return NULL;
+  }
+
+  for (int i = 0; i < OPERACOES_POR_THREAD; i++)
+  {
+    int id = 1 + (int)(sortear(&operadora->semente) % (uint32_t)operadora->faixa);
+    int sorteio = (int)(sortear(&operadora->semente) % 200);
+    Livro livro;
+    if (sorteio < operadora->escritas)
+      operadora->inseridos += inserirLivro(sessao, id, "Livro novo", "Autor novo");
+    else if (sorteio < 2 * operadora->escritas)
+      operadora->removidos += removerLivro(sessao, id);
+    else
+      operadora->achados += buscarLivro(sessao, id, &livro);
+  }
+  fecharSessao(sessao);
+  return NULL;
+}
+
+/*
+ * Retorna o tempo de relógio atual em segundos.
+ */
+double agora()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/*
+ * Mede uma rodada com `threads` threads. O número da rodada muda as
+ * sementes, para que uma rodada não repita as operações da anterior (e
+ * encontre tudo já inserido ou removido).
+ * Retorna as operações por segundo, ou um valor negativo se uma thread
+ * não puder ser criada ou abrir a sessão.
+ */
+double medirRodada(Biblioteca *bib, int faixa, int escritas, int rodada, int threads, long long *alteracoes)
+{
+  Operadora operadoras[MAX_THREADS];
+  pthread_t ids[MAX_THREADS];
+
+  double inicio = agora();
+  int criadas = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    operadoras[i].bib = bib;
+    operadoras[i].faixa = faixa;
+    operadoras[i].escritas = escritas;
+    operadoras[i].semente = 0x9E3779B1u * (uint32_t)(rodada * MAX_THREADS + i + 1);
+    operadoras[i].inseridos = 0;
+    operadoras[i].removidos = 0;
+    operadoras[i].achados = 0;
+    operadoras[i].erro = 0;
+    if (pthread_create(&ids[i], NULL, executarOperadora, &operadoras[i]) != 0)
+      break;
+    criadas++;
+  }
+  for (int i = 0; i < criadas; i++)
+    pthread_join(ids[i], NULL);
+  double tempo = agora() - inicio;
+
+  int erro = criadas < threads;
+  *alteracoes = 0;
+  for (int i = 0; i < criadas; i++)
+  {
+    erro |= operadoras[i].erro;
+    *alteracoes += operadoras[i].inseridos + operadoras[i].removidos;
+  }
+  if (erro)
+    return -1;
+  return (double)threads * OPERACOES_POR_THREAD / tempo;
+}
+
+/*
+ * Guarda o maior ID visto (usado com percorrerLivros).
+ */
+int guardarMaiorId(const Livro *livro, void *contexto)
+{
+  int *maior = (int *)contexto;
+  if (livro->id > *maior)
+    *maior = livro->id;
+  return 1;
+}
+
+/*
+ * Função principal: carrega a biblioteca e mede as rodadas com quantidades
+ * dobradas de threads, depois de uma rodada de aquecimento que não é
+ * mostrada.
+ */
+int main(int argc, char *argv[])
+{
+  int escritas = 50;
+  int maxThreads = 2 * (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (argc > 1)
+    escritas = atoi(argv[1]);
+  if (argc > 2)
+    maxThreads = atoi(argv[2]);
+  if (escritas < 0)
+    escritas = 0;
+  if (escritas > 100)
+    escritas = 100;
+  if (maxThreads < 1)
+    maxThreads = 1;
+  if (maxThreads > MAX_THREADS)
+    maxThreads = MAX_THREADS;
+
+  Biblioteca *bib = criarBiblioteca();
+  Sessao *sessao = bib != NULL ? abrirSessao(bib) : NULL;
+  if (sessao == NULL)
+  {
+    printf("Erro ao criar a biblioteca.\n");
+    destruirBiblioteca(bib);
+    return 1;
+  }
+  carregarLivros(sessao, "livros.dat");
+  int maiorId = 0;
+  percorrerLivros(sessao, guardarMaiorId, &maiorId);
+  fecharSessao(sessao);
+  if (maiorId <= 0)
+  {
+    printf("Nenhum livro carregado.\n");
+    destruirBiblioteca(bib);
+    return 1;
+  }
+  int faixa = maiorId <= INT32_MAX / 2 ? 2 * maiorId : INT32_MAX;
+
+  printf("\n%ld livros, %d operações por thread, %d%% de escritas, %ld processadores\n", quantidadeLivros(bib),
+         OPERACOES_POR_THREAD, escritas, sysconf(_SC_NPROCESSORS_ONLN));
+  printf("Threads | Operações por segundo | Aceleração | Alterações feitas\n");
+  long long alteracoes = 0;
+  medirRodada(bib, faixa, escritas, 0, 1, &alteracoes); // Aquecimento: traz a lista para a cache
+  double base = 0;
+  int rodada = 1;
+  for (int threads = 1; threads <= maxThreads; threads *= 2, rodada++)
+  {
+    double vazao = medirRodada(bib, faixa, escritas, rodada, threads, &alteracoes);
+    if (vazao < 0)
+    {
+      printf("Erro ao medir com %d threads.\n", threads);
+      break;
+    }
+    if (threads == 1)
+      base = vazao;
+    printf("%7d | %21.0f | %9.2fx | %lld\n", threads, vazao, vazao / base, alteracoes);
+  }
+
+  destruirBiblioteca(bib);
+  return 0;
+}
@@ -8,284 +8,1856 @@
 
 #include "biblioteca.h"
 
+#include <limits.h>
+#include <unistd.h>
+
 /*
  * Cria uma nova biblioteca vazia.
- * Aloca memória para a estrutura da biblioteca e inicializa o início da lista como NULL.
+ * Usa a lista simples, sem índice de saltos.
  */
 Biblioteca *criarBiblioteca()
+{
+  return criarBibliotecaTipo(LISTA_SIMPLES);
+}
+
+/*
+ * Cria uma nova biblioteca vazia do tipo informado.
+ * Aloca memória para a estrutura da biblioteca, inicializa o início da lista
+ * como NULL e prepara o pool de nós e a arena de textos.
+ */
+Biblioteca *criarBibliotecaTipo(TipoLista tipo)
 {
   Biblioteca *bib = (Biblioteca *)malloc(sizeof(Biblioteca));
+  if (bib != NULL && !iniciarTrava(&bib->trava))
+  {
+    free(bib);
+    bib = NULL;
+  }
   if (bib != NULL)
   {
     bib->inicio = NULL;
+    bib->fim = NULL;
+    bib->dedo = NULL;
+    bib->tipo = tipo;
+    bib->nivelSaltos = 0;
+    for (int i = 0; i < MAX_NIVEL_SALTOS; i++)
+    {
+      bib->cabecas[i] = NULL;
+    }
+    bib->blocos = NULL;
+    bib->ultimoBloco = NULL;
+    iniciarPool(&bib->nos, sizeof(NoLivro));
+    iniciarArena(&bib->textos);
+    iniciarIndice(&bib->indice);
+    iniciarAutores(&bib->autores);
+    bib->comAutores = 0;
+    iniciarTitulos(&bib->titulos);
+    bib->comTitulos = 0;
+    iniciarPalavras(&bib->palavras);
+    bib->comPalavras = 0;
+    iniciarMapa(&bib->disponiveis);
+    bib->comDisponiveis = 0;
+    iniciarCatalogo(&bib->catalogo);
+    bib->diario = NULL;
+    bib->diarioReaplicado = 0;
   }
   return bib;
 }
 
 /*
  * Libera toda a memória alocada para a biblioteca.
- * Percorre a lista do início ao fim, liberando cada livro.
+ * A lista não precisa ser percorrida: o pool libera todos os blocos de
+ * nós de uma vez e a arena faz o mesmo com os títulos e autores.
+ * Só as torres da lista de saltos são liberadas uma a uma; todo nó com
+ * torre está no primeiro nível expresso, então basta percorrer esse nível.
+ * Na lista desenrolada, são liberados os blocos. O catálogo mapeado, se
+ * houver, é fechado.
  * Por fim, libera a estrutura da biblioteca.
  */
 void destruirBiblioteca(Biblioteca *bib)
 {
   if (bib != NULL)
   {
-    Livro *atual = bib->inicio;
+    NoLivro *atual = bib->cabecas[0];
     while (atual != NULL)
     {
-      Livro *prox = atual->prox;
-      free(atual);
+      NoLivro *prox = atual->saltos[0];
+      free(atual->saltos);
       atual = prox;
     }
+    BlocoLivros *bloco = bib->blocos;
+    while (bloco != NULL)
+    {
+      BlocoLivros *prox = bloco->prox;
+      free(bloco);
+      bloco = prox;
+    }
+    liberarPool(&bib->nos);
+    liberarArena(&bib->textos);
+    liberarIndice(&bib->indice);
+    liberarAutores(&bib->autores);
+    liberarTitulos(&bib->titulos);
+    liberarPalavras(&bib->palavras);
+    liberarMapa(&bib->disponiveis);
+    fecharCatalogo(&bib->catalogo);
+    liberarTrava(&bib->trava);
     free(bib);
   }
 }
 
 /*
- * Cria um novo livro com os dados fornecidos.
- * Aloca memória para o livro e inicializa seus campos.
- * O livro é criado como disponível e sem próximo livro.
+ * Descarta o índice de autores; ele volta a ser montado na próxima busca
+ * por autor. Usado quando falta memória para mantê-lo.
+ */
+void descartarAutores(Biblioteca *bib)
+{
+  liberarAutores(&bib->autores);
+  bib->comAutores = 0;
+}
+
+/*
+ * Descarta o índice de títulos; ele volta a ser montado na próxima busca
+ * por título.
+ */
+void descartarTitulos(Biblioteca *bib)
+{
+  liberarTitulos(&bib->titulos);
+  bib->comTitulos = 0;
+}
+
+/*
+ * Descarta o índice de palavras; ele volta a ser montado na próxima busca
+ * por palavras.
+ */
+void descartarPalavras(Biblioteca *bib)
+{
+  liberarPalavras(&bib->palavras);
+  bib->comPalavras = 0;
+}
+
+/*
+ * Descarta o mapa de disponíveis; ele volta a ser montado na próxima
+ * consulta de disponíveis.
+ */
+void descartarDisponiveis(Biblioteca *bib)
+{
+  liberarMapa(&bib->disponiveis);
+  bib->comDisponiveis = 0;
+}
+
+/*
+ * Registra um livro nos índices da biblioteca.
+ * Chamado sempre que um livro entra na lista. Quem insere reserva espaço no
+ * índice antes (reservarIndice), então aqui não falta memória; se faltar
+ * para um índice secundário (autores, títulos, palavras ou disponíveis), ele é descartado.
+ */
+void indexarLivro(Biblioteca *bib, Livro *livro)
+{
+  inserirIndice(&bib->indice, livro->id, livro);
+  if (bib->comAutores && !adicionarAutor(&bib->autores, livro->autor, livro->id))
+    descartarAutores(bib);
+  if (bib->comTitulos && !adicionarTitulo(&bib->titulos, livro->titulo, livro->id))
+    descartarTitulos(bib);
+  if (bib->comPalavras && !adicionarPalavras(&bib->palavras, livro->titulo, livro->autor, livro->id))
+    descartarPalavras(bib);
+  if (bib->comDisponiveis && livro->disponivel && !marcarBit(&bib->disponiveis, livro->id))
+    descartarDisponiveis(bib);
+}
+
+/*
+ * Retira um livro dos índices da biblioteca.
+ * Chamado antes de o livro sair da lista, enquanto seus campos são válidos.
+ */
+void desindexarLivro(Biblioteca *bib, Livro *livro)
+{
+  removerIndice(&bib->indice, livro->id);
+  if (bib->comAutores)
+    removerAutor(&bib->autores, livro->autor, livro->id);
+  if (bib->comTitulos)
+    removerTitulo(&bib->titulos, livro->titulo, livro->id);
+  if (bib->comPalavras)
+    removerPalavras(&bib->palavras);
+  if (bib->comDisponiveis)
+    desmarcarBit(&bib->disponiveis, livro->id);
+}
+
+/*
+ * Muda a disponibilidade de um livro que já está nos índices, mantendo o
+ * mapa de disponíveis, se houver. Toda mudança de disponibilidade passa
+ * por aqui.
+ */
+void definirDisponivel(Biblioteca *bib, Livro *livro, int disponivel)
+{
+  livro->disponivel = disponivel;
+  if (!bib->comDisponiveis)
+    return;
+  if (!disponivel)
+    desmarcarBit(&bib->disponiveis, livro->id);
+  else if (!marcarBit(&bib->disponiveis, livro->id))
+    descartarDisponiveis(bib);
+}
+
+/*
+ * Reaponta no índice hash os livros de um bloco a partir da posição dada,
+ * depois que eles mudaram de lugar. Os IDs já estão no índice, então só o
+ * endereço é trocado, sem alocar memória.
+ */
+void reapontarBloco(Biblioteca *bib, BlocoLivros *bloco, int inicio)
+{
+  for (int i = inicio; i < bloco->quantidade; i++)
+  {
+    inserirIndice(&bib->indice, bloco->livros[i].id, &bloco->livros[i]);
+  }
+}
+
+/*
+ * Registra uma operação no diário da biblioteca, se houver.
+ * Chamado depois que a operação foi feita na memória.
+ */
+void registrarNoDiario(Biblioteca *bib, TipoOperacao operacao, const Livro *livro)
+{
+  if (bib->diario != NULL &&
+      !registrarOperacao(bib->diario, operacao, livro->id, livro->titulo, livro->autor))
+    printf("Aviso: a operação não foi registrada no diário.\n");
+}
+
+/*
+ * Preenche os dados de um livro com os valores fornecidos.
+ * Título e autor já devem estar na arena. O livro fica disponível.
+ */
+void preencherLivro(Livro *livro, int id, char *titulo, char *autor)
+{
+  livro->id = id;
+  livro->disponivel = 1;
+  livro->titulo = titulo;
+  livro->autor = autor;
+}
+
+/*
+ * Cria um novo nó com os dados fornecidos.
+ * Pega um nó do pool da biblioteca e inicializa seus campos.
+ * O nó é criado sem próximo nó e sem torre.
  */
-Livro *criarLivro(int id, const char *titulo, const char *autor)
+NoLivro *criarNo(Biblioteca *bib, int id, char *titulo, char *autor)
 {
-  Livro *novo = (Livro *)malloc(sizeof(Livro));
+  NoLivro *novo = (NoLivro *)alocarNo(&bib->nos);
   if (novo != NULL)
   {
-    novo->id = id;
-    strcpy(novo->titulo, titulo);
-    strcpy(novo->autor, autor);
-    novo->disponivel = 1;
+    preencherLivro(&novo->livro, id, titulo, autor);
     novo->prox = NULL;
+    novo->saltos = NULL;
   }
   return novo;
 }
 
 /*
- * Insere um novo livro na biblioteca.
- * O livro é inserido mantendo a lista ordenada por ID.
- * Se a lista estiver vazia ou o novo livro tiver ID menor que o primeiro,
- * ele é inserido no início. Caso contrário, é inserido na posição correta.
+ * Retorna o endereço da ligação de um nó para o próximo, no nível dado.
+ * O nível 0 é a lista base (prox); os demais são os níveis expressos.
+ * Um nó NULL representa a cabeça da lista.
  */
-void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor)
+NoLivro **ligacaoNivel(Biblioteca *bib, NoLivro *no, int nivel)
 {
-  Livro *novo = criarLivro(id, titulo, autor);
-  if (novo == NULL)
-    return;
+  if (nivel == 0)
+    return no != NULL ? &no->prox : &bib->inicio;
+  return no != NULL ? &no->saltos[nivel - 1] : &bib->cabecas[nivel - 1];
+}
 
-  // Se a lista estiver vazia ou o novo livro tiver ID menor que o primeiro
-  if (bib->inicio == NULL || id < bib->inicio->id)
+/*
+ * Sorteia quantos níveis expressos um novo nó terá.
+ * Cada nível é alcançado com probabilidade 1/4 do anterior, então em
+ * média só 1 em cada 4 nós tem torre.
+ */
+int sortearNivel()
+{
+  int nivel = 0;
+  while (nivel < MAX_NIVEL_SALTOS && (rand() & 3) == 0)
   {
-    novo->prox = bib->inicio;
-    bib->inicio = novo;
-    return;
+    nivel++;
   }
+  return nivel;
+}
 
-  // Encontrar a posição correta para inserir
-  Livro *atual = bib->inicio;
-  while (atual->prox != NULL && atual->prox->id < id)
+/*
+ * Procura, em cada nível da lista de saltos, o último nó com ID menor
+ * que o informado, descendo do nível mais alto até a lista base.
+ * anteriores[k] recebe esse nó no nível k (NULL representa a cabeça).
+ */
+void buscarAnterioresSaltos(Biblioteca *bib, int id, NoLivro *anteriores[])
+{
+  NoLivro *atual = NULL;
+  for (int nivel = bib->nivelSaltos; nivel >= 0; nivel--)
   {
-    atual = atual->prox;
+    NoLivro *prox;
+    while ((prox = *ligacaoNivel(bib, atual, nivel)) != NULL && prox->livro.id < id)
+    {
+      atual = prox;
+    }
+    anteriores[nivel] = atual;
   }
-
-  novo->prox = atual->prox;
-  atual->prox = novo;
 }
 
 /*
- * Busca um livro pelo ID.
- * Percorre a lista do início ao fim até encontrar o livro.
- * Retorna um ponteiro para o livro encontrado ou NULL se não encontrar.
+ * Liga um nó já criado na lista de saltos.
+ *
+ * Como funciona:
+ * 1. Acha os anteriores do novo nó em cada nível
+ * 2. Sorteia a altura da torre; se passar do nível mais alto em uso,
+ *    os novos níveis começam na cabeça
+ * 3. Liga o nó em cada nível, da lista base até o topo da torre
  */
-Livro *buscarLivro(Biblioteca *bib, int id)
+void inserirNoSaltos(Biblioteca *bib, NoLivro *novo)
 {
-  Livro *atual = bib->inicio;
-  while (atual != NULL)
+  NoLivro *anteriores[MAX_NIVEL_SALTOS + 1];
+  buscarAnterioresSaltos(bib, novo->livro.id, anteriores);
+
+  int nivel = sortearNivel();
+  if (nivel > 0)
   {
-    if (atual->id == id)
-    {
-      return atual;
-    }
-    atual = atual->prox;
+    novo->saltos = (NoLivro **)malloc(nivel * sizeof(NoLivro *));
+    if (novo->saltos == NULL)
+      nivel = 0; // Sem memória para a torre: fica só na lista base
+  }
+  for (int k = bib->nivelSaltos + 1; k <= nivel; k++)
+  {
+    anteriores[k] = NULL;
   }
-  return NULL;
+  if (nivel > bib->nivelSaltos)
+    bib->nivelSaltos = nivel;
+
+  for (int k = 0; k <= nivel; k++)
+  {
+    NoLivro **ligacao = ligacaoNivel(bib, anteriores[k], k);
+    *ligacaoNivel(bib, novo, k) = *ligacao;
+    *ligacao = novo;
+  }
+
+  if (novo->prox == NULL)
+    bib->fim = novo;
 }
 
 /*
- * Remove um livro da biblioteca pelo ID.
- * Se o livro for o primeiro da lista, atualiza o início.
- * Caso contrário, procura o livro e o remove, mantendo a lista ligada.
+ * Liga um nó já criado na lista simples, mantendo a ordem por ID.
+ * Se a lista estiver vazia ou o novo nó tiver ID menor que o primeiro,
+ * ele é inserido no início. Se tiver ID maior que o último, é ligado
+ * direto no fim. Caso contrário, a posição correta é procurada a partir
+ * do último nó inserido (se ele tiver ID menor) ou do início.
  */
-void removerLivro(Biblioteca *bib, int id)
+void inserirNoSimples(Biblioteca *bib, NoLivro *novo)
 {
-  if (bib->inicio == NULL)
-    return;
+  int id = novo->livro.id;
+  NoLivro *dedo = bib->dedo;
+  bib->dedo = novo;
 
-  // Se o livro a ser removido é o primeiro
-  if (bib->inicio->id == id)
+  // Se a lista estiver vazia ou o novo nó tiver ID menor que o primeiro
+  if (bib->inicio == NULL || id < bib->inicio->livro.id)
   {
-    Livro *temp = bib->inicio;
-    bib->inicio = bib->inicio->prox;
-    free(temp);
+    novo->prox = bib->inicio;
+    bib->inicio = novo;
+    if (bib->fim == NULL)
+      bib->fim = novo;
     return;
   }
 
-  // Procurar o livro na lista
-  Livro *atual = bib->inicio;
-  while (atual->prox != NULL && atual->prox->id != id)
+  // Se o novo nó tiver ID maior que o último, liga direto no fim
+  if (bib->fim->livro.id < id)
   {
-    atual = atual->prox;
+    bib->fim->prox = novo;
+    bib->fim = novo;
+    return;
   }
 
-  // Se encontrou o livro
-  if (atual->prox != NULL)
+  // Encontrar a posição correta para inserir, começando do nó mais
+  // próximo conhecido: todos os nós antes dele têm ID menor que o novo
+  NoLivro *atual = bib->inicio;
+  if (dedo != NULL && dedo->livro.id < id)
+    atual = dedo;
+  while (atual->prox != NULL && atual->prox->livro.id < id)
   {
-    Livro *temp = atual->prox;
-    atual->prox = temp->prox;
-    free(temp);
+    atual = atual->prox;
   }
+
+  novo->prox = atual->prox;
+  atual->prox = novo;
 }
 
 /*
- * Lista todos os livros da biblioteca.
- * Percorre a lista do início ao fim, imprimindo os dados de cada livro.
- * Se a biblioteca estiver vazia, exibe uma mensagem.
+ * Acha o bloco da lista desenrolada onde um ID está ou deveria entrar:
+ * o primeiro bloco cujo maior ID não é menor que o procurado, ou o último
+ * bloco se todos forem menores. Se anterior não for NULL, recebe o bloco
+ * antes do encontrado (NULL se for o primeiro).
+ * Como cada bloco guarda dezenas de livros, a busca salta de bloco em bloco
+ * olhando só o último ID de cada um.
  */
-void listarLivros(Biblioteca *bib)
+BlocoLivros *buscarBloco(Biblioteca *bib, int id, BlocoLivros **anterior)
 {
-  if (bib->inicio == NULL)
+  BlocoLivros *ant = NULL;
+  BlocoLivros *bloco = bib->blocos;
+  while (bloco != NULL && bloco->prox != NULL &&
+         bloco->livros[bloco->quantidade - 1].id < id)
   {
-    printf("Biblioteca vazia!\n");
-    return;
+    ant = bloco;
+    bloco = bloco->prox;
   }
+  if (anterior != NULL)
+    *anterior = ant;
+  return bloco;
+}
 
-  Livro *atual = bib->inicio;
-  while (atual != NULL)
+/*
+ * Retorna a posição, dentro do bloco, do primeiro livro com ID maior ou
+ * igual ao informado (busca binária no vetor ordenado do bloco).
+ */
+int posicaoNoBloco(BlocoLivros *bloco, int id)
+{
+  int inicio = 0;
+  int fim = bloco->quantidade;
+  while (inicio < fim)
   {
-    printf("ID: %d\n", atual->id);
-    printf("Título: %s\n", atual->titulo);
-    printf("Autor: %s\n", atual->autor);
-    printf("Disponível: %s\n", atual->disponivel ? "Sim" : "Não");
-    printf("------------------------\n");
-    atual = atual->prox;
+    int meio = (inicio + fim) / 2;
+    if (bloco->livros[meio].id < id)
+      inicio = meio + 1;
+    else
+      fim = meio;
   }
+  return inicio;
 }
 
 /*
- * Marca um livro como emprestado.
- * Busca o livro pelo ID e, se encontrar e estiver disponível,
- * marca como emprestado.
+ * Cria um bloco vazio e o liga depois do bloco informado (ou no início
+ * da lista, se anterior for NULL). Retorna NULL se não houver memória.
  */
-void emprestarLivro(Biblioteca *bib, int id)
+BlocoLivros *criarBloco(Biblioteca *bib, BlocoLivros *anterior)
 {
-  Livro *livro = buscarLivro(bib, id);
-  if (livro != NULL)
+  BlocoLivros *novo = (BlocoLivros *)malloc(sizeof(BlocoLivros));
+  if (novo != NULL)
   {
-    if (livro->disponivel)
+    novo->quantidade = 0;
+    if (anterior != NULL)
     {
-      livro->disponivel = 0;
-      printf("Livro emprestado com sucesso!\n");
+      novo->prox = anterior->prox;
+      anterior->prox = novo;
     }
     else
     {
-      printf("Livro não está disponível para empréstimo.\n");
+      novo->prox = bib->blocos;
+      bib->blocos = novo;
     }
+    if (novo->prox == NULL)
+      bib->ultimoBloco = novo;
   }
-  else
-  {
-    printf("Livro não encontrado.\n");
-  }
+  return novo;
 }
 
 /*
- * Marca um livro como devolvido.
- * Busca o livro pelo ID e, se encontrar e estiver emprestado,
- * marca como disponível.
+ * Insere um livro na lista desenrolada.
+ *
+ * Como funciona:
+ * 1. Um ID maior que todos vai direto para o último bloco; os demais
+ *    procuram seu bloco com buscarBloco
+ * 2. Se o bloco estiver cheio, um bloco novo é ligado depois dele. Quando
+ *    o livro entra depois do último livro do bloco (carga em ordem), o novo
+ *    bloco começa vazio e o cheio fica como está; senão, metade dos livros
+ *    passa para o novo bloco
+ * 3. O livro entra na sua posição, deslocando os maiores uma casa
  */
-void devolverLivro(Biblioteca *bib, int id)
+Livro *inserirLivroDesenrolada(Biblioteca *bib, int id, char *titulo, char *autor)
 {
-  Livro *livro = buscarLivro(bib, id);
-  if (livro != NULL)
+  Livro dados;
+  preencherLivro(&dados, id, titulo, autor);
+
+  BlocoLivros *bloco = bib->ultimoBloco;
+  if (bloco == NULL)
   {
-    if (!livro->disponivel)
+    bloco = criarBloco(bib, NULL);
+    if (bloco == NULL)
+      return NULL;
+  }
+  else if (bloco->livros[bloco->quantidade - 1].id >= id)
+  {
+    bloco = buscarBloco(bib, id, NULL);
+  }
+
+  int pos = posicaoNoBloco(bloco, id);
+  if (bloco->quantidade == LIVROS_POR_BLOCO)
+  {
+    BlocoLivros *novo = criarBloco(bib, bloco);
+    if (novo == NULL)
+      return NULL;
+    if (pos == LIVROS_POR_BLOCO)
     {
-      livro->disponivel = 1;
-      printf("Livro devolvido com sucesso!\n");
+      bloco = novo;
+      pos = 0;
     }
     else
     {
-      printf("Livro já está disponível.\n");
+      int metade = LIVROS_POR_BLOCO / 2;
+      memcpy(novo->livros, &bloco->livros[metade], (LIVROS_POR_BLOCO - metade) * sizeof(Livro));
+      novo->quantidade = LIVROS_POR_BLOCO - metade;
+      bloco->quantidade = metade;
+      reapontarBloco(bib, novo, 0);
+      if (pos > metade)
+      {
+        bloco = novo;
+        pos -= metade;
+      }
     }
   }
+
+  Livro *livro = &bloco->livros[pos];
+  memmove(livro + 1, livro, (bloco->quantidade - pos) * sizeof(Livro));
+  *livro = dados;
+  bloco->quantidade++;
+  reapontarBloco(bib, bloco, pos + 1);
+  indexarLivro(bib, livro);
+  return livro;
+}
+
+/*
+ * Insere um livro de ID novo cujos título e autor já estão na arena
+ * (copiados por inserirLivro ou lidos de um snapshot).
+ * O livro é inserido mantendo a lista ordenada por ID, no nó ou no bloco
+ * conforme o tipo da lista, e registrado no índice.
+ */
+Livro *inserirLivroArena(Biblioteca *bib, int id, char *titulo, char *autor)
+{
+  if (!reservarIndice(&bib->indice, bib->indice.quantidade + 1))
+    return NULL;
+
+  if (bib->tipo == LISTA_DESENROLADA)
+    return inserirLivroDesenrolada(bib, id, titulo, autor);
+
+  NoLivro *novo = criarNo(bib, id, titulo, autor);
+  if (novo == NULL)
+    return NULL;
+
+  if (bib->tipo == LISTA_SALTOS)
+    inserirNoSaltos(bib, novo);
   else
+    inserirNoSimples(bib, novo);
+  indexarLivro(bib, &novo->livro);
+  return &novo->livro;
+}
+
+/*
+ * Insere um novo livro na biblioteca.
+ * Um ID repetido é descartado pelo índice, sem percorrer a lista. Senão,
+ * título e autor são copiados para a arena, ocupando só o seu tamanho
+ * real, e o livro é inserido por inserirLivroArena e registrado no
+ * diário.
+ * Retorna o livro inserido, para quem chamou não precisar buscá-lo.
+ */
+Livro *inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor)
+{
+  Livro *existente = buscarLivro(bib, id);
+  if (existente != NULL)
+    return existente; // ID repetido: nada a fazer
+
+  char *tituloArena = guardarTexto(&bib->textos, titulo, strlen(titulo));
+  char *autorArena = guardarTexto(&bib->textos, autor, strlen(autor));
+  if (tituloArena == NULL || autorArena == NULL)
+    return NULL;
+  Livro *livro = inserirLivroArena(bib, id, tituloArena, autorArena);
+  if (livro != NULL)
+    registrarNoDiario(bib, OPERACAO_INSERIR, livro);
+  return livro;
+}
+
+/*
+ * Cria o nó de um livro do catálogo mapeado, na primeira vez que ele é
+ * buscado. O nó sai do pool em qualquer tipo de lista e entra só no
+ * índice, não na lista (a ordem continua vindo do catálogo); título e
+ * autor apontam direto para as páginas mapeadas.
+ */
+Livro *materializarLivro(Biblioteca *bib, long pos)
+{
+  if (!reservarIndice(&bib->indice, bib->indice.quantidade + 1))
+    return NULL;
+
+  RegistroLivro registro;
+  lerEntradaCatalogo(&bib->catalogo, (size_t)pos, &registro);
+  NoLivro *no = criarNo(bib, registro.id, registro.titulo, registro.autor);
+  if (no == NULL)
+    return NULL;
+  no->livro.disponivel = registro.disponivel;
+  inserirIndice(&bib->indice, registro.id, &no->livro); // Já está nos índices secundários, se houver
+  bib->catalogo.estados[pos] = ENTRADA_MATERIALIZADA;
+  return &no->livro;
+}
+
+/*
+ * Busca um livro pelo ID.
+ * Consulta o índice hash, sem percorrer a lista.
+ * Serve para os três tipos de lista. Se o ID não estiver no índice e
+ * houver um catálogo mapeado, procura no catálogo.
+ */
+Livro *buscarLivro(Biblioteca *bib, int id)
+{
+  Livro *livro = (Livro *)consultarIndice(&bib->indice, id);
+  if (livro == NULL && bib->catalogo.quantidade > 0)
   {
-    printf("Livro não encontrado.\n");
+    long pos = procurarCatalogo(&bib->catalogo, id);
+    if (pos >= 0 && bib->catalogo.estados[pos] == ENTRADA_MAPEADA)
+      livro = materializarLivro(bib, pos);
   }
+  return livro;
 }
 
 /*
- * Salva todos os livros em um arquivo.
- * Percorre a lista do início ao fim, salvando os dados de cada livro
- * em formato texto, separados por '|'.
+ * Remove um nó da lista de saltos.
+ * Acha os anteriores em cada nível e desliga o nó em todos os níveis em
+ * que ele aparece; depois reduz nivelSaltos se os níveis do topo esvaziarem.
  */
-void salvarLivros(Biblioteca *bib, FILE *arquivo)
+void removerNoSaltos(Biblioteca *bib, int id)
 {
-  if (arquivo == NULL)
+  NoLivro *anteriores[MAX_NIVEL_SALTOS + 1];
+  buscarAnterioresSaltos(bib, id, anteriores);
+
+  NoLivro *alvo = *ligacaoNivel(bib, anteriores[0], 0);
+  if (alvo == NULL || alvo->livro.id != id)
     return;
 
-  Livro *atual = bib->inicio;
-  while (atual != NULL)
+  for (int k = 0; k <= bib->nivelSaltos; k++)
   {
-    fprintf(arquivo, "%d|%s|%s|%d\n",
-            atual->id,
-            atual->titulo,
-            atual->autor,
-            atual->disponivel);
-    atual = atual->prox;
+    NoLivro **ligacao = ligacaoNivel(bib, anteriores[k], k);
+    if (*ligacao == alvo)
+      *ligacao = *ligacaoNivel(bib, alvo, k);
   }
-  printf("Livros salvos com sucesso!\n");
+  while (bib->nivelSaltos > 0 && bib->cabecas[bib->nivelSaltos - 1] == NULL)
+  {
+    bib->nivelSaltos--;
+  }
+
+  if (bib->fim == alvo)
+    bib->fim = anteriores[0];
+  if (bib->dedo == alvo)
+    bib->dedo = anteriores[0];
+  free(alvo->saltos);
+  devolverNo(&bib->nos, alvo);
 }
 
 /*
- * Carrega livros de um arquivo para a biblioteca.
- * Lê o arquivo linha por linha, criando um novo livro para cada linha.
- * Os dados são lidos no formato: id|titulo|autor|disponivel
+ * Remove um livro da lista desenrolada.
+ * Os livros seguintes do bloco recuam uma casa. Um bloco que fica vazio é
+ * liberado; um bloco que, junto com o próximo, cabe em meio bloco absorve
+ * o próximo, para os blocos não ficarem quase vazios depois de muitas
+ * remoções.
  */
-void carregarLivros(Biblioteca *bib, const char *nomeArquivo)
+void removerLivroDesenrolada(Biblioteca *bib, int id)
 {
-  FILE *arquivo = fopen(nomeArquivo, "r");
-  if (arquivo == NULL)
+  BlocoLivros *anterior;
+  BlocoLivros *bloco = buscarBloco(bib, id, &anterior);
+  if (bloco == NULL)
+    return;
+
+  int pos = posicaoNoBloco(bloco, id);
+  if (pos == bloco->quantidade || bloco->livros[pos].id != id)
+    return;
+
+  bloco->quantidade--;
+  memmove(&bloco->livros[pos], &bloco->livros[pos + 1], (bloco->quantidade - pos) * sizeof(Livro));
+  reapontarBloco(bib, bloco, pos);
+
+  if (bloco->quantidade == 0)
   {
-    printf("Erro ao abrir arquivo para leitura.\n");
+    if (anterior != NULL)
+      anterior->prox = bloco->prox;
+    else
+      bib->blocos = bloco->prox;
+    if (bib->ultimoBloco == bloco)
+      bib->ultimoBloco = anterior;
+    free(bloco);
+    return;
+  }
+
+  BlocoLivros *prox = bloco->prox;
+  if (prox != NULL && bloco->quantidade + prox->quantidade <= LIVROS_POR_BLOCO / 2)
+  {
+    int inicio = bloco->quantidade;
+    memcpy(&bloco->livros[inicio], prox->livros, prox->quantidade * sizeof(Livro));
+    bloco->quantidade += prox->quantidade;
+    reapontarBloco(bib, bloco, inicio);
+    bloco->prox = prox->prox;
+    if (bib->ultimoBloco == prox)
+      bib->ultimoBloco = bloco;
+    free(prox);
+  }
+}
+
+/*
+ * Remove um nó da lista simples.
+ * Se o nó for o primeiro da lista, atualiza o início.
+ * Caso contrário, procura o nó e o remove, mantendo a lista ligada.
+ */
+void removerNoSimples(Biblioteca *bib, int id)
+{
+  if (bib->inicio == NULL)
+    return;
+
+  // Se o nó a ser removido é o primeiro
+  if (bib->inicio->livro.id == id)
+  {
+    NoLivro *temp = bib->inicio;
+    bib->inicio = bib->inicio->prox;
+    if (bib->fim == temp)
+      bib->fim = NULL;
+    if (bib->dedo == temp)
+      bib->dedo = NULL;
+    devolverNo(&bib->nos, temp);
     return;
   }
 
-  int id, disponivel;
-  char titulo[MAX_TITULO], autor[MAX_AUTOR];
-  char linha[1024];
+  // Procurar o nó na lista
+  NoLivro *atual = bib->inicio;
+  while (atual->prox != NULL && atual->prox->livro.id != id)
+  {
+    atual = atual->prox;
+  }
+
+  // Se encontrou o nó (o anterior passa a ser o fim ou o dedo,
+  // se o removido era um deles)
+  if (atual->prox != NULL)
+  {
+    NoLivro *temp = atual->prox;
+    atual->prox = temp->prox;
+    if (bib->fim == temp)
+      bib->fim = atual;
+    if (bib->dedo == temp)
+      bib->dedo = atual;
+    devolverNo(&bib->nos, temp);
+  }
+}
+
+/*
+ * Remove um livro da biblioteca pelo ID.
+ * O livro sai do índice antes de sair da lista.
+ * Mantém a lista ordenada após a remoção.
+ * Um livro do catálogo mapeado não está na lista: seu nó volta ao pool e
+ * a entrada é marcada como removida.
+ */
+void removerLivro(Biblioteca *bib, int id)
+{
+  Livro *livro = buscarLivro(bib, id);
+  if (livro == NULL)
+    return;
+  registrarNoDiario(bib, OPERACAO_REMOVER, livro);
+  desindexarLivro(bib, livro);
 
-  while (fgets(linha, sizeof(linha), arquivo))
+  long pos = procurarCatalogo(&bib->catalogo, id);
+  if (pos >= 0 && bib->catalogo.estados[pos] == ENTRADA_MATERIALIZADA)
   {
-    char *token = strtok(linha, "|");
-    id = atoi(token);
+    bib->catalogo.estados[pos] = ENTRADA_REMOVIDA;
+    bib->catalogo.removidas++;
+    devolverNo(&bib->nos, livro); // O livro é o primeiro campo do nó
+    return;
+  }
+
+  if (bib->tipo == LISTA_SALTOS)
+    removerNoSaltos(bib, id);
+  else if (bib->tipo == LISTA_DESENROLADA)
+    removerLivroDesenrolada(bib, id);
+  else
+    removerNoSimples(bib, id);
+}
+
+/*
+ * Retorna o livro de uma entrada não removida do catálogo mapeado: o nó,
+ * se a entrada já tiver um (ele tem o status atual), ou uma cópia montada
+ * em *copia com os dados das páginas mapeadas.
+ */
+const Livro *livroDoCatalogo(Biblioteca *bib, size_t pos, Livro *copia)
+{
+  Catalogo *catalogo = &bib->catalogo;
+  if (catalogo->estados[pos] == ENTRADA_MATERIALIZADA)
+    return (const Livro *)consultarIndice(&bib->indice, catalogo->ids[pos]);
 
-    token = strtok(NULL, "|");
-    strcpy(titulo, token);
+  RegistroLivro registro;
+  lerEntradaCatalogo(catalogo, pos, &registro);
+  preencherLivro(copia, registro.id, registro.titulo, registro.autor);
+  copia->disponivel = registro.disponivel;
+  return copia;
+}
 
-    token = strtok(NULL, "|");
-    strcpy(autor, token);
+/*
+ * Visita, a partir da posição *pos do catálogo mapeado, as entradas com
+ * ID menor que `limite`, avançando *pos. Entradas removidas são puladas;
+ * as demais são visitadas pelo livro dado por livroDoCatalogo.
+ * Retorna 0 se a visita for interrompida.
+ */
+int visitarCatalogo(Biblioteca *bib, size_t *pos, long long limite, VisitarLivro visitar, void *contexto)
+{
+  Catalogo *catalogo = &bib->catalogo;
+  for (; *pos < catalogo->quantidade && catalogo->ids[*pos] < limite; (*pos)++)
+  {
+    if (catalogo->estados[*pos] == ENTRADA_REMOVIDA)
+      continue;
 
-    token = strtok(NULL, "|");
-    disponivel = atoi(token);
+    Livro copia;
+    if (!visitar(livroDoCatalogo(bib, *pos, &copia), contexto))
+      return 0;
+  }
+  return 1;
+}
 
-    inserirLivro(bib, id, titulo, autor);
-    Livro *livro = buscarLivro(bib, id);
-    if (livro != NULL)
+/*
+ * Visita todos os livros em ordem de ID.
+ * Percorre os blocos (lista desenrolada) e depois os nós (lista simples
+ * ou de saltos), já que só um dos dois está em uso; antes de cada livro,
+ * visita as entradas do catálogo com ID menor, e no final as que
+ * sobraram. Sem catálogo, é só o percurso da lista.
+ */
+int percorrerLivros(Biblioteca *bib, VisitarLivro visitar, void *contexto)
+{
+  size_t pos = 0;
+  for (BlocoLivros *bloco = bib->blocos; bloco != NULL; bloco = bloco->prox)
+  {
+    for (int i = 0; i < bloco->quantidade; i++)
     {
-      livro->disponivel = disponivel;
+      Livro *livro = &bloco->livros[i];
+      if (!visitarCatalogo(bib, &pos, livro->id, visitar, contexto) || !visitar(livro, contexto))
+        return 0;
     }
   }
 
-  fclose(arquivo);
-  printf("Livros carregados com sucesso!\n");
+  for (NoLivro *atual = bib->inicio; atual != NULL; atual = atual->prox)
+  {
+    Livro *livro = &atual->livro;
+    if (!visitarCatalogo(bib, &pos, livro->id, visitar, contexto) || !visitar(livro, contexto))
+      return 0;
+  }
+  return visitarCatalogo(bib, &pos, LLONG_MAX, visitar, contexto);
+}
+
+/*
+ * Acha o primeiro nó da lista simples ou de saltos com ID maior ou igual
+ * a `primeiro` (NULL se não houver).
+ * Na lista de saltos, desce pelos níveis expressos como a busca; na
+ * simples, começa do último nó inserido quando ele vem antes da faixa e
+ * nem percorre a lista quando o último nó já vem antes dela.
+ */
+NoLivro *primeiroNoFaixa(Biblioteca *bib, int primeiro)
+{
+  if (bib->fim == NULL || bib->fim->livro.id < primeiro)
+    return NULL;
+
+  if (bib->tipo == LISTA_SALTOS)
+  {
+    NoLivro *anteriores[MAX_NIVEL_SALTOS + 1];
+    buscarAnterioresSaltos(bib, primeiro, anteriores);
+    return *ligacaoNivel(bib, anteriores[0], 0);
+  }
+
+  NoLivro *atual = bib->inicio;
+  if (bib->dedo != NULL && bib->dedo->livro.id < primeiro)
+    atual = bib->dedo;
+  while (atual != NULL && atual->livro.id < primeiro)
+  {
+    atual = atual->prox;
+  }
+  return atual;
+}
+
+/*
+ * Inicia um iterador na faixa [primeiro, ultimo].
+ * Na lista desenrolada, o bloco é achado olhando só o último ID de cada
+ * bloco e a posição dentro dele por busca binária; nos outros tipos, por
+ * primeiroNoFaixa. No catálogo, por busca binária.
+ */
+int iniciarIterador(IteradorLivros *iterador, Biblioteca *bib, int primeiro, int ultimo)
+{
+  iterador->bib = bib;
+  iterador->no = NULL;
+  iterador->bloco = NULL;
+  iterador->posBloco = 0;
+  if (bib->tipo == LISTA_DESENROLADA)
+  {
+    iterador->bloco = buscarBloco(bib, primeiro, NULL);
+    if (iterador->bloco != NULL)
+      iterador->posBloco = posicaoNoBloco(iterador->bloco, primeiro);
+  }
+  else
+  {
+    iterador->no = primeiroNoFaixa(bib, primeiro);
+  }
+  iterador->posCatalogo = posicaoCatalogo(&bib->catalogo, primeiro);
+  iterador->ultimo = ultimo;
+  iterador->restantes = SIZE_MAX;
+  iterador->erro = 0;
+  return 1;
+}
+
+/*
+ * Inicia um iterador na página informada: pula pagina * tamanho livros a
+ * partir do menor ID e limita o iterador a `tamanho` livros.
+ */
+int iniciarPagina(IteradorLivros *iterador, Biblioteca *bib, size_t pagina, size_t tamanho)
+{
+  iniciarIterador(iterador, bib, INT_MIN, INT_MAX);
+  size_t pular = tamanho > 0 && pagina > SIZE_MAX / tamanho ? SIZE_MAX : pagina * tamanho;
+  while (pular > 0 && proximoLivro(iterador) != NULL)
+    pular--;
+  iterador->restantes = pular > 0 ? 0 : tamanho;
+  return 1;
+}
+
+/*
+ * Devolve o próximo livro da faixa.
+ *
+ * Como funciona:
+ * 1. Pula as entradas removidas do catálogo e os blocos já esgotados
+ * 2. Compara o ID do próximo livro da lista com o da próxima entrada do
+ *    catálogo e fica com o menor (os dois nunca são iguais: um livro do
+ *    catálogo não está na lista)
+ * 3. Avança na sequência de onde o livro veio
+ * 4. Se o ID passar do fim da faixa, o iterador termina
+ */
+const Livro *proximoLivro(IteradorLivros *iterador)
+{
+  if (iterador->restantes == 0)
+    return NULL;
+
+  Biblioteca *bib = iterador->bib;
+  Catalogo *catalogo = &bib->catalogo;
+  while (iterador->posCatalogo < catalogo->quantidade &&
+         catalogo->estados[iterador->posCatalogo] == ENTRADA_REMOVIDA)
+    iterador->posCatalogo++;
+  while (iterador->bloco != NULL && iterador->posBloco >= iterador->bloco->quantidade)
+  {
+    iterador->bloco = iterador->bloco->prox;
+    iterador->posBloco = 0;
+  }
+
+  Livro *daLista = NULL;
+  if (iterador->bloco != NULL)
+    daLista = &iterador->bloco->livros[iterador->posBloco];
+  else if (iterador->no != NULL)
+    daLista = &iterador->no->livro;
+
+  const Livro *livro;
+  if (iterador->posCatalogo < catalogo->quantidade &&
+      (daLista == NULL || catalogo->ids[iterador->posCatalogo] < daLista->id))
+  {
+    livro = livroDoCatalogo(bib, iterador->posCatalogo++, &iterador->copia);
+  }
+  else
+  {
+    livro = daLista;
+    if (iterador->bloco != NULL)
+      iterador->posBloco++;
+    else if (iterador->no != NULL)
+      iterador->no = iterador->no->prox;
+  }
+
+  if (livro == NULL || livro->id > iterador->ultimo)
+  {
+    iterador->restantes = 0;
+    return NULL;
+  }
+  iterador->restantes--;
+  return livro;
+}
+
+/*
+ * Termina o iterador. Ele não aloca memória; a função existe para o uso
+ * ser o mesmo da implementação com árvore.
+ */
+void fecharIterador(IteradorLivros *iterador)
+{
+  iterador->no = NULL;
+  iterador->bloco = NULL;
+  iterador->restantes = 0;
+}
+
+/*
+ * Estado de uma listagem: a saída em buffer e quantos livros já foram
+ * escritos.
+ */
+typedef struct
+{
+  Saida saida; // Saída em buffer
+  int total;   // Livros escritos
+} Listagem;
+
+/*
+ * Escreve um livro na listagem e conta quantos foram escritos.
+ */
+int listarLivro(const Livro *livro, void *contexto)
+{
+  Listagem *listagem = (Listagem *)contexto;
+  listagem->total++;
+  escreverLivro(&listagem->saida, livro->id, livro->titulo, livro->autor, livro->disponivel);
+  return 1;
+}
+
+/*
+ * Lista todos os livros da biblioteca em ordem, com percorrerLivros, no
+ * descritor fd. Os livros são montados no buffer da saída, que é gravado
+ * com um write a cada TAMANHO_BUFFER_SAIDA bytes.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarLivrosDescritor(Biblioteca *bib, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = percorrerLivros(bib, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Biblioteca vazia!\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Lista todos os livros na saída padrão, com listarLivrosDescritor.
+ * O buffer do printf é descarregado antes, para a listagem não passar na
+ * frente de mensagens anteriores.
+ */
+void listarLivros(Biblioteca *bib)
+{
+  fflush(stdout);
+  if (!listarLivrosDescritor(bib, STDOUT_FILENO))
+    printf("Erro ao listar os livros.\n");
+}
+
+/*
+ * Acrescenta um livro ao índice de autores (usado com percorrerLivros).
+ */
+int guardarAutor(const Livro *livro, void *contexto)
+{
+  return adicionarAutor((IndiceAutores *)contexto, livro->autor, livro->id);
+}
+
+/*
+ * Compara dois IDs (para o qsort).
+ */
+int compararIds(const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Retorna o livro de um ID sem materializar nada: o nó do índice ou, para
+ * um livro do catálogo ainda sem nó, a cópia montada em *copia.
+ * Retorna NULL se o ID não estiver na biblioteca.
+ */
+const Livro *livroPorId(Biblioteca *bib, int id, Livro *copia)
+{
+  const Livro *livro = (const Livro *)consultarIndice(&bib->indice, id);
+  if (livro == NULL && bib->catalogo.quantidade > 0)
+  {
+    long pos = procurarCatalogo(&bib->catalogo, id);
+    if (pos >= 0 && bib->catalogo.estados[pos] != ENTRADA_REMOVIDA)
+      livro = livroDoCatalogo(bib, (size_t)pos, copia);
+  }
+  return livro;
+}
+
+/*
+ * Visita os livros de um vetor de IDs em ordem de ID e libera o vetor.
+ * Os IDs são ordenados e os repetidos, pulados; um ID que não está mais na
+ * biblioteca é ignorado.
+ */
+int visitarIds(Biblioteca *bib, VetorIds *ids, VisitarLivro visitar, void *contexto)
+{
+  if (ids->quantidade > 1)
+    qsort(ids->itens, ids->quantidade, sizeof(int), compararIds);
+  int ok = 1;
+  for (size_t i = 0; ok && i < ids->quantidade; i++)
+  {
+    if (i > 0 && ids->itens[i] == ids->itens[i - 1])
+      continue;
+    Livro copia;
+    const Livro *livro = livroPorId(bib, ids->itens[i], &copia);
+    if (livro != NULL)
+      ok = visitar(livro, contexto);
+  }
+  liberarIds(ids);
+  return ok;
+}
+
+/*
+ * Visita os livros de um autor em ordem de ID.
+ *
+ * Como funciona:
+ * 1. Na primeira busca, monta o índice de autores com percorrerLivros
+ *    (uma passada pela lista e pelo catálogo); daí em diante, ele é
+ *    mantido por indexarLivro e desindexarLivro
+ * 2. Acha o autor na tabela hash e copia os IDs dos seus livros
+ * 3. Visita os livros com visitarIds
+ *
+ * Depois da montagem, o custo depende só da quantidade de livros do autor.
+ */
+int buscarPorAutor(Biblioteca *bib, const char *autor, VisitarLivro visitar, void *contexto)
+{
+  if (!bib->comAutores)
+  {
+    bib->comAutores = percorrerLivros(bib, guardarAutor, &bib->autores);
+    if (!bib->comAutores)
+    {
+      descartarAutores(bib);
+      return 0;
+    }
+  }
+
+  const EntradaAutor *entrada = consultarAutor(&bib->autores, autor, strlen(autor));
+  if (entrada == NULL || entrada->quantidade == 0)
+    return 1;
+  VetorIds ids;
+  iniciarIds(&ids);
+  ids.itens = (int *)malloc((size_t)entrada->quantidade * sizeof(int));
+  if (ids.itens == NULL)
+    return 0;
+  memcpy(ids.itens, entrada->ids, (size_t)entrada->quantidade * sizeof(int));
+  ids.quantidade = ids.capacidade = (size_t)entrada->quantidade;
+  return visitarIds(bib, &ids, visitar, contexto);
+}
+
+/*
+ * Acrescenta um livro ao índice de títulos (usado com percorrerLivros).
+ */
+int guardarTitulo(const Livro *livro, void *contexto)
+{
+  return adicionarTitulo((IndiceTitulos *)contexto, livro->titulo, livro->id);
+}
+
+/*
+ * Garante que o índice de títulos está montado.
+ * Na primeira busca por título, monta o índice com percorrerLivros; daí em
+ * diante, ele é mantido por indexarLivro e desindexarLivro. Como as listas
+ * de n-gramas guardam os livros removidos, o índice é remontado quando
+ * eles passam a ser mais que os livros presentes.
+ * Retorna 0 se não houver memória.
+ */
+int montarTitulos(Biblioteca *bib)
+{
+  if (bib->comTitulos && bib->titulos.removidos > bib->titulos.titulos)
+    descartarTitulos(bib);
+  if (!bib->comTitulos)
+  {
+    bib->comTitulos = percorrerLivros(bib, guardarTitulo, &bib->titulos);
+    if (!bib->comTitulos)
+      descartarTitulos(bib);
+  }
+  return bib->comTitulos;
+}
+
+/*
+ * Visita, em ordem de ID, os livros cujo título começa com o prefixo.
+ * A descida pela árvore radix custa o tamanho do prefixo; depois, só os
+ * livros encontrados são visitados.
+ */
+int buscarPorPrefixo(Biblioteca *bib, const char *prefixo, VisitarLivro visitar, void *contexto)
+{
+  if (!montarTitulos(bib))
+    return 0;
+
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!buscarPrefixoTitulos(&bib->titulos, prefixo, strlen(prefixo), &ids))
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+  return visitarIds(bib, &ids, visitar, contexto);
+}
+
+/*
+ * Filtro de uma busca por trecho: repassa ao visitante só os livros cujo
+ * título contém o trecho.
+ */
+typedef struct
+{
+  const char *trecho;   // Trecho buscado
+  size_t tamanho;       // Bytes do trecho
+  VisitarLivro visitar; // Visitante original
+  void *contexto;       // Contexto do visitante original
+} FiltroTrecho;
+
+/*
+ * Confere o trecho no título do livro (usado com percorrerLivros e
+ * visitarIds).
+ */
+int filtrarTrecho(const Livro *livro, void *contexto)
+{
+  FiltroTrecho *filtro = (FiltroTrecho *)contexto;
+  if (!contemTrecho(livro->titulo, tamanhoTexto(livro->titulo), filtro->trecho, filtro->tamanho))
+    return 1;
+  return filtro->visitar(livro, filtro->contexto);
+}
+
+/*
+ * Visita, em ordem de ID, os livros cujo título contém o trecho.
+ *
+ * Como funciona:
+ * 1. Um trecho menor que um n-grama não tem n-gramas para consultar, então
+ *    a biblioteca inteira é percorrida e filtrada
+ * 2. Senão, pega os candidatos na menor lista entre as dos n-gramas do
+ *    trecho
+ * 3. Visita os candidatos com visitarIds, conferindo o trecho no título
+ *    atual de cada um (o que também descarta os livros já removidos)
+ */
+int buscarPorTrecho(Biblioteca *bib, const char *trecho, VisitarLivro visitar, void *contexto)
+{
+  FiltroTrecho filtro;
+  filtro.trecho = trecho;
+  filtro.tamanho = strlen(trecho);
+  filtro.visitar = visitar;
+  filtro.contexto = contexto;
+  if (filtro.tamanho < TAMANHO_NGRAMA)
+    return percorrerLivros(bib, filtrarTrecho, &filtro);
+  if (!montarTitulos(bib))
+    return 0;
+
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!candidatosTrecho(&bib->titulos, trecho, filtro.tamanho, &ids))
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+  return visitarIds(bib, &ids, filtrarTrecho, &filtro);
+}
+
+/*
+ * Acrescenta um livro ao índice de palavras (usado com percorrerLivros).
+ */
+int guardarPalavras(const Livro *livro, void *contexto)
+{
+  return adicionarPalavras((IndicePalavras *)contexto, livro->titulo, livro->autor, livro->id);
+}
+
+/*
+ * Livro encontrado por uma busca por palavras, com a sua pontuação.
+ */
+typedef struct
+{
+  double pontos; // Pontuação do livro para a consulta
+  int id;        // ID do livro
+} Resultado;
+
+/*
+ * Compara dois resultados (para o qsort): maior pontuação primeiro e, no
+ * empate, menor ID.
+ */
+int compararResultados(const void *a, const void *b)
+{
+  const Resultado *x = (const Resultado *)a;
+  const Resultado *y = (const Resultado *)b;
+  if (x->pontos != y->pontos)
+    return x->pontos < y->pontos ? 1 : -1;
+  return (x->id > y->id) - (x->id < y->id);
+}
+
+/*
+ * Visita os livros que têm todas as palavras da consulta, do mais
+ * relevante para o menos.
+ *
+ * Como funciona:
+ * 1. Monta o índice de palavras na primeira busca (como o de títulos, ele
+ *    é remontado quando os removidos passam a ser mais que os presentes)
+ * 2. Quebra a consulta em palavras normalizadas e intersecta as listas
+ * 3. Confere e pontua cada livro encontrado com pontuarLivro, o que
+ *    também descarta os removidos
+ * 4. Ordena pela pontuação e visita cada livro pelo índice por ID
+ */
+int buscarPorPalavras(Biblioteca *bib, const char *consulta, VisitarLivro visitar, void *contexto)
+{
+  if (bib->comPalavras && bib->palavras.removidos > bib->palavras.livros)
+    descartarPalavras(bib);
+  if (!bib->comPalavras)
+  {
+    bib->comPalavras = percorrerLivros(bib, guardarPalavras, &bib->palavras);
+    if (!bib->comPalavras)
+    {
+      descartarPalavras(bib);
+      return 0;
+    }
+  }
+
+  ConsultaPalavras termos;
+  if (prepararConsulta(&bib->palavras, consulta, &termos) == 0)
+    return 1;
+  VetorIds ids;
+  iniciarIds(&ids);
+  if (!intersectarPalavras(&bib->palavras, &termos, &ids))
+  {
+    liberarIds(&ids);
+    descartarPalavras(bib);
+    return 0;
+  }
+  size_t espaco = ids.quantidade > 0 ? ids.quantidade : 1;
+  Resultado *resultados = (Resultado *)malloc(espaco * sizeof(Resultado));
+  if (resultados == NULL)
+  {
+    liberarIds(&ids);
+    return 0;
+  }
+
+  size_t quantidade = 0;
+  for (size_t i = 0; i < ids.quantidade; i++)
+  {
+    Livro copia;
+    const Livro *livro = livroPorId(bib, ids.itens[i], &copia);
+    if (livro == NULL)
+      continue;
+    double pontos = pontuarLivro(&termos, livro->titulo, livro->autor);
+    if (pontos >= 0.0)
+    {
+      resultados[quantidade].pontos = pontos;
+      resultados[quantidade].id = livro->id;
+      quantidade++;
+    }
+  }
+  liberarIds(&ids);
+  if (quantidade > 1)
+    qsort(resultados, quantidade, sizeof(Resultado), compararResultados);
+
+  int ok = 1;
+  for (size_t i = 0; ok && i < quantidade; i++)
+  {
+    Livro copia;
+    ok = visitar(livroPorId(bib, resultados[i].id, &copia), contexto);
+  }
+  free(resultados);
+  return ok;
+}
+
+/*
+ * Lista no descritor fd os livros encontrados por uma busca (por autor,
+ * por título ou por palavras), com a mesma saída em buffer da
+ * listagem.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarBuscaDescritor(Biblioteca *bib, BuscarLivros buscar, const char *texto, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = buscar(bib, texto, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Nenhum livro encontrado.\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Acrescenta um livro ao mapa de disponíveis, se estiver disponível
+ * (usado com percorrerLivros).
+ */
+int guardarDisponivel(const Livro *livro, void *contexto)
+{
+  return !livro->disponivel || marcarBit((MapaBits *)contexto, livro->id);
+}
+
+/*
+ * Garante que o mapa de disponíveis está montado.
+ * Na primeira consulta, monta o mapa com percorrerLivros; daí em diante,
+ * ele é mantido por indexarLivro, desindexarLivro e definirDisponivel.
+ * Retorna 0 se não houver memória.
+ */
+int montarDisponiveis(Biblioteca *bib)
+{
+  if (!bib->comDisponiveis)
+  {
+    bib->comDisponiveis = percorrerLivros(bib, guardarDisponivel, &bib->disponiveis);
+    if (!bib->comDisponiveis)
+      descartarDisponiveis(bib);
+  }
+  return bib->comDisponiveis;
+}
+
+/*
+ * Conta os livros disponíveis com ID entre primeiro e ultimo, somando os
+ * bits do mapa de disponíveis, sem visitar os livros.
+ */
+int contarDisponiveis(Biblioteca *bib, int primeiro, int ultimo)
+{
+  if (!montarDisponiveis(bib))
+    return -1;
+  return (int)contarBitsFaixa(&bib->disponiveis, primeiro, ultimo);
+}
+
+/*
+ * Visitante original de uma busca de disponíveis, chamado para cada ID
+ * do mapa.
+ */
+typedef struct
+{
+  Biblioteca *bib;      // Biblioteca consultada
+  VisitarLivro visitar; // Visitante original
+  void *contexto;       // Contexto do visitante original
+} VisitaDisponiveis;
+
+/*
+ * Busca o livro de um ID do mapa e o passa ao visitante original (usado
+ * com percorrerBits).
+ */
+int visitarDisponivel(int id, void *contexto)
+{
+  VisitaDisponiveis *visita = (VisitaDisponiveis *)contexto;
+  Livro copia;
+  const Livro *livro = livroPorId(visita->bib, id, &copia);
+  return livro == NULL || visita->visitar(livro, visita->contexto);
+}
+
+/*
+ * Visita os livros disponíveis de uma faixa: percorre os bits ligados do
+ * mapa na faixa e busca cada livro pelo índice por ID.
+ */
+int buscarDisponiveis(Biblioteca *bib, int primeiro, int ultimo, VisitarLivro visitar, void *contexto)
+{
+  if (!montarDisponiveis(bib))
+    return 0;
+  VisitaDisponiveis visita;
+  visita.bib = bib;
+  visita.visitar = visitar;
+  visita.contexto = contexto;
+  return percorrerBits(&bib->disponiveis, primeiro, ultimo, visitarDisponivel, &visita);
+}
+
+/*
+ * Lista os livros disponíveis de uma faixa no descritor fd, com
+ * buscarDisponiveis e a mesma saída em buffer da listagem.
+ * Se nenhum livro for escrito, escreve uma mensagem.
+ */
+int listarDisponiveisDescritor(Biblioteca *bib, int primeiro, int ultimo, int fd)
+{
+  Listagem listagem;
+  listagem.total = 0;
+  if (!abrirSaida(&listagem.saida, fd))
+    return 0;
+
+  int ok = buscarDisponiveis(bib, primeiro, ultimo, listarLivro, &listagem);
+  if (listagem.total == 0)
+  {
+    const char vazia[] = "Nenhum livro disponível nessa faixa.\n";
+    escreverSaida(&listagem.saida, vazia, sizeof(vazia) - 1);
+  }
+  return fecharSaida(&listagem.saida) && ok;
+}
+
+/*
+ * Muda o status de um livro para `disponivel` e registra a mudança no
+ * diário como empréstimo ou devolução.
+ * Retorna 1 se o status mudou, 0 se o livro já tinha esse status e -1 se
+ * ele não foi encontrado.
+ */
+int mudarDisponivel(Biblioteca *bib, int id, int disponivel)
+{
+  Livro *livro = buscarLivro(bib, id);
+  if (livro == NULL)
+    return -1;
+  if (!livro->disponivel == !disponivel)
+    return 0;
+  definirDisponivel(bib, livro, disponivel);
+  registrarNoDiario(bib, disponivel ? OPERACAO_DEVOLVER : OPERACAO_EMPRESTAR, livro);
+  return 1;
+}
+
+/*
+ * Marca um livro como emprestado.
+ * Busca o livro pelo ID e, se encontrar e estiver disponível,
+ * marca como emprestado.
+ */
+void emprestarLivro(Biblioteca *bib, int id)
+{
+  int resultado = mudarDisponivel(bib, id, 0);
+  if (resultado > 0)
+    printf("Livro emprestado com sucesso!\n");
+  else if (resultado == 0)
+    printf("Livro não está disponível para empréstimo.\n");
+  else
+    printf("Livro não encontrado.\n");
+}
+
+/*
+ * Marca um livro como devolvido.
+ * Busca o livro pelo ID e, se encontrar e estiver emprestado,
+ * marca como disponível.
+ */
+void devolverLivro(Biblioteca *bib, int id)
+{
+  int resultado = mudarDisponivel(bib, id, 1);
+  if (resultado > 0)
+    printf("Livro devolvido com sucesso!\n");
+  else if (resultado == 0)
+    printf("Livro já está disponível.\n");
+  else
+    printf("Livro não encontrado.\n");
+}
+
+/*
+ * Busca um livro pelo ID com a fatia do ID travada para leitura.
+ * livroPorId só lê o índice e o catálogo; a cópia é feita ainda com a
+ * trava, porque um escritor pode mudar o status ou devolver o nó ao pool
+ * logo depois que ela for solta.
+ */
+int consultarLivro(Biblioteca *bib, int id, Livro *copia)
+{
+  int fatia = fatiaDoId(id);
+  travarLeitura(&bib->trava, fatia);
+  Livro lido;
+  const Livro *livro = livroPorId(bib, id, &lido);
+  if (livro != NULL)
+  {
+    *copia = *livro;
+  }
+  destravarLeitura(&bib->trava, fatia);
+  return livro != NULL;
+}
+
+/*
+ * Trava todas as fatias para escrita.
+ */
+void travarBiblioteca(Biblioteca *bib)
+{
+  travarEscrita(&bib->trava);
+}
+
+/*
+ * Solta todas as fatias.
+ */
+void destravarBiblioteca(Biblioteca *bib)
+{
+  destravarEscrita(&bib->trava);
+}
+
+/*
+ * Insere um livro com a biblioteca travada.
+ */
+void inserirLivroConcorrente(Biblioteca *bib, int id, const char *titulo, const char *autor)
+{
+  travarBiblioteca(bib);
+  inserirLivro(bib, id, titulo, autor);
+  destravarBiblioteca(bib);
+}
+
+/*
+ * Remove um livro com a biblioteca travada.
+ */
+void removerLivroConcorrente(Biblioteca *bib, int id)
+{
+  travarBiblioteca(bib);
+  removerLivro(bib, id);
+  destravarBiblioteca(bib);
+}
+
+/*
+ * Empresta um livro com a biblioteca travada.
+ */
+int emprestarLivroConcorrente(Biblioteca *bib, int id)
+{
+  travarBiblioteca(bib);
+  int resultado = mudarDisponivel(bib, id, 0);
+  destravarBiblioteca(bib);
+  return resultado > 0;
+}
+
+/*
+ * Devolve um livro com a biblioteca travada.
+ */
+int devolverLivroConcorrente(Biblioteca *bib, int id)
+{
+  travarBiblioteca(bib);
+  int resultado = mudarDisponivel(bib, id, 1);
+  destravarBiblioteca(bib);
+  return resultado > 0;
+}
+
+/*
+ * Escreve um livro no arquivo, no formato id|titulo|autor|disponivel.
+ */
+void salvarLivro(FILE *arquivo, const Livro *livro)
+{
+  fprintf(arquivo, "%d|%s|%s|%d\n",
+          livro->id,
+          livro->titulo,
+          livro->autor,
+          livro->disponivel);
+}
+
+/*
+ * Escreve no arquivo passado como contexto um livro visitado por
+ * percorrerLivros.
+ */
+int exportarLivro(const Livro *livro, void *contexto)
+{
+  salvarLivro((FILE *)contexto, livro);
+  return 1;
+}
+
+/*
+ * Salva todos os livros em um arquivo.
+ * Percorre os livros em ordem com percorrerLivros, salvando os dados de
+ * cada livro em formato texto, separados por '|'.
+ */
+void salvarLivros(Biblioteca *bib, FILE *arquivo)
+{
+  if (arquivo == NULL)
+    return;
+
+  percorrerLivros(bib, exportarLivro, arquivo);
+  printf("Livros salvos com sucesso!\n");
+}
+
+/*
+ * Acrescenta um livro ao vetor de registros passado como contexto.
+ */
+int guardarRegistro(const Livro *livro, void *contexto)
+{
+  RegistroLivro registro = {livro->id, livro->disponivel, livro->titulo, livro->autor};
+  return adicionarRegistro((VetorRegistros *)contexto, &registro);
+}
+
+/*
+ * Grava o snapshot da biblioteca.
+ * Junta os livros em ordem num vetor de registros com percorrerLivros e
+ * grava tudo de uma vez com salvarSnapshot. Os textos já estão no formato
+ * do arquivo, na arena ou nas páginas do catálogo mapeado.
+ */
+int gravarSnapshot(void *contexto, FILE *arquivo)
+{
+  if (arquivo == NULL)
+    return 0;
+
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  int ok = percorrerLivros((Biblioteca *)contexto, guardarRegistro, &registros) &&
+           salvarSnapshot(arquivo, registros.itens, registros.quantidade);
+  liberarRegistros(&registros);
+  return ok;
+}
+
+/*
+ * Salva todos os livros em formato binário (snapshot), usando
+ * gravarSnapshot.
+ */
+int salvarLivrosBinario(Biblioteca *bib, FILE *arquivo)
+{
+  int ok = gravarSnapshot(bib, arquivo);
+  if (ok)
+    printf("Livros salvos com sucesso!\n");
+  else
+    printf("Erro ao salvar os livros.\n");
+  return ok;
+}
+
+/*
+ * Insere registros em ordem de ID, com os textos já na arena.
+ * Os livros entram pelo fim da lista sem cópia dos textos, e o índice é
+ * reservado de uma vez para todos. Um ID que já existe só tem a
+ * disponibilidade atualizada, como na inserção por inserirLivro.
+ * Retorna 0 se não houver memória.
+ */
+int inserirRegistros(Biblioteca *bib, VetorRegistros *registros)
+{
+  int ok = reservarIndice(&bib->indice, bib->indice.quantidade + registros->quantidade);
+  for (size_t i = 0; ok && i < registros->quantidade; i++)
+  {
+    RegistroLivro *registro = &registros->itens[i];
+    Livro *livro = buscarLivro(bib, registro->id);
+    if (livro == NULL)
+      livro = inserirLivroArena(bib, registro->id, registro->titulo, registro->autor);
+    if (livro == NULL)
+      ok = 0;
+    else
+      definirDisponivel(bib, livro, registro->disponivel);
+  }
+  return ok;
+}
+
+/*
+ * Carrega um snapshot binário para a biblioteca.
+ * Os textos são lidos direto para a arena e os livros, que vêm em ordem de
+ * ID, são inseridos por inserirRegistros.
+ * Retorna 0 se o arquivo for inválido ou não houver memória.
+ */
+int carregarSnapshot(Biblioteca *bib, FILE *arquivo)
+{
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  int ok = lerSnapshot(arquivo, &bib->textos, &registros) && inserirRegistros(bib, &registros);
+  liberarRegistros(&registros);
+  return ok;
+}
+
+/*
+ * Carrega um arquivo texto numa biblioteca vazia, em lote.
+ * O arquivo é lido em paralelo por lerRegistrosTexto, os registros são
+ * ordenados por ID (a ordenação é estável, então IDs repetidos continuam
+ * na ordem do arquivo) e inseridos por inserirRegistros.
+ * Retorna 0 se não houver memória.
+ */
+int carregarTextoEmLote(Biblioteca *bib, FILE *arquivo)
+{
+  VetorRegistros registros;
+  iniciarRegistros(&registros);
+  int ok = lerRegistrosTexto(arquivo, 0, &bib->textos, &registros) &&
+           ordenarRegistros(&registros) && inserirRegistros(bib, &registros);
+  liberarRegistros(&registros);
+  return ok;
+}
+
+/*
+ * Aplica uma operação lida do diário, sem imprimir mensagens.
+ * Empréstimo e devolução só definem o status, então reaplicar uma operação
+ * que o snapshot já contém não muda nada.
+ */
+void aplicarOperacao(void *contexto, TipoOperacao operacao, int id, const char *titulo, const char *autor)
+{
+  Biblioteca *bib = (Biblioteca *)contexto;
+  Livro *livro;
+  switch (operacao)
+  {
+  case OPERACAO_INSERIR:
+    inserirLivro(bib, id, titulo, autor);
+    break;
+  case OPERACAO_REMOVER:
+    removerLivro(bib, id);
+    break;
+  default:
+    livro = buscarLivro(bib, id);
+    if (livro != NULL)
+      definirDisponivel(bib, livro, operacao == OPERACAO_DEVOLVER);
+  }
+}
+
+/*
+ * Reaplica o diário da biblioteca, se houver, por cima do que acabou de
+ * ser carregado. O diário fica desligado durante a reaplicação, para as
+ * operações não serem registradas de novo. Se o diário for lido até o fim,
+ * a memória passa a conter todas as operações dele e um salvamento já pode
+ * rotacioná-lo.
+ */
+void reaplicarDiario(Biblioteca *bib)
+{
+  Diario *diario = bib->diario;
+  if (diario == NULL)
+    return;
+
+  bib->diario = NULL;
+  long aplicadas = reproduzirDiario(diario, aplicarOperacao, bib);
+  bib->diario = diario;
+  if (aplicadas < 0)
+    printf("Erro ao ler o diário de operações.\n");
+  else if (aplicadas > 0)
+    printf("%ld operações do diário reaplicadas.\n", aplicadas);
+  if (aplicadas >= 0)
+    bib->diarioReaplicado = 1;
+}
+
+/*
+ * Recebe uma linha lida por lerArquivoLivros e insere o livro.
+ * Os campos são usados direto do bloco lido; a cópia para a arena acontece
+ * uma única vez, em inserirLivro, com o tamanho exato.
+ */
+int receberLivroTexto(void *contexto, const CamposLivro *campos)
+{
+  Biblioteca *bib = (Biblioteca *)contexto;
+  Livro *livro = inserirLivro(bib, campos->id, campos->titulo, campos->autor);
+  if (livro != NULL)
+  {
+    definirDisponivel(bib, livro, campos->disponivel);
+  }
+  return 1;
+}
+
+/*
+ * Carrega livros de um arquivo para a biblioteca.
+ * Se o arquivo for um snapshot binário, usa carregarSnapshot. Senão, lê o
+ * arquivo texto: com a biblioteca vazia, em lote e em paralelo por
+ * carregarTextoEmLote; senão, em blocos grandes com lerArquivoLivros,
+ * inserindo um livro para cada linha.
+ * Os dados são lidos no formato: id|titulo|autor|disponivel
+ * O diário fica desligado durante a carga.
+ * Retorna 1 se todos os livros foram carregados.
+ */
+int carregarArquivo(Biblioteca *bib, const char *nomeArquivo)
+{
+  FILE *arquivo = fopen(nomeArquivo, "rb");
+  if (arquivo == NULL)
+  {
+    printf("Erro ao abrir arquivo para leitura.\n");
+    return 0;
+  }
+
+  Diario *diario = bib->diario;
+  bib->diario = NULL;
+
+  if (ehSnapshot(arquivo))
+  {
+    int ok = carregarSnapshot(bib, arquivo);
+    bib->diario = diario;
+    fclose(arquivo);
+    if (ok)
+      printf("Livros carregados com sucesso!\n");
+    else
+      printf("Arquivo inválido ou memória insuficiente para carregar os livros.\n");
+    return ok;
+  }
+
+  int ok;
+  if (bib->indice.quantidade == 0 && bib->catalogo.mapa == NULL)
+    ok = carregarTextoEmLote(bib, arquivo);
+  else
+    ok = lerArquivoLivros(arquivo, receberLivroTexto, bib);
+  bib->diario = diario;
+  fclose(arquivo);
+  if (ok)
+    printf("Livros carregados com sucesso!\n");
+  else
+    printf("Erro ao ler o arquivo ou memória insuficiente para carregar os livros.\n");
+  return ok;
+}
+
+/*
+ * Carrega o arquivo principal da biblioteca e reaplica o diário por cima,
+ * seja o arquivo um snapshot ou texto: as operações do diário são
+ * idempotentes, então reaplicar as que o arquivo já contém não muda nada.
+ */
+void carregarLivros(Biblioteca *bib, const char *nomeArquivo)
+{
+  if (carregarArquivo(bib, nomeArquivo))
+    reaplicarDiario(bib);
+}
+
+/*
+ * Importa livros de um arquivo sem reaplicar o diário, que não se refere
+ * a ele.
+ */
+void importarLivros(Biblioteca *bib, const char *nomeArquivo)
+{
+  carregarArquivo(bib, nomeArquivo);
+}
+
+/*
+ * Abre um snapshot como catálogo mapeado.
+ * Só é permitido com a biblioteca vazia, para os livros do catálogo não
+ * repetirem IDs de livros que já estão na lista.
+ */
+void mapearCatalogo(Biblioteca *bib, const char *nomeArquivo)
+{
+  if (bib->indice.quantidade > 0 || bib->catalogo.mapa != NULL)
+  {
+    printf("O catálogo só pode ser aberto com a biblioteca vazia.\n");
+    return;
+  }
+  if (abrirCatalogo(&bib->catalogo, nomeArquivo))
+  {
+    printf("Catálogo aberto com %zu livros!\n", bib->catalogo.quantidade);
+    reaplicarDiario(bib);
+  }
+  else
+  {
+    printf("Arquivo inválido ou memória insuficiente para abrir o catálogo.\n");
+  }
 }
\ No newline at end of file
@@ -13,49 +13,224 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_TITULO 500 // Tamanho máximo para o título do livro
-#define MAX_AUTOR 500  // Tamanho máximo para o nome do autor
+#include "../Comum/arena.h"
+#include "../Comum/autores.h"
+#include "../Comum/mapabits.h"
+#include "../Comum/palavras.h"
+#include "../Comum/titulos.h"
+#include "../Comum/catalogo.h"
+#include "../Comum/compactacao.h"
+#include "../Comum/diario.h"
+#include "../Comum/indice.h"
+#include "../Comum/leitor.h"
+#include "../Comum/pool.h"
+#include "../Comum/saida.h"
+#include "../Comum/snapshot.h"
+#include "../Comum/trava.h"
+
+#define MAX_TITULO 500 // Tamanho máximo do título digitado no menu
+#define MAX_AUTOR 500  // Tamanho máximo do autor digitado no menu
+
+#define MAX_NIVEL_SALTOS 16 // Quantidade máxima de níveis expressos da lista de saltos
+#define LIVROS_POR_BLOCO 64 // Capacidade de cada bloco da lista desenrolada
+
+/*
+ * Tipos de lista suportados pela biblioteca.
+ * A lista simples percorre os livros um a um; a lista de saltos mantém,
+ * sobre a mesma lista ordenada, "vias expressas" que pulam vários livros
+ * de uma vez, dando busca, inserção e remoção em O(log n) esperado.
+ * A lista desenrolada liga blocos de até LIVROS_POR_BLOCO livros guardados
+ * em vetor, então os percursos leem memória contígua em vez de saltar de
+ * nó em nó.
+ */
+typedef enum
+{
+  LISTA_SIMPLES,    // Lista ordenada simples
+  LISTA_SALTOS,     // Lista ordenada com índice de saltos (skip list)
+  LISTA_DESENROLADA // Lista ordenada de blocos com vetores de livros (unrolled list)
+} TipoLista;
 
 /*
- * Estrutura que representa um livro na lista.
+ * Estrutura que representa um livro.
  * Cada livro tem um ID único, título, autor e status de disponibilidade.
- * O ponteiro prox aponta para o próximo livro na lista.
+ *
+ * Guarda apenas os dados do livro: título e autor ficam fora dele, na arena
+ * de textos da biblioteca, e são acessados só quando o livro é exibido ou
+ * salvo. Assim o livro ocupa 24 bytes em vez de mais de 1 KB. As ligações
+ * da lista ficam no nó (NoLivro) ou no bloco (BlocoLivros) que o contém.
  */
-typedef struct Livro
+typedef struct
 {
-  int id;                  // ID único do livro
-  char titulo[MAX_TITULO]; // Título do livro
-  char autor[MAX_AUTOR];   // Nome do autor
-  int disponivel;          // 1 se disponível, 0 se emprestado
-  struct Livro *prox;      // Ponteiro para o próximo livro
+  int id;         // ID único do livro
+  int disponivel; // 1 se disponível, 0 se emprestado
+  char *titulo;   // Título do livro (na arena da biblioteca)
+  char *autor;    // Nome do autor (na arena da biblioteca)
 } Livro;
 
+/*
+ * Nó da lista simples e da lista de saltos.
+ * O ponteiro prox aponta para o próximo nó na lista.
+ *
+ * Na lista de saltos, saltos aponta para a "torre" do nó: saltos[k] é o
+ * próximo nó no nível k + 1 (o nível 0 é o próprio prox). A maioria dos
+ * nós não sobe de nível e fica com saltos NULL.
+ */
+typedef struct NoLivro
+{
+  Livro livro;             // Dados do livro
+  struct NoLivro *prox;    // Ponteiro para o próximo nó
+  struct NoLivro **saltos; // Próximos nós nos níveis expressos (ou NULL)
+} NoLivro;
+
+/*
+ * Bloco da lista desenrolada.
+ * Guarda até LIVROS_POR_BLOCO livros em ordem de ID, lado a lado no vetor
+ * livros; todos os IDs de um bloco são menores que os do bloco seguinte.
+ */
+typedef struct BlocoLivros
+{
+  int quantidade;                 // Livros em uso no vetor
+  struct BlocoLivros *prox;       // Próximo bloco da lista
+  Livro livros[LIVROS_POR_BLOCO]; // Livros do bloco, ordenados por ID
+} BlocoLivros;
+
 /*
  * Estrutura principal da biblioteca.
- * Mantém apenas o ponteiro para o início da lista.
+ * Mantém o ponteiro para o início da lista, o pool de onde saem os nós e a
+ * arena onde ficam os títulos e autores de todos os livros. Os textos de
+ * livros removidos só são devolvidos quando a biblioteca é destruída; os
+ * nós removidos voltam ao pool e são reusados.
+ *
+ * Os ponteiros fim e dedo aceleram a inserção: um livro com ID maior que
+ * todos vai direto para o fim, e um livro com ID maior que o do último
+ * inserido começa a procurar sua posição a partir dele, e não do início.
+ * Assim, carregar um arquivo em ordem de ID custa O(1) por livro.
+ *
+ * Na lista de saltos, cabecas[k] é o primeiro nó do nível k + 1 e
+ * nivelSaltos é o nível mais alto em uso (0 quando só há a lista base).
+ *
+ * Na lista desenrolada, os livros ficam em blocos e ultimoBloco cumpre o
+ * papel de fim; inicio, fim, dedo e o pool não são usados.
+ *
+ * Nos três tipos, o índice hash leva de cada ID ao seu livro, então buscas,
+ * empréstimos e devoluções não percorrem a lista; a lista continua sendo
+ * usada para listar e salvar em ordem. Na lista desenrolada, os livros que
+ * mudam de lugar num bloco são reapontados no índice.
+ *
+ * Com um catálogo mapeado aberto (mapearCatalogo), os livros do catálogo
+ * não entram na lista: buscas e listagens usam direto as páginas
+ * mapeadas. Um livro do catálogo só ganha um nó (fora da lista, só no
+ * índice) na primeira vez que é buscado, para poder ser emprestado ou
+ * devolvido. A lista guarda só os livros inseridos depois, e a listagem
+ * intercala as duas sequências em ordem de ID.
+ *
+ * O índice de autores leva de cada autor aos IDs dos seus livros. Ele só é
+ * montado na primeira busca por autor (então carregar ou mapear livros não
+ * paga por ele) e, daí em diante, acompanha cada livro que entra ou sai
+ * do índice por ID. O índice de títulos (árvore radix e n-gramas) e o de
+ * palavras seguem a mesma regra, a partir da primeira busca por título ou
+ * por palavras. O mapa de disponíveis guarda os IDs dos livros
+ * disponíveis num mapa de bits comprimido; é montado na primeira consulta
+ * de disponíveis e acompanha também os empréstimos e as devoluções.
+ *
+ * Com um diário ligado, cada inserção, remoção, empréstimo e devolução
+ * feita pelas funções abaixo é registrada nele; a carga de arquivos não é.
+ *
+ * A trava fatiada deixa a biblioteca ser usada por várias threads:
+ * consultarLivro trava só uma fatia para leitura, então buscas por ID
+ * de threads diferentes correm em paralelo; travarBiblioteca e as
+ * funções terminadas em Concorrente travam todas as fatias. As demais
+ * funções não travam nada e, com outras threads usando a biblioteca,
+ * devem ser chamadas entre travarBiblioteca e destravarBiblioteca. Isso
+ * vale também para buscarLivro e as buscas por autor, título, palavras e
+ * disponíveis, que podem montar índices e dar nó a livros do catálogo.
  */
 typedef struct
 {
-  Livro *inicio; // Ponteiro para o primeiro livro da lista
+  NoLivro *inicio;                    // Ponteiro para o primeiro nó da lista
+  NoLivro *fim;                       // Ponteiro para o último nó da lista (maior ID)
+  NoLivro *dedo;                      // Último nó inserido (ponto de partida da próxima busca)
+  TipoLista tipo;                     // Lista simples, de saltos ou desenrolada
+  int nivelSaltos;                    // Nível expresso mais alto em uso
+  NoLivro *cabecas[MAX_NIVEL_SALTOS]; // Primeiro nó de cada nível expresso
+  BlocoLivros *blocos;                // Primeiro bloco da lista desenrolada
+  BlocoLivros *ultimoBloco;           // Último bloco da lista desenrolada (maiores IDs)
+  PoolNos nos;                        // Pool de nós da lista
+  Arena textos;                       // Títulos e autores dos livros
+  IndiceHash indice;                  // Índice de ID para livro
+  IndiceAutores autores;              // Índice de autor para IDs (montado na primeira busca por autor)
+  int comAutores;                     // 1 se o índice de autores está montado e sendo mantido
+  IndiceTitulos titulos;              // Índice de títulos (montado na primeira busca por título)
+  int comTitulos;                     // 1 se o índice de títulos está montado e sendo mantido
+  IndicePalavras palavras;            // Índice de palavras (montado na primeira busca por palavras)
+  int comPalavras;                    // 1 se o índice de palavras está montado e sendo mantido
+  MapaBits disponiveis;               // IDs dos livros disponíveis (montado na primeira consulta)
+  int comDisponiveis;                 // 1 se o mapa de disponíveis está montado e sendo mantido
+  Catalogo catalogo;                  // Catálogo mapeado (fechado se não for usado)
+  Diario *diario;                     // Diário de operações (NULL se não for usado)
+  int diarioReaplicado;               // 1 se a memória já contém as operações do diário (livros.dat carregado e diário reaplicado)
+  TravaFatiada trava;                 // Trava de leitura e escrita das threads
 } Biblioteca;
 
 /*
- * Cria uma nova biblioteca vazia.
+ * Função chamada para cada livro por percorrerLivros.
+ * Retorna 0 para interromper o percurso.
+ */
+typedef int (*VisitarLivro)(const Livro *livro, void *contexto);
+
+/*
+ * Iterador sobre os livros de uma faixa de IDs, em ordem.
+ * Faz o mesmo percurso de percorrerLivros, mas um livro por chamada de
+ * proximoLivro, e começa já no primeiro ID da faixa. Só um de no e bloco
+ * é usado, conforme o tipo de lista. Com um catálogo mapeado, as entradas
+ * do catálogo são intercaladas em ordem de ID.
+ * A biblioteca não pode ser alterada enquanto o iterador estiver aberto.
+ */
+typedef struct
+{
+  Biblioteca *bib;     // Biblioteca percorrida
+  NoLivro *no;         // Próximo nó (lista simples ou de saltos)
+  BlocoLivros *bloco;  // Bloco atual (lista desenrolada)
+  int posBloco;        // Próximo livro do bloco atual
+  size_t posCatalogo;  // Próxima entrada do catálogo mapeado
+  long long ultimo;    // Maior ID da faixa
+  size_t restantes;    // Livros que ainda podem ser devolvidos
+  int erro;            // Sempre 0: o iterador da lista não aloca memória
+  Livro copia;         // Cópia do último livro lido das páginas mapeadas
+} IteradorLivros;
+
+/*
+ * Cria uma nova biblioteca vazia usando a lista simples.
  * Retorna um ponteiro para a biblioteca criada ou NULL se houver erro.
  */
 Biblioteca *criarBiblioteca();
 
+/*
+ * Cria uma nova biblioteca vazia usando o tipo de lista informado.
+ * Retorna um ponteiro para a biblioteca criada ou NULL se houver erro.
+ */
+Biblioteca *criarBibliotecaTipo(TipoLista tipo);
+
 /*
  * Libera toda a memória alocada para a biblioteca.
- * Percorre a lista liberando cada livro e depois libera a estrutura da biblioteca.
+ * Libera o pool de nós e a arena de textos de uma só vez, sem percorrer
+ * a lista (na lista de saltos, só as torres do primeiro nível expresso são
+ * percorridas; na desenrolada, só os blocos), e depois libera a estrutura
+ * da biblioteca.
  */
 void destruirBiblioteca(Biblioteca *bib);
 
 /*
  * Insere um novo livro na biblioteca.
- * O livro é inserido mantendo a lista ordenada por ID.
+ * O livro é inserido mantendo a lista ordenada por ID; na lista de saltos
+ * ele também recebe uma torre de altura sorteada.
+ * Se o ID já existir, nada é inserido e o livro existente é retornado.
+ * Retorna o livro inserido ou NULL se não houver memória. Na lista
+ * desenrolada os livros mudam de lugar dentro dos blocos, então o ponteiro
+ * retornado (assim como o de buscarLivro) só vale até a próxima inserção
+ * ou remoção.
  */
-void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor);
+Livro *inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor);
 
 /*
  * Remove um livro da biblioteca pelo ID.
@@ -64,17 +239,149 @@ void inserirLivro(Biblioteca *bib, int id, const char *titulo, const char *autor
 void removerLivro(Biblioteca *bib, int id);
 
 /*
- * Busca um livro pelo ID.
+ * Busca um livro pelo ID, pelo índice hash (O(1) esperado).
+ * Com um catálogo mapeado, um ID fora do índice é procurado no catálogo
+ * por busca binária e, se estiver lá, ganha um nó na hora.
  * Retorna um ponteiro para o livro encontrado ou NULL se não encontrar.
  */
 Livro *buscarLivro(Biblioteca *bib, int id);
 
+/*
+ * Visita todos os livros da biblioteca em ordem de ID, intercalando os da
+ * lista com os do catálogo mapeado, se houver. Os livros do catálogo
+ * ainda sem nó são passados numa cópia temporária. A lista não pode ser
+ * alterada durante o percurso.
+ * Retorna 0 se a visita for interrompida.
+ */
+int percorrerLivros(Biblioteca *bib, VisitarLivro visitar, void *contexto);
+
 /*
  * Lista todos os livros da biblioteca em ordem.
- * A listagem é feita percorrendo a lista do início ao fim.
+ * A listagem é feita percorrendo a lista do início ao fim. Os livros são
+ * montados num buffer grande e gravados na saída padrão com poucas
+ * chamadas a write.
  */
 void listarLivros(Biblioteca *bib);
 
+/*
+ * Lista todos os livros em ordem no descritor de arquivo fd (um arquivo
+ * aberto, um pipe ou a saída padrão), no mesmo formato de listarLivros.
+ * O descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarLivrosDescritor(Biblioteca *bib, int fd);
+
+/*
+ * Visita, em ordem de ID, os livros cujo autor é exatamente `autor`. A
+ * primeira busca monta o índice de autores percorrendo a biblioteca uma
+ * vez; as seguintes custam só o tamanho da resposta. Os livros do
+ * catálogo ainda sem nó são passados numa cópia temporária, sem ganhar um
+ * nó. A biblioteca não pode ser alterada durante a visita.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorAutor(Biblioteca *bib, const char *autor, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita, em ordem de ID, os livros cujo título começa com `prefixo`. A
+ * primeira busca por título monta o índice de títulos percorrendo a
+ * biblioteca uma vez; as seguintes custam o tamanho do prefixo mais o
+ * tamanho da resposta. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorPrefixo(Biblioteca *bib, const char *prefixo, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita, em ordem de ID, os livros cujo título contém `trecho` em
+ * qualquer posição. Usa o índice de n-gramas do índice de títulos, então
+ * só os livros da menor lista entre as dos n-gramas do trecho são
+ * conferidos; um trecho com menos de TAMANHO_NGRAMA bytes percorre a
+ * biblioteca inteira. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorTrecho(Biblioteca *bib, const char *trecho, VisitarLivro visitar, void *contexto);
+
+/*
+ * Visita os livros que têm todas as palavras da consulta no título ou no
+ * autor, sem diferenciar maiúsculas e acentos ("tolkien aneis" acha
+ * "O Senhor dos Anéis", de J.R.R. Tolkien). Os livros vêm do mais
+ * relevante para o menos: palavras raras e achadas no título pesam mais, e
+ * livros com menos palavras ficam na frente (veja pontuarLivro). A
+ * primeira busca monta o índice de palavras percorrendo a biblioteca uma
+ * vez; as seguintes custam a intersecção das listas das palavras.
+ * Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarPorPalavras(Biblioteca *bib, const char *consulta, VisitarLivro visitar, void *contexto);
+
+/*
+ * Função de busca que recebe um texto: buscarPorAutor, buscarPorPrefixo,
+ * buscarPorTrecho ou buscarPorPalavras.
+ */
+typedef int (*BuscarLivros)(Biblioteca *bib, const char *texto, VisitarLivro visitar, void *contexto);
+
+/*
+ * Lista no descritor fd os livros encontrados por `buscar` com o texto
+ * dado, na ordem da busca e no mesmo formato de listarLivros. O
+ * descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarBuscaDescritor(Biblioteca *bib, BuscarLivros buscar, const char *texto, int fd);
+
+/*
+ * Conta os livros disponíveis com ID entre primeiro e ultimo (inclusive),
+ * pelo mapa de disponíveis: contêineres inteiros dentro da faixa são
+ * contados sem olhar os bits, e os outros com popcount, 64 IDs por vez.
+ * Para contar todos, use a faixa de INT_MIN a INT_MAX.
+ * Retorna -1 se faltar memória para montar o mapa.
+ */
+int contarDisponiveis(Biblioteca *bib, int primeiro, int ultimo);
+
+/*
+ * Visita, em ordem de ID, os livros disponíveis com ID entre primeiro e
+ * ultimo (inclusive). É a faixa de iniciarIterador restrita aos
+ * disponíveis, mas percorre só os bits ligados do mapa, sem passar pelos
+ * livros emprestados. Os livros são passados como em buscarPorAutor.
+ * Retorna 0 se faltar memória ou se a visita for interrompida.
+ */
+int buscarDisponiveis(Biblioteca *bib, int primeiro, int ultimo, VisitarLivro visitar, void *contexto);
+
+/*
+ * Lista os livros disponíveis de uma faixa no descritor fd, em ordem de
+ * ID e no mesmo formato de listarLivros. O descritor não é fechado.
+ * Retorna 0 se faltar memória ou se a gravação falhar.
+ */
+int listarDisponiveisDescritor(Biblioteca *bib, int primeiro, int ultimo, int fd);
+
+/*
+ * Inicia um iterador sobre os livros com ID entre primeiro e ultimo
+ * (inclusive), em ordem de ID. O primeiro livro é achado em O(log n)
+ * esperado na lista de saltos e pulando de bloco em bloco na desenrolada;
+ * na lista simples, a busca percorre os nós até a faixa. Depois, cada
+ * livro seguinte custa O(1).
+ * Retorna 0 se não houver memória (nunca acontece na lista).
+ */
+int iniciarIterador(IteradorLivros *iterador, Biblioteca *bib, int primeiro, int ultimo);
+
+/*
+ * Inicia um iterador na página `pagina` (começando em 0) da listagem em
+ * ordem de ID, com páginas de `tamanho` livros. Os livros das páginas
+ * anteriores são pulados um a um.
+ * Retorna 0 se não houver memória.
+ */
+int iniciarPagina(IteradorLivros *iterador, Biblioteca *bib, size_t pagina, size_t tamanho);
+
+/*
+ * Devolve o próximo livro do iterador ou NULL quando ele terminar. Um
+ * livro do catálogo ainda sem nó é devolvido numa cópia, que só vale até
+ * a próxima chamada.
+ */
+const Livro *proximoLivro(IteradorLivros *iterador);
+
+/*
+ * Termina o iterador.
+ */
+void fecharIterador(IteradorLivros *iterador);
+
 /*
  * Marca um livro como emprestado.
  * Verifica se o livro existe e está disponível antes de emprestar.
@@ -88,15 +395,103 @@ void emprestarLivro(Biblioteca *bib, int id);
 void devolverLivro(Biblioteca *bib, int id);
 
 /*
- * Salva todos os livros em um arquivo.
- * Os livros são salvos em ordem, do início ao fim da lista.
+ * Busca um livro pelo ID podendo ser chamada por várias threads ao mesmo
+ * tempo. Trava para leitura só a fatia do ID e não altera nada (um livro
+ * do catálogo não ganha nó), então buscas de IDs diferentes quase nunca
+ * disputam a mesma linha de cache. O ID, o status, o título e o autor são
+ * copiados para *copia antes de soltar a trava; título e autor continuam
+ * válidos até a biblioteca ser destruída.
+ * Retorna 1 se o livro foi encontrado.
+ */
+int consultarLivro(Biblioteca *bib, int id, Livro *copia);
+
+/*
+ * Trava a biblioteca inteira para escrita, esperando as consultas em
+ * andamento terminarem. Até destravarBiblioteca, nenhuma outra thread lê
+ * nem altera a biblioteca.
+ */
+void travarBiblioteca(Biblioteca *bib);
+
+/*
+ * Solta a trava de travarBiblioteca.
+ */
+void destravarBiblioteca(Biblioteca *bib);
+
+/*
+ * Insere um livro como inserirLivro, com a biblioteca travada.
+ */
+void inserirLivroConcorrente(Biblioteca *bib, int id, const char *titulo, const char *autor);
+
+/*
+ * Remove um livro como removerLivro, com a biblioteca travada.
+ */
+void removerLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Empresta um livro como emprestarLivro, com a biblioteca travada e sem
+ * mensagens.
+ * Retorna 1 se o livro foi emprestado, 0 se não existe ou já estava
+ * emprestado.
+ */
+int emprestarLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Devolve um livro como devolverLivro, com a biblioteca travada e sem
+ * mensagens.
+ * Retorna 1 se o livro foi devolvido, 0 se não existe ou já estava
+ * disponível.
+ */
+int devolverLivroConcorrente(Biblioteca *bib, int id);
+
+/*
+ * Salva todos os livros em um arquivo texto (exportação).
+ * Os livros são salvos em ordem, do início ao fim da lista, uma linha
+ * id|titulo|autor|disponivel por livro.
  */
 void salvarLivros(Biblioteca *bib, FILE *arquivo);
 
+/*
+ * Salva todos os livros em um arquivo no formato binário (snapshot).
+ * Os livros são salvos em ordem de ID, com poucas escritas grandes.
+ * O arquivo deve ter sido aberto em modo binário.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int salvarLivrosBinario(Biblioteca *bib, FILE *arquivo);
+
+/*
+ * Grava o snapshot como salvarLivrosBinario, mas sem mensagens; recebe a
+ * biblioteca como contexto. É a função passada para
+ * compactarEmSegundoPlano, que a chama no processo filho.
+ * Retorna 0 se não houver memória ou se a gravação falhar.
+ */
+int gravarSnapshot(void *contexto, FILE *arquivo);
+
 /*
  * Carrega livros de um arquivo para a biblioteca.
- * Lê o arquivo linha por linha, criando um novo livro para cada linha.
+ * Aceita o formato binário (snapshot) e o formato texto (importação),
+ * reconhecendo o formato pelo início do arquivo.
+ * Depois da carga, em qualquer dos dois formatos, reaplica as operações do
+ * diário, se houver; os livros carregados não são registrados no diário.
+ * Deve ser usada com o arquivo principal (livros.dat), ao qual o diário
+ * se refere.
  */
 void carregarLivros(Biblioteca *bib, const char *nomeArquivo);
 
+/*
+ * Importa livros de um arquivo, como carregarLivros, mas sem reaplicar o
+ * diário: as operações dele se referem a livros.dat, e não ao arquivo
+ * importado. Os livros importados não são registrados no diário.
+ */
+void importarLivros(Biblioteca *bib, const char *nomeArquivo);
+
+/*
+ * Abre um snapshot como catálogo mapeado, sem carregar os livros.
+ * A abertura custa O(1): os livros são lidos das páginas mapeadas quando
+ * são buscados ou listados. A biblioteca precisa estar vazia. As
+ * operações do diário, se houver, são reaplicadas por cima. O arquivo
+ * não pode ser sobrescrito no lugar enquanto estiver aberto (um novo
+ * arquivo deve ser gravado à parte e renomeado por cima).
+ */
+void mapearCatalogo(Biblioteca *bib, const char *nomeArquivo);
+
 #endif
\ No newline at end of file
@@ -7,7 +7,9 @@
  */
 
 #include "biblioteca.h"
+#include <fcntl.h>
 #include <time.h>
+#include <unistd.h>
 
 /*
  * Limpa o buffer de entrada.
@@ -24,9 +26,10 @@ void limparBuffer()
  * Exibe o menu principal do sistema.
  * Mostra todas as opções disponíveis para o usuário.
  */
-void menu()
+void menu(Biblioteca *bib)
 {
-  printf("\n=== Biblioteca ===\n");
+  const char *nomes[] = {"Lista simples", "Lista de saltos", "Lista desenrolada"};
+  printf("\n=== Biblioteca (%s) ===\n", nomes[bib->tipo]);
   printf("1. Inserir livro\n");
   printf("2. Remover livro\n");
   printf("3. Buscar livro\n");
@@ -35,18 +38,87 @@ void menu()
   printf("6. Devolver livro\n");
   printf("7. Salvar livros\n");
   printf("8. Carregar livros\n");
+  printf("9. Exportar livros em texto\n");
+  printf("10. Importar livros de texto\n");
+  printf("11. Listar livros em arquivo\n");
+  printf("12. Listar livros por faixa de ID\n");
+  printf("13. Listar uma página de livros\n");
+  printf("14. Buscar livros por autor\n");
+  printf("15. Buscar livros pelo início do título\n");
+  printf("16. Buscar livros por trecho do título\n");
+  printf("17. Buscar livros por palavras\n");
+  printf("18. Listar livros disponíveis por faixa de ID\n");
   printf("0. Sair\n");
   printf("Escolha uma opção: ");
 }
 
+/*
+ * Mostra o resultado de um salvamento em segundo plano, se ele tiver
+ * terminado.
+ */
+void avisarCompactacao(EstadoCompactacao estado)
+{
+  if (estado == COMPACTACAO_CONCLUIDA)
+    printf("\nSalvamento em segundo plano concluído!\n");
+  else if (estado == COMPACTACAO_FALHOU)
+    printf("\nErro no salvamento em segundo plano; o diário foi mantido.\n");
+}
+
+/*
+ * Escreve na saída padrão os livros de um iterador, no formato da
+ * listagem, e fecha o iterador.
+ */
+void listarIterador(IteradorLivros *iterador)
+{
+  Saida saida;
+  fflush(stdout);
+  int ok = abrirSaida(&saida, STDOUT_FILENO);
+  if (ok)
+  {
+    int total = 0;
+    const Livro *livro;
+    while ((livro = proximoLivro(iterador)) != NULL)
+    {
+      escreverLivro(&saida, livro->id, livro->titulo, livro->autor, livro->disponivel);
+      total++;
+    }
+    if (total == 0)
+    {
+      const char vazia[] = "Nenhum livro encontrado.\n";
+      escreverSaida(&saida, vazia, sizeof(vazia) - 1);
+    }
+    ok = fecharSaida(&saida) && !iterador->erro;
+  }
+  fecharIterador(iterador);
+  if (!ok)
+    printf("Erro ao listar os livros.\n");
+}
+
 /*
  * Função principal do programa.
  * Implementa o loop principal que processa as opções do usuário.
  * Para cada operação, mede e exibe o tempo de execução.
+ * Passe "saltos" como argumento para usar a lista de saltos ou "desenrolada"
+ * para usar a lista desenrolada, e "catalogo" para abrir livros.dat como
+ * catálogo mapeado ao iniciar.
+ * As operações são registradas no diário livros.log, reaplicado ao carregar
+ * livros.dat e esvaziado a cada salvamento, que é feito em segundo plano.
  */
-int main()
+int main(int argc, char *argv[])
 {
-  Biblioteca *bib = criarBiblioteca();
+  TipoLista tipo = LISTA_SIMPLES;
+  int mapear = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "saltos") == 0)
+      tipo = LISTA_SALTOS;
+    else if (strcmp(argv[i], "desenrolada") == 0)
+      tipo = LISTA_DESENROLADA;
+    else if (strcmp(argv[i], "catalogo") == 0)
+      mapear = 1;
+  }
+
+  Biblioteca *bib = criarBibliotecaTipo(tipo);
   int opcao;
   int id;
   char titulo[MAX_TITULO];
@@ -55,9 +127,28 @@ int main()
   clock_t inicio, fim;
   double tempo_gasto;
 
+  Diario diario;
+  int comDiario = abrirDiario(&diario, "livros.log");
+  if (comDiario)
+    bib->diario = &diario;
+  else
+    printf("Aviso: não foi possível abrir o diário livros.log.\n");
+  Compactacao compactacao;
+  iniciarCompactacao(&compactacao);
+
+  if (mapear)
+  {
+    inicio = clock();
+    mapearCatalogo(bib, "livros.dat");
+    fim = clock();
+    tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+    printf("\nTempo gasto para abrir o catálogo: %.3f segundos\n", tempo_gasto);
+  }
+
   do
   {
-    menu();
+    avisarCompactacao(verificarCompactacao(&compactacao, 0));
+    menu(bib);
     scanf("%d", &opcao);
     limparBuffer();
 
@@ -140,9 +231,37 @@ int main()
       printf("\nTempo gasto para devolver o livro: %.3f segundos\n", tempo_gasto);
       break;
 
-    case 7: // Salvar livros
+    case 7: // Salvar livros (snapshot binário, em segundo plano)
       inicio = clock();
-      arquivo = fopen("livros.dat", "w");
+      // Sem livros.dat carregado e o diário reaplicado, a memória pode não
+      // ter as operações do diário: o snapshot é gravado sem rotacioná-lo,
+      // e o diário inteiro continua sendo reaplicado na próxima carga
+      if (comDiario && !bib->diarioReaplicado)
+        printf("Aviso: o diário não foi reaplicado nesta execução e será mantido.\n");
+      // O processo filho grava livros.dat.novo e renomeia por cima: o
+      // livros.dat antigo nunca fica pela metade e continua válido para um
+      // catálogo mapeado
+      if (compactarEmSegundoPlano(&compactacao, comDiario && bib->diarioReaplicado ? &diario : NULL,
+                                  "livros.dat", gravarSnapshot, bib))
+        printf("Salvamento iniciado em segundo plano.\n");
+      else
+        printf("Já existe um salvamento em andamento ou não foi possível iniciá-lo.\n");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para iniciar o salvamento: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 8: // Carregar livros
+      inicio = clock();
+      carregarLivros(bib, "livros.dat");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para carregar os livros: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 9: // Exportar livros em texto
+      inicio = clock();
+      arquivo = fopen("livros.txt", "w");
       if (arquivo != NULL)
       {
         salvarLivros(bib, arquivo);
@@ -154,15 +273,148 @@ int main()
       }
       fim = clock();
       tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
-      printf("\nTempo gasto para salvar os livros: %.3f segundos\n", tempo_gasto);
+      printf("\nTempo gasto para exportar os livros: %.3f segundos\n", tempo_gasto);
       break;
 
-    case 8: // Carregar livros
+    case 10: // Importar livros de texto
       inicio = clock();
-      carregarLivros(bib, "livros.dat");
+      importarLivros(bib, "livros.txt");
       fim = clock();
       tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
-      printf("\nTempo gasto para carregar os livros: %.3f segundos\n", tempo_gasto);
+      printf("\nTempo gasto para importar os livros: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 11: // Listar livros em arquivo
+      inicio = clock();
+      {
+        int fd = open("listagem.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+        {
+          int ok = listarLivrosDescritor(bib, fd);
+          if (close(fd) == 0 && ok)
+            printf("Livros listados em listagem.txt!\n");
+          else
+            printf("Erro ao gravar a listagem.\n");
+        }
+        else
+        {
+          printf("Erro ao abrir arquivo para escrita.\n");
+        }
+      }
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para listar os livros em arquivo: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 12: // Listar livros por faixa de ID
+      inicio = clock();
+      {
+        int ultimo;
+        IteradorLivros iterador;
+        printf("Digite o primeiro ID da faixa: ");
+        scanf("%d", &id);
+        printf("Digite o último ID da faixa: ");
+        scanf("%d", &ultimo);
+        iniciarIterador(&iterador, bib, id, ultimo);
+        listarIterador(&iterador);
+      }
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para listar a faixa: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 13: // Listar uma página de livros
+      inicio = clock();
+      {
+        int pagina, tamanho;
+        IteradorLivros iterador;
+        printf("Digite o número da página (a partir de 1): ");
+        scanf("%d", &pagina);
+        printf("Digite a quantidade de livros por página: ");
+        scanf("%d", &tamanho);
+        if (pagina >= 1 && tamanho >= 1)
+        {
+          iniciarPagina(&iterador, bib, (size_t)(pagina - 1), (size_t)tamanho);
+          listarIterador(&iterador);
+        }
+        else
+        {
+          printf("Página ou tamanho inválido.\n");
+        }
+      }
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para listar a página: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 14: // Buscar livros por autor
+      inicio = clock();
+      printf("Digite o autor: ");
+      fgets(autor, MAX_AUTOR, stdin);
+      autor[strcspn(autor, "\n")] = 0;
+      fflush(stdout);
+      if (!listarBuscaDescritor(bib, buscarPorAutor, autor, STDOUT_FILENO))
+        printf("Erro ao listar os livros.\n");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para buscar os livros do autor: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 15: // Buscar livros pelo início do título
+      inicio = clock();
+      printf("Digite o início do título: ");
+      fgets(titulo, MAX_TITULO, stdin);
+      titulo[strcspn(titulo, "\n")] = 0;
+      fflush(stdout);
+      if (!listarBuscaDescritor(bib, buscarPorPrefixo, titulo, STDOUT_FILENO))
+        printf("Erro ao listar os livros.\n");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para buscar os livros pelo título: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 16: // Buscar livros por trecho do título
+      inicio = clock();
+      printf("Digite o trecho do título: ");
+      fgets(titulo, MAX_TITULO, stdin);
+      titulo[strcspn(titulo, "\n")] = 0;
+      fflush(stdout);
+      if (!listarBuscaDescritor(bib, buscarPorTrecho, titulo, STDOUT_FILENO))
+        printf("Erro ao listar os livros.\n");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para buscar os livros pelo título: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 17: // Buscar livros por palavras
+      inicio = clock();
+      printf("Digite as palavras: ");
+      fgets(titulo, MAX_TITULO, stdin);
+      titulo[strcspn(titulo, "\n")] = 0;
+      fflush(stdout);
+      if (!listarBuscaDescritor(bib, buscarPorPalavras, titulo, STDOUT_FILENO))
+        printf("Erro ao listar os livros.\n");
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para buscar os livros por palavras: %.3f segundos\n", tempo_gasto);
+      break;
+
+    case 18: // Listar livros disponíveis por faixa de ID
+      inicio = clock();
+      {
+        int ultimo;
+        printf("Digite o primeiro ID da faixa: ");
+        scanf("%d", &id);
+        printf("Digite o último ID da faixa: ");
+        scanf("%d", &ultimo);
+        printf("Livros disponíveis na faixa: %d\n", contarDisponiveis(bib, id, ultimo));
+        fflush(stdout);
+        if (!listarDisponiveisDescritor(bib, id, ultimo, STDOUT_FILENO))
+          printf("Erro ao listar os livros.\n");
+      }
+      fim = clock();
+      tempo_gasto = ((double)(fim - inicio)) / CLOCKS_PER_SEC;
+      printf("\nTempo gasto para listar os disponíveis: %.3f segundos\n", tempo_gasto);
       break;
 
     case 0: // Sair
@@ -174,6 +426,9 @@ int main()
     }
   } while (opcao != 0);
 
+  avisarCompactacao(verificarCompactacao(&compactacao, 1));
+  if (comDiario)
+    fecharDiario(&diario);
   destruirBiblioteca(bib);
   return 0;
 }
\ No newline at end of file